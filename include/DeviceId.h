@@ -0,0 +1,18 @@
+/**
+ * Identidad del equipo: numero de serie y los nombres que salen de el.
+ *
+ * Se arman una sola vez (la primera vez que se piden) y quedan en memoria estatica,
+ * asi no se lee la eFuse ni se arman Strings en cada request.
+ *
+ * JJTeam - 2021
+ */
+
+#pragma once
+#include <Arduino.h>
+
+#define DEVICE_ID_SIZE 8 // numero de serie en base 36 (3 bytes => hasta 5 caracteres)
+
+extern const char *DeviceSerial();        // "xxxxx"
+extern const char *DeviceHostname();      // "pigguardxxxxx" (hostname para mDNS)
+extern const char *DeviceLocalHostname(); // "pigguardxxxxx.local"
+extern const char *DeviceSoftAPSSID();    // "Pig Guard xxxxx"
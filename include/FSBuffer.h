@@ -7,7 +7,34 @@
 
 //----------------------------------------------------------------------------
 
-typedef void (*ForEachLineCallback)(String line);
+/**
+ * Se llama por cada linea (sin el '\n'). line apunta a un buffer que se reusa:
+ * es valido solo durante la llamada (termina en '\0', pero puede tener otros '\0' si el archivo es binario).
+ * ctx es el puntero que se le paso a forEachLine...() (para no usar variables globales).
+ */
+typedef void (*ForEachLineCallback)(const char *line, size_t len, void *ctx);
+
+#define FSBUFFER_BLOCK_SIZE 256 // se lee de a bloques de este tamaño
+#define FSBUFFER_LINE_SIZE 256  // maximo de una linea que cae entre dos bloques (si es mas larga se corta)
+
+#define FSBUFFER_INDEX_SIZE 64 // entradas del indice de lineas de cada archivo
+
+/**
+ * Indice (ralo) de las lineas de un archivo: offsets[k] es donde empieza la linea k*step.
+ * Cuando se llena se descarta una entrada de cada dos y se duplica el step,
+ * asi ocupa siempre lo mismo sin importar el tamaño del archivo.
+ */
+struct FsBufferIndex
+{
+    bool valid = false;  // false => hay que recorrer el archivo para armarlo
+    uint32_t lines = 0;  // lineas completas (terminadas en '\n')
+    uint32_t bytes = 0;  // bytes recorridos
+    uint16_t step = 8;   // cada cuantas lineas hay una entrada
+    uint16_t count = 0;  // entradas usadas
+    uint32_t offsets[FSBUFFER_INDEX_SIZE];
+    void reset();                               // archivo vacio
+    void feed(const uint8_t *data, size_t len); // agrega bytes (del final del archivo)
+};
 
 class FsBuffer : public Print
 {
@@ -18,28 +45,49 @@ private:
     String baseFilename;     // puntero al string constante que se paso en el constructor
     String bufFileName;      // filename= "8.3\0"
     String cfgFileName;      // configuraciones
+    File bufFile;            // archivo actual, queda abierto entre writes
+    uint32_t bufFileSize;    // tamaño del archivo actual (se lleva en RAM para no consultar al FS)
+    uint32_t pendingBytes;   // bytes escritos desde el ultimo sync()
+    unsigned long lastSync;  // millis() del ultimo sync()
+    uint32_t syncBytes = 512;   // politica de flush: cada tantos bytes...
+    uint32_t syncMillis = 5000; // ...o cada tantos milisegundos
+    FsBufferIndex *lineIndex = nullptr; // un indice por archivo
+    uint32_t seqInicial = 0;            // numero de secuencia de la primer linea del archivo actual
     void initFile();         // crea el archivo a usar
     void storeConfig();      // guarda cosas en flash (por si un reset)
     void nextFile();         // Cambio de archivo. Voy al siguiente circularmente.
+    void openBufFile();      // abre el archivo actual en modo append
+    void closeBufFile();     // cierra el archivo actual (hace flush)
     String getFileName(int index);
+    FsBufferIndex &getIndex(int index); // arma el indice si hace falta
+    uint32_t readLines(const String &filename, uint32_t offset, uint32_t skip, uint32_t count, ForEachLineCallback callback, void *ctx);
 
 protected:
+    fs::FS *fileSystem = nullptr; // donde se graba (SD, SPIFFS u otro que se pase a begin())
     bool microSDExists = false;   // se grabará en SD si está disponible, sino usa la flash solo para ERROR.
     bool fileSystemError = false; // true si no puedo grabar en SD ni flash!
     File open(const String &path, const char *mode);
     void mkdir(const String &folder);
     void remove(const String &path);
     void printFromFile(String filename, Print &printer);
-    void forEachLineFromFile(String filename, ForEachLineCallback callback);
+    void forEachLineFromFile(String filename, ForEachLineCallback callback, void *ctx = nullptr);
+    uint32_t scanLines(File &f, uint32_t skip, uint32_t count, ForEachLineCallback callback, void *ctx);
 
 public:
     void begin(int pin_CS_microSD, uint32_t bytesPerFile, uint8_t filesQuantity, const String &folder);
+    // con un file system ya montado (FFat, LittleFS, uno en RAM...). isMicroSD: se graba todo (como en la SD)?
+    void begin(fs::FS &fs, bool isMicroSD, uint32_t bytesPerFile, uint8_t filesQuantity, const String &folder);
     size_t write(uint8_t c);
     size_t write(const uint8_t *txt);
     size_t write(const uint8_t *txt, size_t len);
     void printTo(Print &printer);
-    void forEachLine(ForEachLineCallback callback);
+    void forEachLine(ForEachLineCallback callback, void *ctx = nullptr);
+    uint32_t forEachLineFrom(uint32_t seq, uint32_t count, ForEachLineCallback callback, void *ctx = nullptr);  // callback nullptr: solo calcula hasta donde llega
+    uint32_t firstSeq(); // numero de secuencia de la linea mas vieja que hay
+    uint32_t nextSeq();  // numero de secuencia que va a tener la proxima linea
     void clear();
+    void setSyncPolicy(uint32_t bytes, uint32_t millis); // cada cuanto se hace el flush a disco
+    void sync();                                         // fuerza el flush del archivo actual
 };
 
 //----------------------------------------------------------------------------
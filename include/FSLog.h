@@ -6,6 +6,9 @@
 
     Permite extraer o enviar los logs al puerto serie, wifi, etc.
 
+    Con -D FSLOG_BINARIO en los build_flags los logs se graban en formato binario
+    (ver FSLogRecord.h): no se formatea el texto al grabar y ocupan menos lugar.
+
     JJTeam - 2021
 */
 
@@ -13,41 +16,101 @@
 #define _Fs_Log_h
 
 #include "FSBuffer.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+
+// tamaño de la cola en RAM donde se encolan las lineas antes de ir al FS
+#define FSLOG_RING_SIZE 4096
 
 #define FSLOG_FORMAT(letter, format) "[" #letter "]: " format "\n"
 #define FSLOG_FORMAT2(format) format "\n"
 
+//// Niveles de log (de menor a mayor importancia)
+#define FSLOG_NIVEL_TRACE 0  // LogTrace, LogDebugDiag
+#define FSLOG_NIVEL_DEBUG 1  // LogDebug
+#define FSLOG_NIVEL_DETAIL 2 // LogInfoDetail, LogInfoDiag
+#define FSLOG_NIVEL_INFO 3   // LogInfo
+#define FSLOG_NIVEL_ERROR 4  // LogError
+
+//// Nivel minimo que se compila: las llamadas de nivel menor desaparecen (ni se evaluan los argumentos).
+//// Para todo el proyecto: build_flags = -D FSLOG_NIVEL_MINIMO=FSLOG_NIVEL_INFO
+//// Para un solo .cpp: #undef / #define FSLOG_NIVEL_MINIMO antes del #include "FSLog.h"
+#ifndef FSLOG_NIVEL_MINIMO
+#define FSLOG_NIVEL_MINIMO FSLOG_NIVEL_TRACE
+#endif
+
+enum class FsLogNivel : uint8_t
+{
+    Trace = FSLOG_NIVEL_TRACE,
+    Debug = FSLOG_NIVEL_DEBUG,
+    Detail = FSLOG_NIVEL_DETAIL,
+    Info = FSLOG_NIVEL_INFO,
+    Error = FSLOG_NIVEL_ERROR,
+};
+
+#define FSLOG_NADA \
+    do             \
+    {              \
+    } while (0)
+
 #ifndef NO_USAR_FS_LOG
 
-//// Todas estas formas de llamar al Logger:
-#define LogDebug(format, ...) FSLOG.log(FSLOG_FORMAT(D, format), ##__VA_ARGS__)
-#define LogDebugDiag(format, ...) FSLOG.log(FSLOG_FORMAT(T, format), ##__VA_ARGS__)
-#define LogTrace(format, ...) FSLOG.log(FSLOG_FORMAT(T, format), ##__VA_ARGS__)
-//// LogDebugDiag() y LogTrace() son iguales
-#define LogInfo(format, ...) FSLOG.log(FSLOG_FORMAT(I, format), ##__VA_ARGS__)
-#define LogInfoDiag(format, ...) FSLOG.log(FSLOG_FORMAT(V, format), ##__VA_ARGS__)
-#define LogInfoDetail(format, ...) FSLOG.log(FSLOG_FORMAT(V, format), ##__VA_ARGS__)
-//// LogInfoDiag() y LogInfoDetail() son iguales
-#define LogError(format, ...) FSLOG.log(FSLOG_FORMAT(E, format), ##__VA_ARGS__)
+// solo se llama a log() (y se evaluan los argumentos) si el nivel va a alguna salida
+#define FSLOG_LOG(nivel, letter, format, ...)                                            \
+    do                                                                                   \
+    {                                                                                    \
+        if (FSLOG.isEnabled(FsLogNivel::nivel))                                          \
+            FSLOG.log(FsLogNivel::nivel, FSLOG_FORMAT(letter, format), ##__VA_ARGS__); \
+    } while (0)
+
 #define LogAtStartUp(format, ...) FSLOG.startup(FSLOG_FORMAT2(format), ##__VA_ARGS__)
 #define LogBegin(a, b) FSLOG.begin(a, b)
 #define LogModoDiagnostico(b) FSLOG.SetModoDiagnostico(b)
 
 #else // NO_USAR_FS_LOG
 
-#define LogDebug(format, ...) Serial.printf(FSLOG_FORMAT2(format), ##__VA_ARGS__)
-#define LogDebugDiag(format, ...) Serial.printf(FSLOG_FORMAT2(format), ##__VA_ARGS__)
-#define LogTrace(format, ...) Serial.printf(FSLOG_FORMAT2(format), ##__VA_ARGS__)
-#define LogInfo(format, ...) Serial.printf(FSLOG_FORMAT2(format), ##__VA_ARGS__)
-#define LogInfoDiag(format, ...) Serial.printf(FSLOG_FORMAT2(format), ##__VA_ARGS__)
-#define LogInfoDetail(format, ...) Serial.printf(FSLOG_FORMAT2(format), ##__VA_ARGS__)
-#define LogError(format, ...) Serial.printf(FSLOG_FORMAT2(format), ##__VA_ARGS__)
+#define FSLOG_LOG(nivel, letter, format, ...) Serial.printf(FSLOG_FORMAT2(format), ##__VA_ARGS__)
+
 #define LogAtStartUp(format, ...) Serial.printf(FSLOG_FORMAT2(format), ##__VA_ARGS__)
 #define LogBegin(a, b)
 #define LogModoDiagnostico(b)
 
 #endif // NO_USAR_FS_LOG
 
+//// Todas estas formas de llamar al Logger:
+#if FSLOG_NIVEL_MINIMO <= FSLOG_NIVEL_TRACE
+#define LogDebugDiag(format, ...) FSLOG_LOG(Trace, T, format, ##__VA_ARGS__)
+#define LogTrace(format, ...) FSLOG_LOG(Trace, T, format, ##__VA_ARGS__)
+#else
+#define LogDebugDiag(format, ...) FSLOG_NADA
+#define LogTrace(format, ...) FSLOG_NADA
+#endif
+//// LogDebugDiag() y LogTrace() son iguales
+
+#if FSLOG_NIVEL_MINIMO <= FSLOG_NIVEL_DEBUG
+#define LogDebug(format, ...) FSLOG_LOG(Debug, D, format, ##__VA_ARGS__)
+#else
+#define LogDebug(format, ...) FSLOG_NADA
+#endif
+
+#if FSLOG_NIVEL_MINIMO <= FSLOG_NIVEL_DETAIL
+#define LogInfoDiag(format, ...) FSLOG_LOG(Detail, V, format, ##__VA_ARGS__)
+#define LogInfoDetail(format, ...) FSLOG_LOG(Detail, V, format, ##__VA_ARGS__)
+#else
+#define LogInfoDiag(format, ...) FSLOG_NADA
+#define LogInfoDetail(format, ...) FSLOG_NADA
+#endif
+//// LogInfoDiag() y LogInfoDetail() son iguales
+
+#if FSLOG_NIVEL_MINIMO <= FSLOG_NIVEL_INFO
+#define LogInfo(format, ...) FSLOG_LOG(Info, I, format, ##__VA_ARGS__)
+#else
+#define LogInfo(format, ...) FSLOG_NADA
+#endif
+
+#define LogError(format, ...) FSLOG_LOG(Error, E, format, ##__VA_ARGS__)
+
 class FsLog : public FsBuffer
 {
 private:
@@ -57,14 +120,61 @@ private:
     String startupLogFileName;
     String folder = "/logger"; // solo una carpeta!
 
+    // cola circular en RAM: log() copia aca y la tarea de flush la baja al FS en bloques.
+    // Solo contiene lineas completas (terminadas en '\n'). Los indices se tocan en una seccion
+    // critica corta (pueden loguear varias tareas): adentro solo hay memcpy/memchr, nunca el FS.
+    char ring[FSLOG_RING_SIZE];
+    size_t ringHead = 0;                 // donde se escribe
+    size_t ringTail = 0;                 // donde se lee
+    size_t ringUsed = 0;                 // bytes ocupados
+    uint32_t droppedLines = 0;           // lineas descartadas por falta de lugar (se pierden las mas viejas)
+    SemaphoreHandle_t fsMutex = nullptr; // serializa el acceso al FsBuffer
+    TaskHandle_t flushTask = nullptr;
+    void enqueue(const char *line, size_t len);
+    size_t oldestLine() const; // largo de la linea mas vieja de la cola (con su '\n')
+    void drain();
+    static void flushTaskLoop(void *param);
+    void start(HardwareSerial &out);
+
 public:
     void begin(int pin_CS_microSD, HardwareSerial &out, uint32_t bytesPerFile = 1000);
+    void begin(fs::FS &fs, bool isMicroSD, HardwareSerial &out, uint32_t bytesPerFile = 1000); // file system ya montado
     void SetModoDiagnostico(bool enable);
     void startup(const char *format, ...); // escribe en un archivo separado, se pisa en cada RESET.
     void printStartupTo(Print &printer);   // imprime los logs en una salida streameable
-    void forEachStartup(ForEachLineCallback callback);
-    void log(const char *format, ...);
+    void forEachStartup(ForEachLineCallback callback, void *ctx = nullptr);
+    void log(FsLogNivel nivel, const char *format, ...);
+
+    // sale por el puerto serie? (T y V solo en modoDiagnostico)
+    bool toSerial(FsLogNivel nivel) const
+    {
+        return (nivel != FsLogNivel::Trace && nivel != FsLogNivel::Detail) || modoDiagnostico;
+    }
+
+    // se graba? (E siempre, I solo con micro-SD, V con micro-SD y en modoDiagnostico)
+    bool toFile(FsLogNivel nivel) const
+    {
+        return nivel == FsLogNivel::Error ||
+               (microSDExists && nivel == FsLogNivel::Info) ||
+               (microSDExists && modoDiagnostico && nivel == FsLogNivel::Detail);
+    }
+
+    bool isEnabled(FsLogNivel nivel) const { return toSerial(nivel) || toFile(nivel); }
+
+    // escribir o borrar directo (sin log()): con el fsMutex, como la tarea de flush
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t *txt);
+    size_t write(const uint8_t *txt, size_t len) override;
+    void clear(); // borra los archivos y lo que estaba en la cola
+    void flush(); // baja al FS todo lo que esta en la cola (bloqueante)
+    void printTo(Print &printer);
+    void forEachLine(ForEachLineCallback callback, void *ctx = nullptr);
+    uint32_t forEachLineFrom(uint32_t seq, uint32_t count, ForEachLineCallback callback, void *ctx = nullptr);
+    uint32_t firstSeq();
+    uint32_t nextSeq();
+    uint32_t getDroppedLines() { return droppedLines; }
     String getStatus();
+    TaskHandle_t getFlushTask() const { return flushTask; } // tarea que graba la cola (para medir su stack)
 };
 
 //-- unica instancia para todo el proyecto...
@@ -0,0 +1,44 @@
+/*
+    FsLogRecord.h
+    Formato binario de los registros de log (modo FSLOG_BINARIO).
+
+    En lugar de formatear el texto con vsprintf al loguear, se guarda:
+      - la direccion del string de formato (queda en la flash, no cambia hasta el proximo firmware)
+      - el millis() del momento
+      - los argumentos crudos (los strings se copian, hasta FSLOG_REC_MAX_STR caracteres)
+    y el texto recien se arma al leer los logs (/logs, printTo(), o en la PC con tools/fslog_decode.py).
+
+    El registro queda en una sola linea: empieza con FSLOG_REC_MARK y termina en '\n'.
+    Los bytes '\n', '\0' y FSLOG_REC_ESC del contenido se escapan, asi el resto del
+    sistema (cola, archivos, lectura por lineas) lo trata igual que una linea de texto.
+
+    JJTeam - 2021
+*/
+
+#pragma once
+
+#include <Arduino.h>
+#include <stdarg.h>
+
+#define FSLOG_REC_MARK '\x1e' // primer byte de un registro binario
+#define FSLOG_REC_ESC '\x1b'  // escape: el byte siguiente va XOR FSLOG_REC_XOR
+#define FSLOG_REC_XOR 0x20
+#define FSLOG_REC_MAX_STR 64  // largo maximo de un %s guardado
+
+/**
+ * Arma el registro binario (ya escapado y con el '\n' final) en out.
+ * Devuelve la cantidad de bytes usados. Si no entra, se cortan los ultimos argumentos.
+ */
+size_t FsLogEncode(char *out, size_t size, const char *format, va_list args);
+
+/**
+ * Es un registro binario? (si no, es una linea de texto comun)
+ */
+inline bool FsLogIsRecord(const char *line, size_t len) { return len > 0 && line[0] == FSLOG_REC_MARK; }
+
+/**
+ * Arma el texto del registro en out (el mismo que hubiera generado vsprintf).
+ * Devuelve el largo del texto, o 0 si el registro no es valido.
+ * Si timestamp != nullptr devuelve ahi el millis() del registro.
+ */
+size_t FsLogRender(const char *line, size_t len, char *out, size_t size, uint32_t *timestamp = nullptr);
@@ -0,0 +1,52 @@
+/*
+    HtmlWriter.h
+    Arma las paginas HTML directo en un buffer fijo y lo envia como chunks HTTP 1.1 por el WebServer.
+    No usa memoria dinamica: la memoria por request es siempre la misma, sin importar el tamaño de la pagina.
+
+    Uso:
+        HtmlWriter html(server);
+        html.begin(200, "text/html");
+        html.open("p", "r").escaped(ssid).close("p");
+        html.end();
+
+    JJTeam - 2021
+*/
+
+#pragma once
+
+#include <Arduino.h>
+#include <WebServer.h>
+
+// tamaño del buffer: cuando se llena se envia como un chunk
+#define HTML_WRITER_SIZE 512
+
+class HtmlWriter : public Print
+{
+private:
+    WebServer &server;
+    char buffer[HTML_WRITER_SIZE + 1]; // +1 para el '\0' que pone vsnprintf (no se envia)
+    size_t len = 0;
+    bool started = false; // ya se mandaron los headers?
+
+public:
+    HtmlWriter(WebServer &server) : server(server) {}
+    ~HtmlWriter() { end(); }
+
+    void begin(int code, const char *contentType); // manda los headers (sin content-length => chunked)
+    void flush();                                  // manda lo que hay en el buffer como un chunk
+    void end();                                    // manda lo que queda y el chunk final
+
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t *data, size_t size) override;
+    using Print::write;
+
+    HtmlWriter &text(const char *s);                                        // texto tal cual (puede tener HTML)
+    HtmlWriter &escaped(const char *s);                                     // texto escapando < > & " '
+    HtmlWriter &escaped(const char *s, size_t size);                        //
+    HtmlWriter &open(const char *tag, const char *classs = nullptr);        // <tag class="classs">
+    HtmlWriter &close(const char *tag);                                     // </tag>
+    HtmlWriter &tag(const char *tag, const char *text, const char *classs = nullptr); // <tag>text</tag>
+    HtmlWriter &option(const char *text, const char *value = "");           // <option value="value">text</option>
+    HtmlWriter &json(const char *s);                                        // string JSON (con comillas y escapes)
+    HtmlWriter &printf(const char *format, ...) __attribute__((format(printf, 2, 3))); // formatea directo en el buffer (corta en HTML_WRITER_SIZE)
+};
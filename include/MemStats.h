@@ -0,0 +1,72 @@
+/**
+ * Medicion del uso de memoria: cuantas veces y cuanto se pide al heap, por tarea.
+ *
+ * Las llamadas a malloc/calloc/realloc/free (y new/delete, que las usan) se interceptan
+ * en el linker con --wrap, asi que hace falta en el platformio.ini (el env:native ya lo tiene,
+ * en el env:esp32dev esta comentado):
+ *
+ *      build_flags = -DMEM_STATS_HABILITADO
+ *          -Wl,--wrap=malloc -Wl,--wrap=calloc -Wl,--wrap=realloc -Wl,--wrap=free
+ *
+ * Sin eso todo compila igual y los contadores quedan en cero.
+ * No se cuentan los pedidos que van directo a heap_caps_malloc() (WiFi, lwip, newlib por dentro).
+ *
+ * Cada PERF_SCOPE (ver PerfStats.h) suma lo que pidio su tarea mientras estuvo abierto,
+ * y el resultado se ve en /stats/mem junto con el heap libre y el stack de las tareas.
+ * Mientras hay un PERF_SCOPE abierto, los hooks de malloc de esa tarea tambien miran el heap
+ * despues de cada pedido: de ahi salen el pico de uso del bloque (heap libre al empezar menos
+ * el minimo que se vio adentro) y el bloque libre mas grande en el peor momento. Buscar el bloque
+ * mas grande recorre el heap, asi que ese se mira en el primer pedido, cada MEM_STATS_LARGEST_EVERY
+ * pedidos y al cerrar el bloque (es el minimo de esas muestras).
+ * El pico incluye lo que pidieron otras tareas en ese rato (no se puede separar sin el tamaño de cada free).
+ *
+ * Solo tienen contadores propios las tareas que miden (MemStatsTask() o un PERF_SCOPE):
+ * el lugar se toma la primera vez y se devuelve con MemStatsTaskEnd() antes de vTaskDelete().
+ * Las tareas que solo piden memoria (las del arranque, WiFi...) van todas juntas.
+ *
+ * JJTeam - 2021
+ */
+
+#pragma once
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#define MEM_STATS_TASKS 8         // tareas que miden por separado (las demas van todas juntas)
+#define MEM_STATS_LARGEST_EVERY 16 // cada cuantos pedidos de un bloque se busca el bloque libre mas grande
+
+struct MemStatsHeap
+{
+    uint32_t allocs;  // pedidos al heap desde que arranco
+    uint32_t frees;   //
+    uint32_t bytes;   // bytes pedidos (no descuenta lo liberado)
+    uint32_t free;    // heap libre ahora
+    uint32_t minFree; // heap libre minimo desde que arranco (el pico de uso)
+    uint32_t largest; // bloque libre mas grande (si es mucho menor que free, hay fragmentacion)
+};
+
+// lo que uso una tarea entre MemStatsScopeBegin() y MemStatsScopeEnd()
+struct MemStatsUse
+{
+    uint32_t allocs;  // pedidos al heap
+    uint32_t bytes;   // bytes pedidos (no descuenta lo liberado)
+    uint32_t peak;    // pico de uso del heap (0 = no pidio memoria)
+    uint32_t largest; // bloque libre mas grande en el peor momento (0 = no pidio memoria)
+};
+
+// estado de un bloque abierto (lo guarda PerfScope), se pueden anidar
+struct MemStatsScope
+{
+    uint32_t allocs;
+    uint32_t bytes;
+    uint32_t outerStart; // lo del bloque de afuera, se junta al cerrar
+    uint32_t outerMinFree;
+    uint32_t outerMinLargest;
+};
+
+extern void MemStatsTask(uint32_t &allocs, uint32_t &bytes); // pedidos de la tarea actual desde que mide
+extern void MemStatsTaskEnd();                               // devuelve el lugar de la tarea actual (antes de vTaskDelete)
+extern void MemStatsScopeBegin(MemStatsScope &scope);
+extern void MemStatsScopeEnd(MemStatsScope &scope, MemStatsUse &use);
+extern void MemStatsGet(MemStatsHeap &heap);                 // totales y estado del heap
+extern uint32_t MemStatsStackFree(TaskHandle_t task);        // minimo de stack libre que tuvo la tarea (bytes), nullptr = la actual
@@ -0,0 +1,91 @@
+/**
+ * Medicion de tiempos de los caminos calientes (log, DNS, paginas web).
+ *
+ * Cada contador tiene un nombre fijo y junta: cantidad, tiempo total, maximo
+ * y un histograma log2 en microsegundos (de ahi salen p50 y p99).
+ * Memoria fija: PERF_STATS_MAX contadores, registrados la primera vez que se usan.
+ *
+ * Uso:
+ *      void handleRoot()
+ *      {
+ *          PERF_SCOPE("http /");   // mide hasta el final del bloque
+ *          ...
+ *
+ * Tambien cuenta lo que la tarea pidio al heap dentro del bloque, el pico de uso
+ * y el bloque libre mas grande en el peor momento (ver MemStats.h).
+ *
+ * Para nombres que se arman al arrancar (ej: uno por recurso web) el contador se busca
+ * una vez con PerfStatGet() y se mide con PERF_SCOPE_STAT(stat).
+ *
+ * Los resultados se ven en /stats/perf y /stats/mem (JSON).
+ * Con -DPERF_STATS_HABILITADO=0 los PERF_SCOPE no generan codigo.
+ *
+ * JJTeam - 2021
+ */
+
+#pragma once
+#include <Arduino.h>
+#include "MemStats.h"
+
+#ifndef PERF_STATS_HABILITADO
+#define PERF_STATS_HABILITADO 1
+#endif
+
+#define PERF_STATS_MAX 24     // cantidad maxima de contadores
+#define PERF_STATS_BUCKETS 24 // bucket i: < 2^(i+1) us, el ultimo es el resto
+
+struct PerfStat
+{
+    const char *name; // string constante (no se copia)
+    uint32_t count;
+    uint64_t totalMicros;
+    uint32_t maxMicros;
+    uint32_t buckets[PERF_STATS_BUCKETS];
+    uint32_t allocs;      // pedidos al heap (solo con MEM_STATS_HABILITADO)
+    uint32_t allocBytes;  //
+    uint32_t peakHeap;    // mayor pico de uso del heap de una medicion
+    uint32_t minLargest;  // el bloque libre mas grande mas chico que se vio (0 = nunca pidio)
+};
+
+extern PerfStat *PerfStatGet(const char *name);                  // busca o registra el contador (nullptr si no hay lugar)
+extern void PerfStatAdd(PerfStat *stat, uint32_t micros, const MemStatsUse *mem = nullptr); // suma una medicion
+extern int PerfStatCount();                                      // cantidad de contadores registrados
+extern bool PerfStatCopy(int index, PerfStat &copy);             // copia consistente (se actualizan desde varias tareas)
+extern uint32_t PerfStatPercentile(const PerfStat &stat, int pct); // limite superior (us) del bucket del percentil
+extern void PerfStatClear();                                     // pone todo en cero (los contadores siguen registrados)
+
+// mide el tiempo desde que se crea hasta que se destruye
+class PerfScope
+{
+private:
+    PerfStat *stat;
+    uint32_t start;
+    MemStatsScope mem;
+
+public:
+    PerfScope(PerfStat *stat) : stat(stat)
+    {
+        MemStatsScopeBegin(mem);
+        start = micros();
+    }
+    ~PerfScope()
+    {
+        uint32_t elapsed = micros() - start;
+        MemStatsUse use;
+        MemStatsScopeEnd(mem, use);
+        PerfStatAdd(stat, elapsed, &use);
+    }
+};
+
+#define PERF_CONCAT2(a, b) a##b
+#define PERF_CONCAT(a, b) PERF_CONCAT2(a, b)
+
+#if PERF_STATS_HABILITADO
+#define PERF_SCOPE(name)                                                           \
+    static PerfStat *PERF_CONCAT(_perfStat, __LINE__) = PerfStatGet(name);         \
+    PerfScope PERF_CONCAT(_perfScope, __LINE__)(PERF_CONCAT(_perfStat, __LINE__))
+#define PERF_SCOPE_STAT(stat) PerfScope PERF_CONCAT(_perfScope, __LINE__)(stat)
+#else
+#define PERF_SCOPE(name)
+#define PERF_SCOPE_STAT(stat)
+#endif
@@ -4,80 +4,30 @@
 */
 
 #pragma once
+#include <Arduino.h>
+
+// largo maximo de una IP como texto ("255.255.255.255" + '\0')
+#define IP_STRING_SIZE 16
 
 /**
- * Obtiene el ID del ESP32 (es la Mac Address, pero la muestro en Base 36)
- * 
- * En la pagina de https://macaddress.io/ se puede ver esto:
- * 
- * =============================================================
- *  Vendor details, OUI [7C:9E:BD], Company name: Espressif Inc
- * =============================================================
- * 
- * Por eso voy a usar como numero de serie solo los 3 bytes ultimos.
+ * Numero de serie del equipo (ver DeviceId.h, que lo guarda y no lo vuelve a calcular)
  */
-const String getSerialNumber()
-{
-    struct
-    {
-        uint32_t h;
-        uint32_t l;
-    } u;
-    esp_efuse_mac_get_default((uint8_t *)(&u));
-    int id = ((u.h >> 8) & 0xff0000) | ((u.l << 8) & 0xff00) | ((u.l >> 8) & 0x00ff);
-    return String(id, 36);
-}
+const String getSerialNumber();
 
 /**
  * Porqué se reseteó ?
  */
-const char *getResetReason()
-{
-    switch (esp_reset_reason())
-    {
-    case ESP_RST_POWERON:
-        return "Power on Reset";
-    case ESP_RST_SW:
-        return "Reset via esp_restart";
-    case ESP_RST_PANIC:
-        return "Reset by exception or panic";
-    case ESP_RST_INT_WDT:
-    case ESP_RST_TASK_WDT:
-    case ESP_RST_WDT:
-        return "Reset by watchdog";
-    case ESP_RST_DEEPSLEEP:
-        return "Reset after sleep";
-    case ESP_RST_BROWNOUT:
-        return "Reset by Brownout";
-    case ESP_RST_SDIO:
-        return "Reset over SDIO";
-    default:
-        return "Reset reason can not be determined";
-    }
-}
+const char *getResetReason();
 
 /** Is this an IP? */
-boolean isIp(String str)
-{
-    for (size_t i = 0; i < str.length(); i++)
-    {
-        int c = str.charAt(i);
-        if (c != '.' && (c < '0' || c > '9'))
-        {
-            return false;
-        }
-    }
-    return true;
-}
+boolean isIp(const char *str);
+boolean isIp(const String &str);
 
 /** IP to String? */
-String toStringIp(IPAddress ip)
-{
-    String res = "";
-    for (int i = 0; i < 3; i++)
-    {
-        res += String((ip >> (8 * i)) & 0xFF) + ".";
-    }
-    res += String(((ip >> 8 * 3)) & 0xFF);
-    return res;
-}
+String toStringIp(IPAddress ip);
+
+/**
+ * Escribe la IP como texto en buf (sin memoria dinamica). Devuelve buf.
+ * buf tiene que tener al menos IP_STRING_SIZE bytes.
+ */
+char *ipToString(IPAddress ip, char *buf, size_t size = IP_STRING_SIZE);
@@ -0,0 +1,100 @@
+/**
+ * Traza de los caminos calientes: que paso y cuando, evento por evento.
+ *
+ * PerfStats dice cuanto tarda cada cosa en promedio; esto muestra una vuelta concreta
+ * del loop (por ejemplo la que se trabo): cada TRACE_SCOPE graba un evento al entrar y
+ * otro al salir, con el contador de ciclos de la CPU, en un anillo fijo en RAM.
+ * Grabar un evento es leer el contador y escribir 8 bytes, sin locks ni memoria dinamica.
+ *
+ * Uso:
+ *      void WifiLoop()
+ *      {
+ *          TRACE_LOOP();                   // una vuelta del loop, detecta las trabadas
+ *          {
+ *              TRACE_SCOPE("handleClient"); // hasta el final del bloque
+ *              server.handleClient();
+ *          }
+ *
+ * Si una vuelta del loop tarda mas de TRACE_STALL_MS el anillo se congela, asi la trabada
+ * queda guardada hasta que se lea /trace.json (formato "trace event" de Chrome: se abre con
+ * chrome://tracing o https://ui.perfetto.dev). /trace.json?restart lo vuelve a largar.
+ *
+ * Esta deshabilitado por defecto (ocupa TRACE_EVENTS * 8 bytes de RAM), se habilita con:
+ *
+ *      build_flags = -DTRACE_HABILITADO
+ *
+ * Deshabilitado los TRACE_SCOPE no generan codigo y /trace.json devuelve una traza vacia.
+ *
+ * Cada tarea que graba ocupa una de las TRACE_TASKS entradas hasta que llama a TraceTaskEnd()
+ * (o se reinicia la traza); las que no tienen lugar se muestran todas juntas como "otras".
+ *
+ * JJTeam - 2021
+ */
+
+#pragma once
+#include <Arduino.h>
+
+#ifndef TRACE_HABILITADO
+#define TRACE_HABILITADO 0
+#endif
+
+#define TRACE_EVENTS 1024 // tamaño del anillo (potencia de 2)
+#define TRACE_NAMES 32    // nombres distintos de TRACE_SCOPE
+#define TRACE_TASKS 8     // tareas que se muestran por separado (las demas van todas juntas)
+
+// una vuelta del loop que tarde mas que esto congela la traza (0 = nunca)
+#ifndef TRACE_STALL_MS
+#define TRACE_STALL_MS 50
+#endif
+
+extern uint8_t TraceName(const char *name);          // registra el nombre (0 si no hay lugar)
+extern void TraceEvent(uint8_t name, char phase);    // graba un evento: 'B' empieza, 'E' termina, 'i' instantaneo
+extern void TraceLoopEnd(uint32_t generation, uint32_t micros); // fin de una vuelta del loop (ver TraceLoop)
+extern uint32_t TraceGeneration();                   // cambia con cada lectura o reinicio de la traza
+extern void TraceWriteJson(Print &out);              // escribe la traza (pausa la grabacion mientras tanto)
+extern void TraceRestart();                          // vacia el anillo y lo descongela
+extern void TraceTaskEnd();                          // la tarea actual termina (antes de vTaskDelete)
+
+// graba un evento al crearse y otro al destruirse
+class TraceScope
+{
+private:
+    uint8_t name;
+
+public:
+    TraceScope(uint8_t name) : name(name) { TraceEvent(name, 'B'); }
+    ~TraceScope() { TraceEvent(name, 'E'); }
+};
+
+// como TraceScope, y ademas congela la traza si tardo mas de TRACE_STALL_MS.
+// Una vuelta en la que se leyo o reinicio la traza no cuenta (lo lento fue eso).
+class TraceLoop
+{
+private:
+    uint8_t name;
+    uint32_t generation;
+    uint32_t start;
+
+public:
+    TraceLoop(uint8_t name) : name(name), generation(TraceGeneration()), start(micros()) { TraceEvent(name, 'B'); }
+    ~TraceLoop()
+    {
+        TraceEvent(name, 'E'); // antes de congelarla, asi la vuelta queda completa
+        TraceLoopEnd(generation, micros() - start);
+    }
+};
+
+#define TRACE_CONCAT2(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT2(a, b)
+
+#if TRACE_HABILITADO
+#define TRACE_SCOPE(name)                                                          \
+    static uint8_t TRACE_CONCAT(_traceName, __LINE__) = TraceName(name);           \
+    TraceScope TRACE_CONCAT(_traceScope, __LINE__)(TRACE_CONCAT(_traceName, __LINE__))
+#define TRACE_LOOP()                                                               \
+    static uint8_t _traceLoopName = TraceName("loop");                             \
+    TraceLoop _traceLoop(_traceLoopName)
+#else
+#define TRACE_SCOPE(name)
+#define TRACE_LOOP()
+#endif
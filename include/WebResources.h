@@ -6,6 +6,7 @@
 
 #pragma once
 #include <Arduino.h>
+#include <WebServer.h>
 
 constexpr char HTML_BODY_START[] = "<!DOCTYPE html><html><head>"
                                    "<meta name=\"viewport\" content=\"width=device-width, initial-scale=1.0\">"
@@ -20,10 +21,47 @@ constexpr char HTML_MENU_INDEX[] = "<ul><li><a href='/wifi'>Configurar la conexi
 //-- archivos linkeados (se suben a la flash en el linker, y queda esta referencia para usarlos)
 //-- agregar los archivos en el platformio.ini
 // @see: https://docs.platformio.org/en/latest/platforms/espressif32.html#embedding-binary-data
-#define WEB_RESOURCE(_resource)                                              \
-  extern const char _resource[] asm("_binary_web_" #_resource "_start");     \
-  extern const char _resource##_end[] asm("_binary_web_" #_resource "_end"); \
-  extern const size_t _resource##_size = _resource##_end - _resource;
+// el largo es _resource##_end - _resource (no terminan en 0)
+#define WEB_RESOURCE(_resource)                                          \
+  extern const char _resource[] asm("_binary_web_" #_resource "_start"); \
+  extern const char _resource##_end[] asm("_binary_web_" #_resource "_end");
 
-WEB_RESOURCE(style_css)
-WEB_RESOURCE(logo_jpg)
+//-- los archivos de board_build.embed_files (y de lib/HostFakes/src/web_resources.S)
+#define WEB_FILES(X) \
+  X(style_css)       \
+  X(style_css_gz)    \
+  X(logo_jpg)
+
+WEB_FILES(WEB_RESOURCE)
+
+//-- recursos que se sirven: X(archivo, archivo con gzip, url, content type)
+//-- archivo con gzip: la copia comprimida (la genera scripts/gzip_web.py), o el mismo archivo si no hay.
+//   La comprimida va solo si el navegador la acepta (Accept-Encoding), si no va la original
+//-- el navegador pregunta cada vez (no-cache) y se le contesta 304 si no cambio (ETag):
+//   las urls son fijas, asi que sin eso un archivo nuevo no se veria hasta que venza el cache
+//-- se mandan directo desde la flash, y aceptan Range (un solo rango) para bajarlos por partes
+#define WEB_RESOURCES(X)                               \
+  X(style_css, style_css_gz, "/style.css", "text/css") \
+  X(logo_jpg, logo_jpg, "/logo.jpg", "image/jpeg")
+
+struct PerfStat;
+
+struct WebResource
+{
+  const char *path;
+  const char *perfName; // "http /style.css" (en /stats/perf)
+  PerfStat *perf;       // se busca al arrancar
+  const char *contentType;
+  const char *data;
+  const char *end;
+  const char *gzipData; // == data si no hay copia comprimida
+  const char *gzipEnd;
+  char etag[11];     // "xxxxxxxx" (hash del contenido, se calcula al arrancar)
+  char gzipEtag[11]; // el de la copia comprimida (es otra representacion, otro ETag)
+
+  bool gzip() const { return gzipData != data; }
+  size_t size() const { return end - data; }
+};
+
+extern void WebResourcesBegin(WebServer &server);        // calcula los ETag y agrega las rutas al server
+extern const WebResource *WebResourceFind(const char *path); // nullptr si no hay un recurso con esa url
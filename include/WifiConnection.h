@@ -0,0 +1,32 @@
+/**
+ * Conexion a la red WiFi (modo estacion) sin bloquear.
+ *
+ * En lugar de esperar con WiFi.waitForConnectResult(), avanza una maquina de estados
+ * con los eventos de WiFi, y si falla reintenta con espera exponencial (+ un poco de azar,
+ * para que varios equipos no reintenten todos juntos).
+ * Mientras tanto el DNS y el web server del portal siguen atendiendo normalmente.
+ *
+ * JJTeam - 2021
+ */
+
+#pragma once
+#include <Arduino.h>
+
+#define WIFI_CONNECT_TIMEOUT 15000    // tiempo maximo de cada intento (ms)
+#define WIFI_RETRY_MIN 2000           // primera espera entre intentos (ms)
+#define WIFI_RETRY_MAX 300000         // maxima espera entre intentos (ms)
+
+enum class WifiConnState
+{
+    Idle,          // sin credenciales
+    Disconnecting, // esperando que se corte la conexion anterior (para cambiar de red)
+    Connecting,    // WiFi.begin() hecho, esperando la IP
+    Connected,     // conectado y con IP
+    WaitRetry,     // fallo, esperando para reintentar
+};
+
+extern void WifiConnectionBegin();                                    // registra los eventos de WiFi
+extern void WifiConnectionStart(const char *ssid, const char *password); // conecta con estas credenciales (deben seguir vivas)
+extern void WifiConnectionLoop();                                     // llamar en el loop, nunca bloquea
+extern WifiConnState WifiConnectionState();
+extern const char *WifiConnectionStateName();
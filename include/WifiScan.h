@@ -0,0 +1,34 @@
+/**
+ * Scan de redes WiFi en segundo plano.
+ *
+ * WiFi.scanNetworks() bloquea varios segundos (y con eso el DNS y el web server),
+ * asi que el scan se hace asincronico y se guarda el resultado en un cache:
+ * una entrada por SSID (la de mejor señal), ordenadas de mayor a menor señal.
+ * Por defecto solo se escanea a pedido (WifiScanRequest(), cuando alguien abre /wifi):
+ * mientras escanea la radio deja de atender el soft AP, y los clientes del portal lo notan.
+ *
+ * JJTeam - 2021
+ */
+
+#pragma once
+#include <Arduino.h>
+
+#define WIFI_SCAN_MAX 20             // maximo de redes que se guardan
+#ifndef WIFI_SCAN_INTERVAL
+#define WIFI_SCAN_INTERVAL 0         // cada cuanto se refresca solo (ms), 0 => solo a pedido
+#endif
+
+struct WifiScanNet
+{
+    char ssid[33];
+    int32_t rssi;
+    uint8_t encryption; // wifi_auth_mode_t
+};
+
+extern void WifiScanLoop();                         // llamar en el loop: arranca los scans y junta los resultados
+extern void WifiScanRequest();                      // pide un scan nuevo (no bloquea)
+extern void WifiScanSetInterval(uint32_t interval); // 0 => solo a pedido
+extern bool WifiScanRunning();                      // hay un scan en curso?
+extern uint32_t WifiScanAge();                      // ms desde el ultimo scan terminado (UINT32_MAX si no hubo)
+extern int WifiScanCount();                         // cantidad de redes en el cache
+extern const WifiScanNet &WifiScanGet(int index);   // red del cache
@@ -0,0 +1,89 @@
+/**
+ * Arduino.h para la PC (env:native del platformio.ini).
+ *
+ * HostFakes reemplaza el core de Arduino del ESP32 con lo que usa el proyecto,
+ * asi el portal entero corre como un programa de Linux y se puede probar por loopback:
+ *   - FS.h, SD.h, SPIFFS.h: file systems en RAM (MemFS, con demoras configurables)
+ *   - WiFiUdp.h: sockets UDP de verdad (MemUdp.h: uno en RAM para los tests)
+ *   - WebServer.h: HTTP de verdad sobre TCP (MemClient.h: pedidos en RAM para los tests)
+ *   - EEPROM.h, WiFi.h, ESPmDNS.h: en RAM, sin radio
+ *   - freertos/: tareas con pthreads, criticals con mutex recursivos
+ *
+ * Los servidores escuchan solo en 127.0.0.1. El 53 y el 80 piden root, asi que los puertos
+ * se pueden correr con la variable de entorno HOST_PORT_OFFSET:
+ *
+ *      pio run -e native && HOST_PORT_OFFSET=8000 .pio/build/native/program   (DNS 8053, HTTP 8080)
+ *
+ * Con MEM_STATS_HABILITADO tambien se cuentan los new/delete (ver operator new en Host.cpp).
+ *
+ * JJTeam - 2021
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <ctype.h>
+#include <math.h>
+#include <algorithm>
+
+#include "WString.h"
+#include "Printable.h"
+#include "Print.h"
+#include "Stream.h"
+#include "IPAddress.h"
+#include "HardwareSerial.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include "esp_system.h"
+
+typedef bool boolean;
+typedef uint8_t byte;
+typedef unsigned int word;
+
+#define PROGMEM
+#define PGM_P const char *
+
+using std::max;
+using std::min;
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt))) // como en el core
+
+unsigned long millis();
+unsigned long micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us); // espera activa, como en el ESP32
+void yield();
+
+long random(long howbig);
+long random(long howsmall, long howbig);
+void randomSeed(unsigned long seed);
+
+uint32_t getCpuFrequencyMhz();
+
+char *itoa(int value, char *str, int base);
+char *ltoa(long value, char *str, int base);
+char *utoa(unsigned value, char *str, int base);
+char *ultoa(unsigned long value, char *str, int base);
+
+// glibc la tiene recien desde la 2.38
+#if defined(__GLIBC__)
+#if !__GLIBC_PREREQ(2, 38)
+#define HOST_STRLCPY
+extern "C" size_t strlcpy(char *dst, const char *src, size_t size);
+#endif
+#endif
+
+// los declara el core del ESP32 (un static con el mismo nombre no compila)
+void init(void);
+void initVariant(void);
+
+// los define el sketch
+void setup();
+void loop();
+
+// puerto real de un servidor: port + HOST_PORT_OFFSET
+uint16_t hostPort(uint16_t port);
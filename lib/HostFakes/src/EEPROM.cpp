@@ -0,0 +1,76 @@
+/*
+    EEPROM.cpp (PC)
+    Ver EEPROM.h
+
+    JJTeam - 2021
+*/
+
+#include "EEPROM.h"
+
+EEPROMClass EEPROM;
+
+static uint8_t flash[EEPROM_FLASH_SIZE];
+static bool flashInit = false;
+
+bool EEPROMClass::begin(size_t size)
+{
+    if (size == 0 || size > EEPROM_FLASH_SIZE)
+        return false;
+    if (!flashInit)
+        erase();
+    free(_data); // como en el core: un begin() de nuevo descarta lo que no se grabo
+    _data = (uint8_t *)malloc(size);
+    if (_data == nullptr)
+        return false;
+    memcpy(_data, flash, size);
+    _size = size;
+    _dirty = false;
+    return true;
+}
+
+uint8_t EEPROMClass::read(int address)
+{
+    return address >= 0 && (size_t)address < _size ? _data[address] : 0;
+}
+
+void EEPROMClass::write(int address, uint8_t val)
+{
+    if (address < 0 || (size_t)address >= _size || _data[address] == val)
+        return;
+    _data[address] = val;
+    _dirty = true;
+}
+
+bool EEPROMClass::commit()
+{
+    if (_data == nullptr)
+        return false;
+    if (!_dirty)
+        return true;
+    memcpy(flash, _data, _size);
+    _dirty = false;
+    _commits++;
+    return true;
+}
+
+void EEPROMClass::end()
+{
+    if (_data == nullptr)
+        return;
+    commit();
+    free(_data);
+    _data = nullptr;
+    _size = 0;
+}
+
+uint8_t *EEPROMClass::getDataPtr()
+{
+    _dirty = true;
+    return _data;
+}
+
+void EEPROMClass::erase()
+{
+    memset(flash, 0xFF, sizeof(flash));
+    flashInit = true;
+}
@@ -0,0 +1,60 @@
+/*
+    EEPROM.h (PC)
+    Como la del ESP32: begin() copia la "flash" a RAM, commit() la graba (si cambio) y end() hace commit().
+    La flash es un array en RAM que arranca borrado (0xFF), y dura lo que dura el programa.
+
+    JJTeam - 2021
+*/
+
+#pragma once
+#include "Arduino.h"
+
+#define EEPROM_FLASH_SIZE 4096
+
+class EEPROMClass
+{
+private:
+    uint8_t *_data = nullptr;
+    size_t _size = 0;
+    bool _dirty = false;
+    uint32_t _commits = 0;
+
+public:
+    ~EEPROMClass() { end(); }
+
+    bool begin(size_t size);
+    uint8_t read(int address);
+    void write(int address, uint8_t val);
+    bool commit();
+    void end();
+    uint8_t *getDataPtr();
+    size_t length() { return _size; }
+
+    // solo en la PC
+    uint32_t commits() const { return _commits; } // veces que se grabo la flash
+    void erase();                                 // deja la flash como nueva (0xFF)
+
+    template <typename T>
+    T &get(int address, T &t)
+    {
+        if (address < 0 || address + sizeof(T) > _size)
+            return t;
+        memcpy((uint8_t *)&t, _data + address, sizeof(T));
+        return t;
+    }
+
+    template <typename T>
+    const T &put(int address, const T &t)
+    {
+        if (address < 0 || address + sizeof(T) > _size)
+            return t;
+        if (memcmp(_data + address, (const uint8_t *)&t, sizeof(T)) != 0)
+        {
+            memcpy(_data + address, (const uint8_t *)&t, sizeof(T));
+            _dirty = true;
+        }
+        return t;
+    }
+};
+
+extern EEPROMClass EEPROM;
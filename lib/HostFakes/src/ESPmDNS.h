@@ -0,0 +1,19 @@
+/*
+    ESPmDNS.h (PC)
+    No anuncia nada (en la PC el nombre no se resuelve).
+
+    JJTeam - 2021
+*/
+
+#pragma once
+#include "Arduino.h"
+
+class MDNSResponder
+{
+public:
+    bool begin(const char *hostName) { return hostName != nullptr && hostName[0] != 0; }
+    void end() {}
+    void addService(const char *service, const char *proto, uint16_t port) {}
+};
+
+extern MDNSResponder MDNS;
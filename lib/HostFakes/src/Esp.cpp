@@ -0,0 +1,128 @@
+/*
+    Esp.cpp (PC)
+    Las funciones del ESP-IDF que usa el proyecto (esp_system.h, esp_heap_caps.h, esp_ipc.h, esp_log.h).
+
+    JJTeam - 2021
+*/
+
+#include "Arduino.h"
+#include "esp_heap_caps.h"
+#include "esp_ipc.h"
+#include "esp_log.h"
+#include "esp_system.h"
+#include <freertos/FreeRTOS.h>
+#include <malloc.h>
+
+#define HOST_SHUTDOWN_HANDLERS 5
+
+static shutdown_handler_t shutdownHandlers[HOST_SHUTDOWN_HANDLERS];
+
+esp_reset_reason_t esp_reset_reason()
+{
+    return ESP_RST_POWERON;
+}
+
+// una MAC de Espressif fija (el numero de serie sale de los ultimos 3 bytes)
+esp_err_t esp_efuse_mac_get_default(uint8_t *mac)
+{
+    const uint8_t fixed[6] = {0x7C, 0x9E, 0xBD, 0x12, 0x34, 0x56};
+    memcpy(mac, fixed, sizeof(fixed));
+    return ESP_OK;
+}
+
+esp_err_t esp_register_shutdown_handler(shutdown_handler_t handler)
+{
+    for (shutdown_handler_t &h : shutdownHandlers)
+    {
+        if (h == nullptr)
+        {
+            h = handler;
+            return ESP_OK;
+        }
+    }
+    return ESP_ERR_NO_MEM;
+}
+
+const char *esp_get_idf_version()
+{
+    return "host";
+}
+
+void esp_restart()
+{
+    for (shutdown_handler_t h : shutdownHandlers)
+        if (h)
+            h();
+    fflush(stdout);
+    exit(0);
+}
+
+//----------------------------------------------------------------------------
+
+// lo que malloc tenia en uso al arrancar (la libc, stdout...) no cuenta
+static size_t heapInUse()
+{
+    struct mallinfo2 info = mallinfo2();
+    return info.uordblks + info.hblkhd;
+}
+
+static const size_t heapBaseline = heapInUse();
+static size_t heapMinFree = HOST_HEAP_SIZE;
+
+size_t heap_caps_get_free_size(uint32_t caps)
+{
+    size_t used = heapInUse();
+    used = used > heapBaseline ? used - heapBaseline : 0;
+    size_t free = used < HOST_HEAP_SIZE ? HOST_HEAP_SIZE - used : 0;
+    size_t low = __atomic_load_n(&heapMinFree, __ATOMIC_RELAXED);
+    while (free < low && !__atomic_compare_exchange_n(&heapMinFree, &low, free, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+    {
+    }
+    return free;
+}
+
+size_t heap_caps_get_minimum_free_size(uint32_t caps)
+{
+    heap_caps_get_free_size(caps);
+    return heapMinFree;
+}
+
+size_t heap_caps_get_largest_free_block(uint32_t caps)
+{
+    return heap_caps_get_free_size(caps);
+}
+
+uint32_t esp_get_free_heap_size()
+{
+    return heap_caps_get_free_size(MALLOC_CAP_DEFAULT);
+}
+
+//----------------------------------------------------------------------------
+
+esp_err_t esp_ipc_call(uint32_t cpu_id, esp_ipc_func_t func, void *arg)
+{
+    return esp_ipc_call_blocking(cpu_id, func, arg);
+}
+
+esp_err_t esp_ipc_call_blocking(uint32_t cpu_id, esp_ipc_func_t func, void *arg)
+{
+    if (cpu_id >= portNUM_PROCESSORS)
+        return ESP_ERR_INVALID_ARG;
+    func(arg);
+    return ESP_OK;
+}
+
+//----------------------------------------------------------------------------
+
+void esp_log_write(esp_log_level_t level, const char *tag, const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    vfprintf(stderr, format, args);
+    va_end(args);
+}
+
+uint32_t esp_log_timestamp()
+{
+    return millis();
+}
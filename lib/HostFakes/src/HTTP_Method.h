@@ -0,0 +1,19 @@
+/*
+    HTTP_Method.h (PC)
+
+    JJTeam - 2021
+*/
+
+#pragma once
+
+typedef enum
+{
+    HTTP_ANY,
+    HTTP_GET,
+    HTTP_HEAD,
+    HTTP_POST,
+    HTTP_PUT,
+    HTTP_PATCH,
+    HTTP_DELETE,
+    HTTP_OPTIONS
+} HTTPMethod;
@@ -0,0 +1,30 @@
+/*
+    HardwareSerial.cpp (PC)
+    Ver HardwareSerial.h
+
+    JJTeam - 2021
+*/
+
+#include "HardwareSerial.h"
+#include <stdio.h>
+
+HardwareSerial Serial;
+
+void HardwareSerial::flush()
+{
+    fflush(stdout);
+}
+
+size_t HardwareSerial::write(uint8_t c)
+{
+    if (!muted)
+        fputc(c, stdout);
+    return 1;
+}
+
+size_t HardwareSerial::write(const uint8_t *buffer, size_t size)
+{
+    if (!muted)
+        fwrite(buffer, 1, size, stdout);
+    return size;
+}
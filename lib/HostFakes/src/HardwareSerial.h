@@ -0,0 +1,32 @@
+/*
+    HardwareSerial.h (PC)
+    Serial escribe en la salida estandar (no se le puede escribir nada).
+
+    JJTeam - 2021
+*/
+
+#pragma once
+#include "Stream.h"
+
+class HardwareSerial : public Stream
+{
+private:
+    bool muted = false;
+
+public:
+    void begin(unsigned long baud) {}
+    void end() {}
+    void setDebugOutput(bool enable) {}
+    void mute(bool enable) { muted = enable; } // solo en la PC: los tests lo callan
+
+    int available() override { return 0; }
+    int read() override { return -1; }
+    int peek() override { return -1; }
+    void flush() override;
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t *buffer, size_t size) override;
+    using Print::write;
+    operator bool() const { return true; }
+};
+
+extern HardwareSerial Serial;
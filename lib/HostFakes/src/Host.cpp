@@ -0,0 +1,192 @@
+/*
+    Host.cpp (PC)
+    Lo basico del core de Arduino (tiempo, random, itoa...), los objetos globales
+    y el main() que llama a setup() y loop(). Ver Arduino.h
+
+    JJTeam - 2021
+*/
+
+#include "Arduino.h"
+#include "EEPROM.h"
+#include "ESPmDNS.h"
+#include "SD.h"
+#include "SPIFFS.h"
+#include <chrono>
+#include <new>
+#include <thread>
+
+SPIClass SPI;
+SDFS SD;
+SPIFFSFS SPIFFS;
+MDNSResponder MDNS;
+
+static const std::chrono::steady_clock::time_point bootTime = std::chrono::steady_clock::now();
+
+int64_t esp_timer_get_time()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - bootTime).count();
+}
+
+unsigned long millis()
+{
+    return (unsigned long)(uint32_t)(esp_timer_get_time() / 1000);
+}
+
+unsigned long micros()
+{
+    return (unsigned long)(uint32_t)esp_timer_get_time();
+}
+
+void delay(uint32_t ms)
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+void delayMicroseconds(uint32_t us)
+{
+    if (us == 0)
+        return;
+    int64_t end = esp_timer_get_time() + us;
+    while (esp_timer_get_time() < end)
+    {
+    }
+}
+
+void yield()
+{
+    std::this_thread::yield();
+}
+
+long random(long howbig)
+{
+    return howbig > 0 ? ::random() % howbig : 0;
+}
+
+long random(long howsmall, long howbig)
+{
+    return howsmall < howbig ? howsmall + random(howbig - howsmall) : howsmall;
+}
+
+void randomSeed(unsigned long seed)
+{
+    if (seed != 0)
+        srandom(seed);
+}
+
+uint32_t getCpuFrequencyMhz()
+{
+    return 240;
+}
+
+char *ultoa(unsigned long value, char *str, int base)
+{
+    char tmp[8 * sizeof(long) + 1];
+    int n = 0;
+    if (base < 2 || base > 36)
+        base = 10;
+    do
+    {
+        int digit = value % base;
+        tmp[n++] = digit < 10 ? '0' + digit : 'a' + digit - 10;
+        value /= base;
+    } while (value > 0);
+    char *p = str;
+    while (n > 0)
+        *p++ = tmp[--n];
+    *p = 0;
+    return str;
+}
+
+char *ltoa(long value, char *str, int base)
+{
+    if (value < 0 && base == 10)
+    {
+        str[0] = '-';
+        ultoa(0ul - (unsigned long)value, str + 1, base);
+        return str;
+    }
+    return ultoa((unsigned long)value, str, base);
+}
+
+char *utoa(unsigned value, char *str, int base)
+{
+    return ultoa(value, str, base);
+}
+
+char *itoa(int value, char *str, int base)
+{
+    return ltoa(value, str, base);
+}
+
+#ifdef HOST_STRLCPY
+size_t strlcpy(char *dst, const char *src, size_t size)
+{
+    size_t len = strlen(src);
+    if (size > 0)
+    {
+        size_t n = len < size - 1 ? len : size - 1;
+        memcpy(dst, src, n);
+        dst[n] = 0;
+    }
+    return len;
+}
+#endif
+
+uint16_t hostPort(uint16_t port)
+{
+    static const long offset = getenv("HOST_PORT_OFFSET") ? atol(getenv("HOST_PORT_OFFSET")) : 0;
+    return port + offset;
+}
+
+// como el loopTask del ESP32 (los tests de Unity tienen su propio main())
+__attribute__((weak)) int main()
+{
+    setup();
+    for (;;)
+        loop();
+}
+
+// new y delete van por malloc y free: asi pasan por los --wrap de MemStats
+// (los de la libstdc++ llaman a malloc desde adentro de la libreria, y esos no se ven)
+void *operator new(size_t size)
+{
+    void *p = malloc(size ? size : 1);
+    if (p == nullptr)
+        throw std::bad_alloc();
+    return p;
+}
+
+void *operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void *operator new(size_t size, const std::nothrow_t &) noexcept
+{
+    return malloc(size ? size : 1);
+}
+
+void *operator new[](size_t size, const std::nothrow_t &) noexcept
+{
+    return malloc(size ? size : 1);
+}
+
+void operator delete(void *p) noexcept
+{
+    free(p);
+}
+
+void operator delete[](void *p) noexcept
+{
+    free(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+    free(p);
+}
+
+void operator delete[](void *p, size_t) noexcept
+{
+    free(p);
+}
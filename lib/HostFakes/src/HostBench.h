@@ -0,0 +1,125 @@
+/*
+    HostBench.h (PC)
+    Mide una operacion en los benchmarks (test/test_bench_*, env:native_bench):
+    operaciones/s, p50 y p99 de cada una, y pedidos al heap por operacion (MemStats de la tarea actual).
+    El resultado sale en JSON, una linea por benchmark; con la variable de entorno BENCH_JSON=archivo
+    las lineas tambien se agregan a ese archivo (para comparar corridas).
+
+        HostBench bench("fsbuffer.write", 2000);
+        bench.run([&](uint32_t i) { buffer.write(line, len); });
+        bench.report();
+
+    Los tiempos de la SD/SPIFFS se inyectan en MemFS con benchFsLatency(), que toma los valores
+    por defecto del benchmark o los de BENCH_FS_LATENCY="open,read,write,flush" (us).
+
+    JJTeam - 2021
+*/
+
+#pragma once
+
+#include <Arduino.h>
+#include <MemFS.h>
+#include <algorithm>
+#include <time.h>
+#include <vector>
+#include "MemStats.h"
+
+class HostBench
+{
+public:
+    // ops: cantidad de operaciones (los tiempos de cada una se guardan, la memoria se pide aca)
+    HostBench(const char *name, uint32_t ops) : name(name), ops(ops) { samples.resize(ops); }
+
+    template <typename Op>
+    void run(Op op)
+    {
+        uint32_t allocs0, bytes0, allocs1, bytes1;
+        MemStatsTask(allocs0, bytes0);
+        uint64_t start = now();
+        uint64_t last = start;
+        for (uint32_t i = 0; i < ops; i++)
+        {
+            op(i);
+            uint64_t t = now();
+            samples[i] = t - last;
+            last = t;
+        }
+        totalNs = last - start;
+        MemStatsTask(allocs1, bytes1);
+        allocs = allocs1 - allocs0;
+        bytes = bytes1 - bytes0;
+
+        std::sort(samples.begin(), samples.end());
+    }
+
+    double opsPerSecond() const { return totalNs ? ops * 1e9 / totalNs : 0; }
+    double p50() const { return percentile(50); } // us
+    double p99() const { return percentile(99); } // us
+    double allocsPerOp() const { return (double)allocs / ops; }
+    double bytesPerOp() const { return (double)bytes / ops; }
+
+    // extra: mas campos para el JSON, ya formateados (ej: "\"lines_per_s\":1234")
+    void report(const char *extra = nullptr) const
+    {
+        char line[512];
+        snprintf(line, sizeof(line),
+                 "{\"bench\":\"%s\",\"ops\":%u,\"ops_per_s\":%.1f,\"p50_us\":%.3f,\"p99_us\":%.3f,"
+                 "\"allocs_per_op\":%.3f,\"bytes_per_op\":%.1f%s%s}",
+                 name, ops, opsPerSecond(), p50(), p99(), allocsPerOp(), bytesPerOp(),
+                 extra ? "," : "", extra ? extra : "");
+        printf("%s\n", line);
+        const char *path = getenv("BENCH_JSON");
+        if (path != nullptr && *path)
+        {
+            FILE *f = fopen(path, "a");
+            if (f)
+            {
+                fprintf(f, "%s\n", line);
+                fclose(f);
+            }
+        }
+    }
+
+private:
+    const char *name;
+    uint32_t ops;
+    std::vector<uint32_t> samples; // ns de cada operacion
+    uint64_t totalNs = 0;
+    uint32_t allocs = 0;
+    uint32_t bytes = 0;
+
+    static uint64_t now()
+    {
+        timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+    }
+
+    double percentile(int p) const
+    {
+        if (ops == 0)
+            return 0;
+        return samples[std::min((size_t)ops - 1, (size_t)ops * p / 100)] / 1000.0;
+    }
+};
+
+// las demoras de MemFS para el benchmark: las por defecto, o las de BENCH_FS_LATENCY="open,read,write,flush"
+inline MemFSLatency benchFsLatency(uint32_t open, uint32_t read, uint32_t write, uint32_t flush)
+{
+    MemFSLatency latency;
+    latency.open = open;
+    latency.read = read;
+    latency.write = write;
+    latency.flush = flush;
+    const char *env = getenv("BENCH_FS_LATENCY");
+    if (env != nullptr && *env)
+        sscanf(env, "%u,%u,%u,%u", &latency.open, &latency.read, &latency.write, &latency.flush);
+    return latency;
+}
+
+// para el JSON: las demoras que se usaron
+inline void benchFsLatencyJson(char *out, size_t size, const MemFSLatency &latency)
+{
+    snprintf(out, size, "\"fs_latency_us\":{\"open\":%u,\"read\":%u,\"write\":%u,\"flush\":%u}",
+             latency.open, latency.read, latency.write, latency.flush);
+}
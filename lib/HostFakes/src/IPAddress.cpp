@@ -0,0 +1,34 @@
+/*
+    IPAddress.cpp (PC)
+    Ver IPAddress.h
+
+    JJTeam - 2021
+*/
+
+#include "IPAddress.h"
+#include "Print.h"
+#include <stdio.h>
+
+bool IPAddress::fromString(const char *address)
+{
+    unsigned a, b, c, d;
+    char end;
+    if (sscanf(address, "%u.%u.%u.%u%c", &a, &b, &c, &d, &end) != 4 || a > 255 || b > 255 || c > 255 || d > 255)
+        return false;
+    *this = IPAddress(a, b, c, d);
+    return true;
+}
+
+size_t IPAddress::printTo(Print &p) const
+{
+    char buf[16];
+    snprintf(buf, sizeof(buf), "%u.%u.%u.%u", _address.bytes[0], _address.bytes[1], _address.bytes[2], _address.bytes[3]);
+    return p.print(buf);
+}
+
+String IPAddress::toString() const
+{
+    char buf[16];
+    snprintf(buf, sizeof(buf), "%u.%u.%u.%u", _address.bytes[0], _address.bytes[1], _address.bytes[2], _address.bytes[3]);
+    return String(buf);
+}
@@ -0,0 +1,46 @@
+/*
+    IPAddress.h (PC)
+    Igual que el del ESP32: los 4 bytes en orden de red, y como uint32_t tal cual estan en memoria.
+
+    JJTeam - 2021
+*/
+
+#pragma once
+#include <stdint.h>
+#include <string.h>
+#include "Printable.h"
+#include "WString.h"
+
+class IPAddress : public Printable
+{
+private:
+    union
+    {
+        uint8_t bytes[4];
+        uint32_t dword;
+    } _address;
+
+public:
+    IPAddress() { _address.dword = 0; }
+    IPAddress(uint8_t first, uint8_t second, uint8_t third, uint8_t fourth)
+    {
+        _address.bytes[0] = first;
+        _address.bytes[1] = second;
+        _address.bytes[2] = third;
+        _address.bytes[3] = fourth;
+    }
+    IPAddress(uint32_t address) { _address.dword = address; }
+    IPAddress(const uint8_t *address) { memcpy(_address.bytes, address, 4); }
+
+    bool fromString(const char *address);
+    bool fromString(const String &address) { return fromString(address.c_str()); }
+
+    operator uint32_t() const { return _address.dword; }
+    bool operator==(const IPAddress &addr) const { return _address.dword == addr._address.dword; }
+    bool operator!=(const IPAddress &addr) const { return _address.dword != addr._address.dword; }
+    uint8_t operator[](int index) const { return _address.bytes[index]; }
+    uint8_t &operator[](int index) { return _address.bytes[index]; }
+
+    size_t printTo(Print &p) const override;
+    String toString() const;
+};
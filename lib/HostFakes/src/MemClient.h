@@ -0,0 +1,84 @@
+/*
+    MemClient.h (PC)
+    Conexion en RAM para probar el WebServer sin sockets: se le pasa el pedido HTTP entero
+    y la respuesta queda en response().
+
+        MemClient client("GET /logs?tail=10 HTTP/1.1\r\nHost: 172.217.28.1\r\n\r\n");
+        server.handleClient(client);
+        // client.response()
+
+    La respuesta se reserva de antemano, asi el MemClient no pide memoria mientras
+    se atiende el pedido (no ensucia lo que mide MemStats).
+
+    JJTeam - 2021
+*/
+
+#pragma once
+#include <string>
+#include "WiFiClient.h"
+
+#define MEM_CLIENT_RESPONSE_RESERVE (64 * 1024)
+
+class MemClientImpl : public WiFiClientImpl
+{
+public:
+    std::string request;
+    size_t pos = 0;
+    std::string response;
+    bool open = true;
+    IPAddress local;
+    IPAddress remote;
+
+    size_t write(const uint8_t *buf, size_t size) override
+    {
+        if (!open)
+            return 0;
+        response.append((const char *)buf, size);
+        return size;
+    }
+    int available() override { return request.size() - pos; }
+    int read(uint8_t *buf, size_t size) override
+    {
+        if (pos == request.size())
+            return open ? 0 : -1;
+        size_t n = std::min(size, request.size() - pos);
+        memcpy(buf, request.data() + pos, n);
+        pos += n;
+        return n;
+    }
+    int peek() override { return pos < request.size() ? (uint8_t)request[pos] : -1; }
+    bool connected() override { return open; }
+    void stop() override { open = false; }
+    IPAddress localIP() override { return local; }
+    IPAddress remoteIP() override { return remote; }
+    uint16_t remotePort() override { return 50000; }
+};
+
+class MemClient : public WiFiClient
+{
+public:
+    // local: la IP del equipo por la que llega el pedido (el soft AP por defecto)
+    MemClient(const char *request, IPAddress local = IPAddress(172, 217, 28, 1), IPAddress remote = IPAddress(172, 217, 28, 2))
+        : WiFiClient(std::make_shared<MemClientImpl>())
+    {
+        reset(request);
+        mem()->local = local;
+        mem()->remote = remote;
+    }
+
+    // vuelve a empezar con otro pedido (sin liberar la memoria de la respuesta)
+    void reset(const char *request)
+    {
+        MemClientImpl *m = mem();
+        m->request = request;
+        m->pos = 0;
+        m->response.clear();
+        m->response.reserve(MEM_CLIENT_RESPONSE_RESERVE);
+        m->open = true;
+    }
+
+    const std::string &response() { return mem()->response; }
+
+private:
+    MemClientImpl *mem() { return static_cast<MemClientImpl *>(impl.get()); }
+};
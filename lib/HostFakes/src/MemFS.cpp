@@ -0,0 +1,222 @@
+/*
+    MemFS.cpp (PC)
+    Ver MemFS.h
+
+    JJTeam - 2021
+*/
+
+#include "MemFS.h"
+
+// lo que se reserva para el buffer de escritura de cada File (como el de la SD)
+#define MEMFS_WRITE_BUFFER 4096
+
+typedef std::shared_ptr<std::vector<uint8_t>> MemFileData;
+
+class MemFSImpl : public fs::FSImpl, public std::enable_shared_from_this<MemFSImpl>
+{
+public:
+    std::mutex mutex;
+    std::map<std::string, MemFileData> files;
+    std::set<std::string> dirs;
+    MemFSLatency latency;
+    MemFSCounters counters = {};
+
+    fs::FileImplPtr open(const char *path, const char *mode) override;
+    bool exists(const char *path) override;
+    bool rename(const char *pathFrom, const char *pathTo) override;
+    bool remove(const char *path) override;
+    bool mkdir(const char *path) override;
+    bool rmdir(const char *path) override;
+};
+
+class MemFileImpl : public fs::FileImpl
+{
+private:
+    std::shared_ptr<MemFSImpl> fs;
+    std::string path;
+    MemFileData data; // nullptr => es una carpeta
+    bool writable;
+    bool open = true;
+    size_t pos = 0;
+    std::vector<uint8_t> pending; // escrito y todavia no bajado
+
+public:
+    MemFileImpl(std::shared_ptr<MemFSImpl> fs, const std::string &path, MemFileData data, bool writable)
+        : fs(fs), path(path), data(data), writable(writable)
+    {
+        if (writable)
+            pending.reserve(MEMFS_WRITE_BUFFER);
+    }
+    ~MemFileImpl() { close(); }
+
+    size_t write(const uint8_t *buf, size_t size) override
+    {
+        if (!open || !writable || data == nullptr)
+            return 0;
+        delayMicroseconds(fs->latency.write);
+        pending.insert(pending.end(), buf, buf + size);
+        std::lock_guard<std::mutex> lock(fs->mutex);
+        fs->counters.writes++;
+        return size;
+    }
+
+    size_t read(uint8_t *buf, size_t size) override
+    {
+        if (!open || writable || data == nullptr)
+            return 0;
+        delayMicroseconds(fs->latency.read);
+        std::lock_guard<std::mutex> lock(fs->mutex);
+        fs->counters.reads++;
+        if (pos >= data->size())
+            return 0;
+        size_t n = std::min(size, data->size() - pos);
+        memcpy(buf, data->data() + pos, n);
+        pos += n;
+        return n;
+    }
+
+    void flush() override
+    {
+        if (!open || pending.empty())
+            return;
+        delayMicroseconds(fs->latency.flush);
+        std::lock_guard<std::mutex> lock(fs->mutex);
+        data->insert(data->end(), pending.begin(), pending.end());
+        fs->counters.flushes++;
+        fs->counters.bytesWritten += pending.size();
+        pending.clear();
+    }
+
+    bool seek(uint32_t offset, fs::SeekMode mode) override
+    {
+        if (!open || writable)
+            return false;
+        size_t base = mode == fs::SeekSet ? 0 : (mode == fs::SeekCur ? pos : size());
+        if (base + offset > size())
+            return false;
+        pos = base + offset;
+        return true;
+    }
+
+    size_t position() const override { return writable ? size() : pos; }
+
+    size_t size() const override
+    {
+        if (data == nullptr)
+            return 0;
+        std::lock_guard<std::mutex> lock(fs->mutex);
+        return data->size() + pending.size();
+    }
+
+    void close() override
+    {
+        flush();
+        open = false;
+    }
+
+    const char *name() const override { return path.c_str(); }
+    bool isDirectory() const override { return data == nullptr; }
+    operator bool() override { return open; }
+};
+
+fs::FileImplPtr MemFSImpl::open(const char *path, const char *mode)
+{
+    delayMicroseconds(latency.open);
+    std::lock_guard<std::mutex> lock(mutex);
+    counters.opens++;
+
+    std::string name(path);
+    if (dirs.count(name))
+        return std::make_shared<MemFileImpl>(shared_from_this(), name, nullptr, false);
+
+    auto it = files.find(name);
+    if (mode[0] == 'r')
+    {
+        if (it == files.end())
+            return nullptr;
+        return std::make_shared<MemFileImpl>(shared_from_this(), name, it->second, false);
+    }
+
+    if (it == files.end())
+        it = files.emplace(name, std::make_shared<std::vector<uint8_t>>()).first;
+    else if (mode[0] == 'w')
+        it->second->clear();
+    return std::make_shared<MemFileImpl>(shared_from_this(), name, it->second, true);
+}
+
+bool MemFSImpl::exists(const char *path)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return files.count(path) || dirs.count(path);
+}
+
+bool MemFSImpl::rename(const char *pathFrom, const char *pathTo)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = files.find(pathFrom);
+    if (it == files.end())
+        return false;
+    files[pathTo] = it->second;
+    files.erase(pathFrom);
+    return true;
+}
+
+// los Files que ya estaban abiertos siguen con su copia (como en SPIFFS)
+bool MemFSImpl::remove(const char *path)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return files.erase(path) > 0;
+}
+
+bool MemFSImpl::mkdir(const char *path)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    dirs.insert(path);
+    return true;
+}
+
+bool MemFSImpl::rmdir(const char *path)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return dirs.erase(path) > 0;
+}
+
+//----------------------------------------------------------------------------
+
+MemFS::MemFS() : FS(std::make_shared<MemFSImpl>())
+{
+    mem = static_cast<MemFSImpl *>(_impl.get());
+}
+
+void MemFS::setLatency(const MemFSLatency &latency)
+{
+    std::lock_guard<std::mutex> lock(mem->mutex);
+    mem->latency = latency;
+}
+
+const MemFSCounters &MemFS::counters() const
+{
+    return mem->counters;
+}
+
+void MemFS::resetCounters()
+{
+    std::lock_guard<std::mutex> lock(mem->mutex);
+    mem->counters = {};
+}
+
+void MemFS::clear()
+{
+    std::lock_guard<std::mutex> lock(mem->mutex);
+    mem->files.clear();
+    mem->dirs.clear();
+}
+
+std::string MemFS::contents(const char *path)
+{
+    std::lock_guard<std::mutex> lock(mem->mutex);
+    auto it = mem->files.find(path);
+    if (it == mem->files.end())
+        return "";
+    return std::string(it->second->begin(), it->second->end());
+}
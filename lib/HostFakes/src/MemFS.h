@@ -0,0 +1,61 @@
+/*
+    MemFS.h (PC)
+    File system en RAM, para correr FsBuffer/FsLog y los tests en la PC.
+
+    Se porta como la SD y la SPIFFS del ESP32 en lo que le importa a FsBuffer:
+      - lo que se escribe queda en el buffer del File hasta el flush() o close(),
+        y recien ahi lo ven los otros Files abiertos (o que se abran despues)
+      - "w" borra el contenido al abrir, "a" escribe siempre al final
+
+    Las demoras de la memoria se simulan con setLatency() (espera activa, en us),
+    y los contadores permiten ver cuantas operaciones llegaron al "disco".
+
+    JJTeam - 2021
+*/
+
+#pragma once
+
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+#include "FS.h"
+
+// demora de cada operacion (us)
+struct MemFSLatency
+{
+    uint32_t open = 0;
+    uint32_t read = 0;  // por cada read()
+    uint32_t write = 0; // por cada write() (al buffer del File)
+    uint32_t flush = 0; // por cada flush() o close() con datos pendientes
+};
+
+// operaciones hechas desde el ultimo clear() o resetCounters()
+struct MemFSCounters
+{
+    uint32_t opens;
+    uint32_t reads;
+    uint32_t writes;
+    uint32_t flushes; // los que bajaron datos
+    uint32_t bytesWritten;
+};
+
+class MemFSImpl;
+
+class MemFS : public fs::FS
+{
+public:
+    MemFS();
+
+    void setLatency(const MemFSLatency &latency);
+    const MemFSCounters &counters() const;
+    void resetCounters();
+    void clear(); // borra todos los archivos y carpetas
+
+    // contenido ya bajado del archivo ("" si no existe)
+    std::string contents(const char *path);
+
+private:
+    MemFSImpl *mem;
+};
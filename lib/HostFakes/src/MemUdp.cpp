@@ -0,0 +1,69 @@
+/*
+    MemUdp.cpp (PC)
+    Ver MemUdp.h
+
+    JJTeam - 2021
+*/
+
+#include "MemUdp.h"
+
+bool MemUdp::push(const uint8_t *data, size_t length, IPAddress ip, uint16_t port)
+{
+    if (count == MEM_UDP_PACKETS || length > MEM_UDP_PACKET_SIZE)
+        return false;
+    Packet &packet = inbound[(head + count) % MEM_UDP_PACKETS];
+    memcpy(packet.data, data, length);
+    packet.length = length;
+    packet.ip = ip;
+    packet.port = port;
+    count++;
+    return true;
+}
+
+int MemUdp::parsePacket()
+{
+    current.length = pos = 0;
+    if (!open || count == 0)
+        return 0;
+    const Packet &packet = inbound[head];
+    memcpy(current.data, packet.data, packet.length);
+    current.length = packet.length;
+    current.ip = packet.ip;
+    current.port = packet.port;
+    head = (head + 1) % MEM_UDP_PACKETS;
+    count--;
+    return current.length;
+}
+
+int MemUdp::read(unsigned char *buffer, size_t len)
+{
+    size_t n = std::min(len, current.length - pos);
+    memcpy(buffer, current.data + pos, n);
+    pos += n;
+    return n;
+}
+
+int MemUdp::beginPacket(IPAddress ip, uint16_t port)
+{
+    lastIP = ip;
+    lastPort = port;
+    outLength = 0;
+    return 1;
+}
+
+size_t MemUdp::write(const uint8_t *buffer, size_t size)
+{
+    size_t n = std::min(size, sizeof(out) - outLength);
+    memcpy(out + outLength, buffer, n);
+    outLength += n;
+    return n;
+}
+
+int MemUdp::endPacket()
+{
+    memcpy(last, out, outLength);
+    lastLength = outLength;
+    outLength = 0;
+    sent++;
+    return 1;
+}
@@ -0,0 +1,83 @@
+/*
+    MemUdp.h (PC)
+    UDP en RAM para los tests y benchmarks del DNSServer (sin sockets ni memoria dinamica):
+    push() encola un paquete como si llegara de ip:port, y la ultima respuesta queda en reply().
+
+        MemUdp udp;
+        DNSServer dns(udp);
+        dns.start(53, "*", ip);
+        udp.push(query, sizeof(query), IPAddress(10, 0, 0, 2), 5353);
+        dns.processNextRequest();
+        // udp.reply(), udp.replyLength()
+
+    JJTeam - 2021
+*/
+
+#pragma once
+#include "Udp.h"
+
+#define MEM_UDP_PACKETS 32     // paquetes encolados como maximo (los demas se descartan)
+#define MEM_UDP_PACKET_SIZE 1500
+
+class MemUdp : public UDP
+{
+private:
+    struct Packet
+    {
+        uint8_t data[MEM_UDP_PACKET_SIZE];
+        size_t length;
+        IPAddress ip;
+        uint16_t port;
+    };
+
+    Packet inbound[MEM_UDP_PACKETS];
+    size_t head = 0;  // proximo a leer
+    size_t count = 0; // encolados
+    Packet current;   // el que devolvio parsePacket()
+    size_t pos = 0;
+    bool open = false;
+
+    uint8_t out[MEM_UDP_PACKET_SIZE];
+    size_t outLength = 0;
+    uint8_t last[MEM_UDP_PACKET_SIZE];
+    size_t lastLength = 0;
+    IPAddress lastIP;
+    uint16_t lastPort = 0;
+    uint32_t sent = 0;
+
+public:
+    MemUdp() { current.length = 0; }
+
+    // solo en la PC
+    bool push(const uint8_t *data, size_t length, IPAddress ip, uint16_t port); // false si la cola esta llena
+    const uint8_t *reply() const { return last; }
+    size_t replyLength() const { return lastLength; }
+    IPAddress replyIP() const { return lastIP; }
+    uint16_t replyPort() const { return lastPort; }
+    uint32_t replies() const { return sent; }
+    size_t pending() const { return count; }
+
+    uint8_t begin(uint16_t port) override
+    {
+        open = true;
+        return 1;
+    }
+    void stop() override { open = false; }
+
+    int beginPacket(IPAddress ip, uint16_t port) override;
+    int endPacket() override;
+    size_t write(uint8_t c) override { return write(&c, 1); }
+    size_t write(const uint8_t *buffer, size_t size) override;
+    using Print::write;
+
+    int parsePacket() override;
+    int available() override { return current.length - pos; }
+    int read() override { return pos < current.length ? current.data[pos++] : -1; }
+    int read(unsigned char *buffer, size_t len) override;
+    int read(char *buffer, size_t len) override { return read((unsigned char *)buffer, len); }
+    int peek() override { return pos < current.length ? current.data[pos] : -1; }
+    void flush() override { pos = current.length; }
+
+    IPAddress remoteIP() override { return current.ip; }
+    uint16_t remotePort() override { return current.port; }
+};
@@ -0,0 +1,75 @@
+/*
+    Print.cpp (PC)
+    Ver Print.h
+
+    JJTeam - 2021
+*/
+
+#include "Print.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+size_t Print::write(const uint8_t *buffer, size_t size)
+{
+    size_t n = 0;
+    while (size--)
+    {
+        if (write(*buffer++))
+            n++;
+        else
+            break;
+    }
+    return n;
+}
+
+size_t Print::printf(const char *format, ...)
+{
+    char loc_buf[64];
+    char *temp = loc_buf;
+    va_list arg;
+    va_list copy;
+    va_start(arg, format);
+    va_copy(copy, arg);
+    int len = vsnprintf(temp, sizeof(loc_buf), format, copy);
+    va_end(copy);
+    if (len < 0)
+    {
+        va_end(arg);
+        return 0;
+    }
+    if (len >= (int)sizeof(loc_buf))
+    {
+        temp = (char *)malloc(len + 1);
+        if (temp == nullptr)
+        {
+            va_end(arg);
+            return 0;
+        }
+        len = vsnprintf(temp, len + 1, format, arg);
+    }
+    va_end(arg);
+    len = write((uint8_t *)temp, len);
+    if (temp != loc_buf)
+        free(temp);
+    return len;
+}
+
+size_t Print::print(long n, int base)
+{
+    if (base == DEC && n < 0)
+        return write('-') + print(0ul - (unsigned long)n, base);
+    return print((unsigned long)n, base);
+}
+
+size_t Print::print(unsigned long n, int base)
+{
+    return print(String(n, (unsigned char)base));
+}
+
+size_t Print::print(double n, int digits)
+{
+    char buf[64];
+    int len = snprintf(buf, sizeof(buf), "%.*f", digits, n);
+    return write((const uint8_t *)buf, len > 0 ? len : 0);
+}
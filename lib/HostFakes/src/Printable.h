@@ -0,0 +1,19 @@
+/*
+    Printable.h (PC)
+    Ver Arduino.h
+
+    JJTeam - 2021
+*/
+
+#pragma once
+#include <stddef.h>
+
+class Print;
+
+// algo que se sabe imprimir (IPAddress, ...)
+class Printable
+{
+public:
+    virtual ~Printable() {}
+    virtual size_t printTo(Print &p) const = 0;
+};
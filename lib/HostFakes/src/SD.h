@@ -0,0 +1,27 @@
+/*
+    SD.h (PC)
+    La micro-SD es un MemFS. Por defecto "esta puesta", setCardPresent(false) la saca.
+
+    JJTeam - 2021
+*/
+
+#pragma once
+#include "MemFS.h"
+#include "SPI.h"
+
+class SDFS : public MemFS
+{
+private:
+    bool present = true;
+
+public:
+    bool begin(uint8_t ssPin = SS, SPIClass &spi = SPI, uint32_t frequency = 4000000,
+               const char *mountpoint = "/sd", uint8_t max_files = 5)
+    {
+        return present;
+    }
+    void end() {}
+    void setCardPresent(bool enable) { present = enable; } // solo en la PC
+};
+
+extern SDFS SD;
@@ -0,0 +1,20 @@
+/*
+    SPI.h (PC)
+    No hay bus SPI: solo para que compile SD.begin().
+
+    JJTeam - 2021
+*/
+
+#pragma once
+#include <stdint.h>
+
+#define SS 5
+
+class SPIClass
+{
+public:
+    void begin() {}
+    void end() {}
+};
+
+extern SPIClass SPI;
@@ -0,0 +1,31 @@
+/*
+    SPIFFS.h (PC)
+    La flash es un MemFS. setMountFails(true) simula una flash que no se puede montar.
+
+    JJTeam - 2021
+*/
+
+#pragma once
+#include "MemFS.h"
+
+class SPIFFSFS : public MemFS
+{
+private:
+    bool fails = false;
+
+public:
+    bool begin(bool formatOnFail = false, const char *basePath = "/spiffs", uint8_t maxOpenFiles = 10,
+               const char *partitionLabel = nullptr)
+    {
+        return !fails;
+    }
+    void end() {}
+    bool format()
+    {
+        clear();
+        return true;
+    }
+    void setMountFails(bool enable) { fails = enable; } // solo en la PC
+};
+
+extern SPIFFSFS SPIFFS;
@@ -0,0 +1,27 @@
+/*
+    Stream.h (PC)
+    Ver Arduino.h
+
+    JJTeam - 2021
+*/
+
+#pragma once
+#include "Print.h"
+
+class Stream : public Print
+{
+protected:
+    unsigned long _timeout = 1000; // ms que se espera un byte (como en el ESP32)
+    int timedRead();
+
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+
+    void setTimeout(unsigned long timeout) { _timeout = timeout; }
+    virtual size_t readBytes(char *buffer, size_t length);
+    size_t readBytes(uint8_t *buffer, size_t length) { return readBytes((char *)buffer, length); }
+    String readString();
+    String readStringUntil(char terminator);
+};
@@ -0,0 +1,417 @@
+/*
+    WString.cpp (PC)
+    Ver WString.h
+
+    JJTeam - 2021
+*/
+
+#include "WString.h"
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+void String::init()
+{
+    buffer = sso;
+    len = 0;
+    capacity = SSO_SIZE;
+    sso[0] = 0;
+}
+
+void String::invalidate()
+{
+    if (!isSSO())
+        free(buffer);
+    init();
+}
+
+String::String(const char *cstr)
+{
+    init();
+    if (cstr)
+        copy(cstr, strlen(cstr));
+}
+
+String::String(const char *cstr, unsigned int length)
+{
+    init();
+    if (cstr)
+        copy(cstr, length);
+}
+
+String::String(const String &str)
+{
+    init();
+    copy(str.buffer, str.len);
+}
+
+String::String(String &&str) noexcept
+{
+    init();
+    move(str);
+}
+
+String::String(char c)
+{
+    init();
+    copy(&c, 1);
+}
+
+static void numberToString(char *buf, size_t size, unsigned long value, bool negative, unsigned char base)
+{
+    char tmp[8 * sizeof(long) + 2];
+    size_t n = 0;
+    if (base < 2)
+        base = 10;
+    do
+    {
+        unsigned digit = value % base;
+        tmp[n++] = digit < 10 ? '0' + digit : 'a' + digit - 10;
+        value /= base;
+    } while (value > 0);
+    size_t i = 0;
+    if (negative && i + 1 < size)
+        buf[i++] = '-';
+    while (n > 0 && i + 1 < size)
+        buf[i++] = tmp[--n];
+    buf[i] = 0;
+}
+
+String::String(unsigned char value, unsigned char base) : String((unsigned long)value, base) {}
+String::String(int value, unsigned char base) : String((long)value, base) {}
+String::String(unsigned int value, unsigned char base) : String((unsigned long)value, base) {}
+
+String::String(long value, unsigned char base)
+{
+    init();
+    char buf[8 * sizeof(long) + 2];
+    bool negative = value < 0 && base == 10;
+    numberToString(buf, sizeof(buf), negative ? 0ul - (unsigned long)value : (unsigned long)value, negative, base);
+    copy(buf, strlen(buf));
+}
+
+String::String(unsigned long value, unsigned char base)
+{
+    init();
+    char buf[8 * sizeof(long) + 2];
+    numberToString(buf, sizeof(buf), value, false, base);
+    copy(buf, strlen(buf));
+}
+
+String::String(float value, unsigned char decimalPlaces) : String((double)value, decimalPlaces) {}
+
+String::String(double value, unsigned char decimalPlaces)
+{
+    init();
+    char buf[64];
+    snprintf(buf, sizeof(buf), "%.*f", decimalPlaces, value);
+    copy(buf, strlen(buf));
+}
+
+String::~String()
+{
+    if (!isSSO())
+        free(buffer);
+}
+
+String &String::operator=(const String &rhs)
+{
+    if (this != &rhs)
+        copy(rhs.buffer, rhs.len);
+    return *this;
+}
+
+String &String::operator=(String &&rhs) noexcept
+{
+    if (this != &rhs)
+        move(rhs);
+    return *this;
+}
+
+String &String::operator=(const char *cstr)
+{
+    if (cstr)
+        copy(cstr, strlen(cstr));
+    else
+        invalidate();
+    return *this;
+}
+
+bool String::reserve(unsigned int size)
+{
+    if (size <= capacity)
+        return true;
+    char *p = (char *)(isSSO() ? malloc(size + 1) : realloc(buffer, size + 1));
+    if (p == nullptr)
+        return false;
+    if (isSSO())
+        memcpy(p, sso, len + 1);
+    buffer = p;
+    capacity = size;
+    return true;
+}
+
+String &String::copy(const char *cstr, unsigned int length)
+{
+    // cstr puede ser parte de este mismo String
+    if (length > capacity)
+    {
+        char *p = (char *)malloc(length + 1);
+        if (p == nullptr)
+        {
+            invalidate();
+            return *this;
+        }
+        memcpy(p, cstr, length);
+        if (!isSSO())
+            free(buffer);
+        buffer = p;
+        capacity = length;
+    }
+    else
+        memmove(buffer, cstr, length);
+    len = length;
+    buffer[len] = 0;
+    return *this;
+}
+
+void String::move(String &rhs)
+{
+    if (!isSSO())
+        free(buffer);
+    if (rhs.isSSO())
+    {
+        init();
+        memcpy(sso, rhs.sso, rhs.len + 1);
+        len = rhs.len;
+    }
+    else
+    {
+        buffer = rhs.buffer;
+        len = rhs.len;
+        capacity = rhs.capacity;
+    }
+    rhs.init();
+}
+
+bool String::concat(const char *cstr)
+{
+    return cstr ? concat(cstr, strlen(cstr)) : false;
+}
+
+bool String::concat(const char *cstr, unsigned int length)
+{
+    if (length == 0)
+        return true;
+    // si cstr esta adentro de este String el reserve() lo puede mover
+    size_t offset = cstr >= buffer && cstr <= buffer + len ? cstr - buffer : (size_t)-1;
+    unsigned int needed = len + length;
+    if (needed > capacity && !reserve(needed > 2 * capacity ? needed : 2 * capacity))
+        return false;
+    if (offset != (size_t)-1)
+        cstr = buffer + offset;
+    memmove(buffer + len, cstr, length);
+    len = needed;
+    buffer[len] = 0;
+    return true;
+}
+
+int String::compareTo(const String &s) const
+{
+    return strcmp(buffer, s.buffer);
+}
+
+bool String::equals(const char *cstr) const
+{
+    return strcmp(buffer, cstr ? cstr : "") == 0;
+}
+
+bool String::equalsIgnoreCase(const String &s) const
+{
+    return len == s.len && strcasecmp(buffer, s.buffer) == 0;
+}
+
+bool String::startsWith(const String &prefix) const
+{
+    return prefix.len <= len && strncmp(buffer, prefix.buffer, prefix.len) == 0;
+}
+
+bool String::endsWith(const String &suffix) const
+{
+    return suffix.len <= len && strcmp(buffer + len - suffix.len, suffix.buffer) == 0;
+}
+
+void String::setCharAt(unsigned int index, char c)
+{
+    if (index < len)
+        buffer[index] = c;
+}
+
+char &String::operator[](unsigned int index)
+{
+    static char dummy;
+    if (index >= len)
+    {
+        dummy = 0;
+        return dummy;
+    }
+    return buffer[index];
+}
+
+void String::getBytes(unsigned char *buf, unsigned int bufsize, unsigned int index) const
+{
+    if (bufsize == 0 || buf == nullptr)
+        return;
+    if (index >= len)
+    {
+        buf[0] = 0;
+        return;
+    }
+    unsigned int n = bufsize - 1;
+    if (n > len - index)
+        n = len - index;
+    memcpy(buf, buffer + index, n);
+    buf[n] = 0;
+}
+
+int String::indexOf(char ch, unsigned int fromIndex) const
+{
+    if (fromIndex >= len)
+        return -1;
+    const char *p = strchr(buffer + fromIndex, ch);
+    return p ? p - buffer : -1;
+}
+
+int String::indexOf(const String &str, unsigned int fromIndex) const
+{
+    if (fromIndex >= len)
+        return -1;
+    const char *p = strstr(buffer + fromIndex, str.buffer);
+    return p ? p - buffer : -1;
+}
+
+int String::lastIndexOf(char ch) const
+{
+    const char *p = strrchr(buffer, ch);
+    return p ? p - buffer : -1;
+}
+
+String String::substring(unsigned int beginIndex, unsigned int endIndex) const
+{
+    if (beginIndex > endIndex)
+    {
+        unsigned int t = beginIndex;
+        beginIndex = endIndex;
+        endIndex = t;
+    }
+    if (beginIndex >= len)
+        return String();
+    if (endIndex > len)
+        endIndex = len;
+    return String(buffer + beginIndex, endIndex - beginIndex);
+}
+
+void String::replace(const String &find, const String &replace)
+{
+    if (find.len == 0)
+        return;
+    String result;
+    const char *p = buffer;
+    const char *match;
+    while ((match = strstr(p, find.buffer)) != nullptr)
+    {
+        result.concat(p, match - p);
+        result.concat(replace);
+        p = match + find.len;
+    }
+    result.concat(p);
+    move(result);
+}
+
+void String::remove(unsigned int index, unsigned int count)
+{
+    if (index >= len)
+        return;
+    if (count > len - index)
+        count = len - index;
+    memmove(buffer + index, buffer + index + count, len - index - count + 1);
+    len -= count;
+}
+
+void String::toLowerCase()
+{
+    for (unsigned int i = 0; i < len; i++)
+        buffer[i] = tolower((unsigned char)buffer[i]);
+}
+
+void String::toUpperCase()
+{
+    for (unsigned int i = 0; i < len; i++)
+        buffer[i] = toupper((unsigned char)buffer[i]);
+}
+
+void String::trim()
+{
+    unsigned int begin = 0;
+    while (begin < len && isspace((unsigned char)buffer[begin]))
+        begin++;
+    unsigned int end = len;
+    while (end > begin && isspace((unsigned char)buffer[end - 1]))
+        end--;
+    memmove(buffer, buffer + begin, end - begin);
+    len = end - begin;
+    buffer[len] = 0;
+}
+
+long String::toInt() const
+{
+    return atol(buffer);
+}
+
+float String::toFloat() const
+{
+    return atof(buffer);
+}
+
+double String::toDouble() const
+{
+    return atof(buffer);
+}
+
+String operator+(const String &lhs, const String &rhs)
+{
+    String s(lhs);
+    s.concat(rhs);
+    return s;
+}
+
+String operator+(const String &lhs, const char *rhs)
+{
+    String s(lhs);
+    s.concat(rhs);
+    return s;
+}
+
+String operator+(const char *lhs, const String &rhs)
+{
+    String s(lhs);
+    s.concat(rhs);
+    return s;
+}
+
+#define STRING_PLUS(type)                            \
+    String operator+(const String &lhs, type rhs) \
+    {                                                \
+        String s(lhs);                               \
+        s.concat(rhs);                               \
+        return s;                                    \
+    }
+
+STRING_PLUS(char)
+STRING_PLUS(unsigned char)
+STRING_PLUS(int)
+STRING_PLUS(unsigned int)
+STRING_PLUS(long)
+STRING_PLUS(unsigned long)
+STRING_PLUS(double)
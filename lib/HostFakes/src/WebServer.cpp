@@ -0,0 +1,399 @@
+/*
+    WebServer.cpp (PC)
+    Ver WebServer.h
+
+    JJTeam - 2021
+*/
+
+#include "WebServer.h"
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#define WEBSERVER_BACKLOG 32
+
+static const char *responseCodeToString(int code)
+{
+    switch (code)
+    {
+    case 200:
+        return "OK";
+    case 204:
+        return "No Content";
+    case 206:
+        return "Partial Content";
+    case 301:
+        return "Moved Permanently";
+    case 302:
+        return "Found";
+    case 304:
+        return "Not Modified";
+    case 400:
+        return "Bad Request";
+    case 404:
+        return "Not Found";
+    case 416:
+        return "Range not satisfiable";
+    case 500:
+        return "Internal Server Error";
+    default:
+        return "";
+    }
+}
+
+static int hexValue(char c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    c = tolower(c);
+    return c >= 'a' && c <= 'f' ? c - 'a' + 10 : -1;
+}
+
+// '+' => ' ' y %xx => el byte
+static String urlDecode(const char *text, size_t length)
+{
+    String decoded;
+    for (size_t i = 0; i < length; i++)
+    {
+        char c = text[i];
+        if (c == '+')
+            c = ' ';
+        else if (c == '%' && i + 2 < length && hexValue(text[i + 1]) >= 0 && hexValue(text[i + 2]) >= 0)
+        {
+            c = hexValue(text[i + 1]) * 16 + hexValue(text[i + 2]);
+            i += 2;
+        }
+        decoded += c;
+    }
+    return decoded;
+}
+
+void WebServer::begin()
+{
+    close();
+    _listenFd = socket(AF_INET, SOCK_STREAM, 0);
+    if (_listenFd < 0)
+        return;
+
+    int one = 1;
+    setsockopt(_listenFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    fcntl(_listenFd, F_SETFL, fcntl(_listenFd, F_GETFL) | O_NONBLOCK);
+
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(hostPort(_port));
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (bind(_listenFd, (sockaddr *)&addr, sizeof(addr)) != 0 || listen(_listenFd, WEBSERVER_BACKLOG) != 0)
+    {
+        perror("WebServer::begin");
+        close();
+    }
+}
+
+void WebServer::begin(uint16_t port)
+{
+    _port = port;
+    begin();
+}
+
+void WebServer::close()
+{
+    if (_listenFd >= 0)
+        ::close(_listenFd);
+    _listenFd = -1;
+}
+
+void WebServer::on(const String &uri, HTTPMethod method, THandlerFunction fn)
+{
+    _routes.push_back({uri, method, fn});
+}
+
+// sin pedidos espera 1 ms, como el del ESP32 (delay(1) cuando no hay cliente)
+void WebServer::handleClient()
+{
+    if (_listenFd < 0)
+    {
+        delay(1);
+        return;
+    }
+    pollfd p = {_listenFd, POLLIN, 0};
+    if (poll(&p, 1, 1) <= 0)
+        return;
+    int fd = accept(_listenFd, nullptr, nullptr);
+    if (fd < 0)
+        return;
+    WiFiClient client(fd);
+    handleClient(client);
+}
+
+void WebServer::handleClient(WiFiClient &client)
+{
+    static char request[HTTP_MAX_REQUEST + 1];
+    size_t length, bodyStart;
+
+    _currentClient = client;
+    _contentLength = CONTENT_LENGTH_NOT_SET;
+    _chunked = false;
+    _responseHeaders = "";
+    if (_readRequest(client, request, length, bodyStart) && _parseRequest(request, bodyStart, length))
+        _handleRequest();
+    else
+        send(400, "text/plain", "Bad Request");
+    client.stop();
+    _currentClient = WiFiClient();
+}
+
+// lee los headers (hasta la linea vacia) y el body (Content-Length)
+bool WebServer::_readRequest(WiFiClient &client, char *buffer, size_t &length, size_t &bodyStart)
+{
+    unsigned long start = millis();
+    size_t expected = 0;
+    length = 0;
+    bodyStart = 0;
+    while (bodyStart == 0 || length < expected)
+    {
+        if (length == HTTP_MAX_REQUEST || millis() - start > HTTP_MAX_DATA_WAIT)
+            return false;
+        int n = client.read((uint8_t *)buffer + length, HTTP_MAX_REQUEST - length);
+        if (n < 0)
+            return false;
+        if (n == 0)
+        {
+            delay(1);
+            continue;
+        }
+        length += n;
+        buffer[length] = 0;
+
+        if (bodyStart == 0)
+        {
+            char *end = strstr(buffer, "\r\n\r\n");
+            if (end == nullptr)
+                continue;
+            bodyStart = end + 4 - buffer;
+            const char *contentLength = strcasestr(buffer, "\r\nContent-Length:");
+            expected = bodyStart + (contentLength && contentLength < end ? strtoul(contentLength + 17, nullptr, 10) : 0);
+            if (expected > HTTP_MAX_REQUEST)
+                return false;
+        }
+    }
+    return true;
+}
+
+bool WebServer::_parseRequest(char *request, size_t headerLength, size_t length)
+{
+    // "GET /uri?args HTTP/1.1"
+    char *lineEnd = strstr(request, "\r\n");
+    char *space = strchr(request, ' ');
+    if (space == nullptr || space > lineEnd)
+        return false;
+    char *uriEnd = strchr(space + 1, ' ');
+    if (uriEnd == nullptr || uriEnd > lineEnd)
+        return false;
+
+    *space = 0;
+    const char *methods[] = {"", "GET", "HEAD", "POST", "PUT", "PATCH", "DELETE", "OPTIONS"};
+    _currentMethod = HTTP_ANY;
+    for (int i = 1; i < 8; i++)
+        if (strcmp(request, methods[i]) == 0)
+            _currentMethod = (HTTPMethod)i;
+
+    char *uri = space + 1;
+    *uriEnd = 0;
+    char *query = strchr(uri, '?');
+    if (query)
+        *query++ = 0;
+    _currentUri = urlDecode(uri, strlen(uri));
+    _currentArgCount = 0;
+    if (query)
+        _parseArguments(query, strlen(query));
+
+    // headers
+    _hostHeader = "";
+    for (int i = 0; i < _headerKeysCount; i++)
+        _currentHeaders[i].value = "";
+    bool form = false;
+    for (char *line = lineEnd + 2; line < request + headerLength - 2;)
+    {
+        char *end = strstr(line, "\r\n");
+        *end = 0;
+        char *colon = strchr(line, ':');
+        if (colon)
+        {
+            *colon = 0;
+            char *value = colon + 1;
+            while (*value == ' ')
+                value++;
+            if (strcasecmp(line, "Host") == 0)
+                _hostHeader = value;
+            else if (strcasecmp(line, "Content-Type") == 0)
+                form = strncmp(value, "application/x-www-form-urlencoded", 33) == 0;
+            for (int i = 0; i < _headerKeysCount; i++)
+                if (_currentHeaders[i].key.equalsIgnoreCase(line))
+                    _currentHeaders[i].value = value;
+        }
+        line = end + 2;
+    }
+
+    // body de un formulario: mas argumentos
+    if (form && length > headerLength)
+        _parseArguments(request + headerLength, length - headerLength);
+    return true;
+}
+
+void WebServer::_parseArguments(const char *data, size_t length)
+{
+    const char *end = data + length;
+    while (data < end && _currentArgCount < WEBSERVER_MAX_ARGS)
+    {
+        const char *amp = (const char *)memchr(data, '&', end - data);
+        const char *itemEnd = amp ? amp : end;
+        const char *equal = (const char *)memchr(data, '=', itemEnd - data);
+        if (itemEnd > data)
+        {
+            RequestArgument &arg = _currentArgs[_currentArgCount++];
+            arg.key = urlDecode(data, (equal ? equal : itemEnd) - data);
+            arg.value = equal ? urlDecode(equal + 1, itemEnd - equal - 1) : String();
+        }
+        data = itemEnd + 1;
+    }
+}
+
+void WebServer::_handleRequest()
+{
+    for (Route &route : _routes)
+    {
+        if ((route.method == HTTP_ANY || route.method == _currentMethod) && route.uri == _currentUri)
+        {
+            route.fn();
+            return;
+        }
+    }
+    if (_notFoundHandler)
+        _notFoundHandler();
+    else
+        send(404, "text/plain", String("Not found: ") + _currentUri);
+}
+
+String WebServer::arg(String name)
+{
+    for (int i = 0; i < _currentArgCount; i++)
+        if (_currentArgs[i].key == name)
+            return _currentArgs[i].value;
+    return String();
+}
+
+String WebServer::arg(int i)
+{
+    return i < _currentArgCount ? _currentArgs[i].value : String();
+}
+
+String WebServer::argName(int i)
+{
+    return i < _currentArgCount ? _currentArgs[i].key : String();
+}
+
+bool WebServer::hasArg(String name)
+{
+    for (int i = 0; i < _currentArgCount; i++)
+        if (_currentArgs[i].key == name)
+            return true;
+    return false;
+}
+
+void WebServer::collectHeaders(const char *headerKeys[], const size_t headerKeysCount)
+{
+    delete[] _currentHeaders;
+    _headerKeysCount = headerKeysCount;
+    _currentHeaders = new RequestArgument[_headerKeysCount];
+    for (int i = 0; i < _headerKeysCount; i++)
+        _currentHeaders[i].key = headerKeys[i];
+}
+
+String WebServer::header(String name)
+{
+    for (int i = 0; i < _headerKeysCount; i++)
+        if (_currentHeaders[i].key.equalsIgnoreCase(name))
+            return _currentHeaders[i].value;
+    return String();
+}
+
+bool WebServer::hasHeader(String name)
+{
+    return header(name).length() > 0;
+}
+
+void WebServer::sendHeader(const String &name, const String &value, bool first)
+{
+    String headerLine = name;
+    headerLine += ": ";
+    headerLine += value;
+    headerLine += "\r\n";
+    if (first)
+        _responseHeaders = headerLine + _responseHeaders;
+    else
+        _responseHeaders += headerLine;
+}
+
+void WebServer::_prepareHeader(String &response, int code, const char *content_type, size_t contentLength)
+{
+    response = "HTTP/1.1 ";
+    response += String(code);
+    response += " ";
+    response += responseCodeToString(code);
+    response += "\r\n";
+
+    sendHeader("Content-Type", content_type ? content_type : "text/html", true);
+    if (_contentLength == CONTENT_LENGTH_NOT_SET)
+        sendHeader("Content-Length", String((unsigned long)contentLength));
+    else if (_contentLength != CONTENT_LENGTH_UNKNOWN)
+        sendHeader("Content-Length", String((unsigned long)_contentLength));
+    else
+    {
+        _chunked = true;
+        sendHeader("Accept-Ranges", "none");
+        sendHeader("Transfer-Encoding", "chunked");
+    }
+    sendHeader("Connection", "close");
+
+    response += _responseHeaders;
+    response += "\r\n";
+    _responseHeaders = "";
+}
+
+void WebServer::send(int code, const char *content_type, const String &content)
+{
+    String header;
+    _prepareHeader(header, code, content_type, content.length());
+    _currentClient.write(header.c_str(), header.length());
+    if (content.length())
+        sendContent(content);
+}
+
+void WebServer::send_P(int code, PGM_P content_type, PGM_P content, size_t contentLength)
+{
+    String header;
+    _prepareHeader(header, code, content_type, contentLength);
+    _currentClient.write(header.c_str(), header.length());
+    sendContent_P(content, contentLength);
+}
+
+void WebServer::sendContent_P(PGM_P content, size_t size)
+{
+    if (_chunked)
+    {
+        char chunkSize[11];
+        snprintf(chunkSize, sizeof(chunkSize), "%zx\r\n", size);
+        _currentClient.write(chunkSize, strlen(chunkSize));
+    }
+    _currentClient.write(content, size);
+    if (_chunked)
+    {
+        _currentClient.write("\r\n", 2);
+        if (size == 0)
+            _chunked = false;
+    }
+}
@@ -0,0 +1,103 @@
+/*
+    WebServer.h (PC)
+    El WebServer del core del ESP32 (1.0.6) sobre un socket TCP en 127.0.0.1:hostPort(port).
+    Atiende un pedido por conexion y la cierra (Connection: close), de a uno, desde handleClient().
+
+    handleClient(client) atiende un pedido que ya esta en un WiFiClient (un MemClient en los tests).
+
+    JJTeam - 2021
+*/
+
+#pragma once
+#include <functional>
+#include <vector>
+#include "Arduino.h"
+#include "HTTP_Method.h"
+#include "WiFiClient.h"
+
+#define CONTENT_LENGTH_UNKNOWN ((size_t)-1)
+#define CONTENT_LENGTH_NOT_SET ((size_t)-2)
+
+#define HTTP_MAX_DATA_WAIT 5000 // ms que se espera el pedido
+#define HTTP_MAX_REQUEST 4096   // headers + body
+#define WEBSERVER_MAX_ARGS 32
+
+class WebServer
+{
+public:
+    typedef std::function<void(void)> THandlerFunction;
+
+    WebServer(int port = 80) : _port(port) {}
+    ~WebServer() { close(); }
+
+    void begin();
+    void begin(uint16_t port);
+    void handleClient();
+    void handleClient(WiFiClient &client); // solo en la PC
+    void close();
+    void stop() { close(); }
+
+    void on(const String &uri, THandlerFunction handler) { on(uri, HTTP_ANY, handler); }
+    void on(const String &uri, HTTPMethod method, THandlerFunction fn);
+    void onNotFound(THandlerFunction fn) { _notFoundHandler = fn; }
+
+    String uri() { return _currentUri; }
+    HTTPMethod method() { return _currentMethod; }
+    WiFiClient client() { return _currentClient; }
+
+    String arg(String name);
+    String arg(int i);
+    String argName(int i);
+    int args() { return _currentArgCount; }
+    bool hasArg(String name);
+    void collectHeaders(const char *headerKeys[], const size_t headerKeysCount);
+    String header(String name);
+    bool hasHeader(String name);
+    String hostHeader() { return _hostHeader; }
+
+    void send(int code, const char *content_type = NULL, const String &content = String(""));
+    void send(int code, char *content_type, const String &content) { send(code, (const char *)content_type, content); }
+    void send(int code, const String &content_type, const String &content) { send(code, content_type.c_str(), content); }
+    void send_P(int code, PGM_P content_type, PGM_P content, size_t contentLength);
+    void setContentLength(const size_t contentLength) { _contentLength = contentLength; }
+    void sendHeader(const String &name, const String &value, bool first = false);
+    void sendContent(const String &content) { sendContent_P(content.c_str(), content.length()); }
+    void sendContent_P(PGM_P content) { sendContent_P(content, strlen(content)); }
+    void sendContent_P(PGM_P content, size_t size);
+
+private:
+    struct Route
+    {
+        String uri;
+        HTTPMethod method;
+        THandlerFunction fn;
+    };
+    struct RequestArgument
+    {
+        String key;
+        String value;
+    };
+
+    int _port;
+    int _listenFd = -1;
+    std::vector<Route> _routes;
+    THandlerFunction _notFoundHandler;
+
+    WiFiClient _currentClient;
+    HTTPMethod _currentMethod = HTTP_ANY;
+    String _currentUri;
+    RequestArgument _currentArgs[WEBSERVER_MAX_ARGS];
+    int _currentArgCount = 0;
+    RequestArgument *_currentHeaders = nullptr; // los que se pidieron con collectHeaders()
+    int _headerKeysCount = 0;
+    String _hostHeader;
+    size_t _contentLength = CONTENT_LENGTH_NOT_SET;
+    bool _chunked = false;
+    String _responseHeaders;
+
+    bool _readRequest(WiFiClient &client, char *buffer, size_t &length, size_t &bodyStart);
+    bool _parseRequest(char *request, size_t headerLength, size_t length);
+    void _parseArguments(const char *data, size_t length);
+    void _handleRequest();
+    void _prepareHeader(String &response, int code, const char *content_type, size_t contentLength);
+};
@@ -0,0 +1,108 @@
+/*
+    WiFi.cpp (PC)
+    Ver WiFi.h
+
+    JJTeam - 2021
+*/
+
+#include "WiFi.h"
+
+WiFiClass WiFi;
+
+struct HostNetwork
+{
+    const char *ssid;
+    int32_t rssi;
+    wifi_auth_mode_t encryption;
+};
+
+static const HostNetwork NETWORKS[] = {
+    {"Casa", -48, WIFI_AUTH_WPA2_PSK},
+    {"Vecino", -81, WIFI_AUTH_WPA_WPA2_PSK},
+    {"Bar <Libre>", -67, WIFI_AUTH_OPEN},
+    {"", -70, WIFI_AUTH_WPA2_PSK}, // oculta
+    {"Casa", -75, WIFI_AUTH_WPA2_PSK}, // otro AP de la misma red
+};
+
+void WiFiClass::event(system_event_id_t id, uint8_t reason)
+{
+    system_event_info_t info = {};
+    info.disconnected.reason = reason;
+    if (callback)
+        callback(id, info);
+}
+
+bool WiFiClass::softAPConfig(IPAddress local_ip, IPAddress gateway, IPAddress subnet)
+{
+    apIP = local_ip;
+    return true;
+}
+
+bool WiFiClass::softAP(const char *ssid, const char *passphrase, int channel, int ssid_hidden, int max_connection)
+{
+    return ssid != nullptr && ssid[0] != 0;
+}
+
+wl_status_t WiFiClass::begin(const char *ssid, const char *passphrase)
+{
+    if (ssid == nullptr || ssid[0] == 0)
+        return staStatus = WL_CONNECT_FAILED;
+    staStatus = WL_CONNECTED;
+    staIP = IPAddress(127, 0, 0, 1);
+    event(SYSTEM_EVENT_STA_CONNECTED);
+    event(SYSTEM_EVENT_STA_GOT_IP);
+    return staStatus;
+}
+
+bool WiFiClass::disconnect(bool wifioff, bool eraseap)
+{
+    bool was = staStatus == WL_CONNECTED;
+    staStatus = WL_DISCONNECTED;
+    staIP = IPAddress();
+    if (was)
+        event(SYSTEM_EVENT_STA_DISCONNECTED, WIFI_REASON_ASSOC_LEAVE);
+    return true;
+}
+
+int16_t WiFiClass::scanNetworks(bool async, bool show_hidden, bool passive, uint32_t max_ms_per_chan)
+{
+    if (scanRunning)
+        return WIFI_SCAN_RUNNING;
+    scans++;
+    scanRunning = true;
+    scanStart = millis();
+    if (async)
+        return WIFI_SCAN_RUNNING;
+    delay(HOST_WIFI_SCAN_MS);
+    return scanComplete();
+}
+
+int16_t WiFiClass::scanComplete()
+{
+    if (scanRunning && millis() - scanStart >= HOST_WIFI_SCAN_MS)
+    {
+        scanRunning = false;
+        scanCount = sizeof(NETWORKS) / sizeof(NETWORKS[0]);
+    }
+    return scanRunning ? WIFI_SCAN_RUNNING : scanCount;
+}
+
+void WiFiClass::scanDelete()
+{
+    scanCount = WIFI_SCAN_FAILED;
+}
+
+String WiFiClass::SSID(uint8_t networkItem)
+{
+    return networkItem < scanCount ? String(NETWORKS[networkItem].ssid) : String();
+}
+
+int32_t WiFiClass::RSSI(uint8_t networkItem)
+{
+    return networkItem < scanCount ? NETWORKS[networkItem].rssi : 0;
+}
+
+wifi_auth_mode_t WiFiClass::encryptionType(uint8_t networkItem)
+{
+    return networkItem < scanCount ? NETWORKS[networkItem].encryption : WIFI_AUTH_OPEN;
+}
@@ -0,0 +1,116 @@
+/*
+    WiFi.h (PC)
+    No hay radio: el soft AP "levanta" siempre, begin() conecta enseguida (si hay SSID)
+    y el scan encuentra unas redes fijas despues de HOST_WIFI_SCAN_MS.
+    Los eventos son los del core 1.0.6 (SYSTEM_EVENT_*), y se llaman desde el mismo thread.
+
+    JJTeam - 2021
+*/
+
+#pragma once
+#include <functional>
+#include "Arduino.h"
+#include "WiFiClient.h"
+#include "WiFiUdp.h"
+
+// lo que tarda un scan (uno activo en los 13 canales tarda eso en el ESP32)
+#ifndef HOST_WIFI_SCAN_MS
+#define HOST_WIFI_SCAN_MS 1500
+#endif
+
+#define WIFI_SCAN_RUNNING (-1)
+#define WIFI_SCAN_FAILED (-2)
+
+typedef enum
+{
+    WL_NO_SHIELD = 255,
+    WL_IDLE_STATUS = 0,
+    WL_NO_SSID_AVAIL = 1,
+    WL_SCAN_COMPLETED = 2,
+    WL_CONNECTED = 3,
+    WL_CONNECT_FAILED = 4,
+    WL_CONNECTION_LOST = 5,
+    WL_DISCONNECTED = 6
+} wl_status_t;
+
+typedef enum
+{
+    WIFI_AUTH_OPEN = 0,
+    WIFI_AUTH_WEP,
+    WIFI_AUTH_WPA_PSK,
+    WIFI_AUTH_WPA2_PSK,
+    WIFI_AUTH_WPA_WPA2_PSK,
+    WIFI_AUTH_WPA2_ENTERPRISE,
+    WIFI_AUTH_MAX
+} wifi_auth_mode_t;
+
+typedef enum
+{
+    SYSTEM_EVENT_WIFI_READY = 0,
+    SYSTEM_EVENT_SCAN_DONE,
+    SYSTEM_EVENT_STA_START,
+    SYSTEM_EVENT_STA_STOP,
+    SYSTEM_EVENT_STA_CONNECTED,
+    SYSTEM_EVENT_STA_DISCONNECTED,
+    SYSTEM_EVENT_STA_AUTHMODE_CHANGE,
+    SYSTEM_EVENT_STA_GOT_IP,
+    SYSTEM_EVENT_STA_LOST_IP,
+    SYSTEM_EVENT_MAX = 40
+} system_event_id_t;
+
+typedef struct
+{
+    uint8_t ssid[32];
+    uint8_t ssid_len;
+    uint8_t bssid[6];
+    uint8_t reason;
+} system_event_sta_disconnected_t;
+
+typedef union
+{
+    system_event_sta_disconnected_t disconnected;
+} system_event_info_t;
+
+typedef system_event_id_t WiFiEvent_t;
+typedef system_event_info_t WiFiEventInfo_t;
+typedef std::function<void(system_event_id_t event, system_event_info_t info)> WiFiEventFuncCb;
+
+#define WIFI_REASON_ASSOC_LEAVE 8
+
+class WiFiClass
+{
+private:
+    IPAddress apIP;
+    IPAddress staIP;
+    wl_status_t staStatus = WL_IDLE_STATUS;
+    WiFiEventFuncCb callback;
+    bool scanRunning = false;
+    unsigned long scanStart = 0;
+    int16_t scanCount = WIFI_SCAN_FAILED;
+    uint32_t scans = 0;
+    void event(system_event_id_t id, uint8_t reason = 0);
+
+public:
+    bool softAPConfig(IPAddress local_ip, IPAddress gateway, IPAddress subnet);
+    bool softAP(const char *ssid, const char *passphrase = nullptr, int channel = 1, int ssid_hidden = 0, int max_connection = 4);
+    IPAddress softAPIP() { return apIP; }
+
+    wl_status_t begin(const char *ssid, const char *passphrase = nullptr);
+    bool disconnect(bool wifioff = false, bool eraseap = false);
+    bool isConnected() { return staStatus == WL_CONNECTED; }
+    bool setAutoReconnect(bool autoReconnect) { return true; }
+    uint8_t waitForConnectResult() { return staStatus; }
+    wl_status_t status() { return staStatus; }
+    IPAddress localIP() { return staIP; }
+    void onEvent(WiFiEventFuncCb cbEvent, system_event_id_t event = SYSTEM_EVENT_MAX) { callback = cbEvent; }
+
+    int16_t scanNetworks(bool async = false, bool show_hidden = false, bool passive = false, uint32_t max_ms_per_chan = 300);
+    int16_t scanComplete();
+    void scanDelete();
+    String SSID(uint8_t networkItem);
+    int32_t RSSI(uint8_t networkItem);
+    wifi_auth_mode_t encryptionType(uint8_t networkItem);
+    uint32_t scanCountTotal() const { return scans; } // solo en la PC: scans pedidos desde que arranco
+};
+
+extern WiFiClass WiFi;
@@ -0,0 +1,130 @@
+/*
+    WiFiClient.cpp (PC)
+    Ver WiFiClient.h
+
+    JJTeam - 2021
+*/
+
+#include "WiFiClient.h"
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// espera maxima para mandar (como WIFI_CLIENT_MAX_WRITE_RETRY * WIFI_CLIENT_SELECT_TIMEOUT_US)
+#define WIFI_CLIENT_WRITE_TIMEOUT 5
+
+class SocketClient : public WiFiClientImpl
+{
+private:
+    int fd;
+
+    IPAddress address(bool local)
+    {
+        sockaddr_in addr = {};
+        socklen_t length = sizeof(addr);
+        if (fd < 0 || (local ? getsockname(fd, (sockaddr *)&addr, &length) : getpeername(fd, (sockaddr *)&addr, &length)) != 0)
+            return IPAddress();
+        return IPAddress((uint32_t)addr.sin_addr.s_addr);
+    }
+
+public:
+    SocketClient(int fd) : fd(fd)
+    {
+        timeval timeout = {WIFI_CLIENT_WRITE_TIMEOUT, 0};
+        setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+    }
+    ~SocketClient() { stop(); }
+
+    size_t write(const uint8_t *buf, size_t size) override
+    {
+        size_t total = 0;
+        while (fd >= 0 && total < size)
+        {
+            ssize_t n = send(fd, buf + total, size - total, MSG_NOSIGNAL);
+            if (n <= 0)
+            {
+                if (n < 0 && errno == EINTR)
+                    continue;
+                stop();
+                break;
+            }
+            total += n;
+        }
+        return total;
+    }
+
+    int available() override
+    {
+        if (fd < 0)
+            return 0;
+        uint8_t buf[1460];
+        ssize_t n = recv(fd, buf, sizeof(buf), MSG_PEEK | MSG_DONTWAIT);
+        return n > 0 ? n : 0;
+    }
+
+    int read(uint8_t *buf, size_t size) override
+    {
+        if (fd < 0)
+            return -1;
+        ssize_t n = recv(fd, buf, size, MSG_DONTWAIT);
+        if (n == 0)
+            return -1; // el otro lado cerro
+        return n > 0 ? n : 0;
+    }
+
+    int peek() override
+    {
+        uint8_t c;
+        return fd >= 0 && recv(fd, &c, 1, MSG_PEEK | MSG_DONTWAIT) == 1 ? c : -1;
+    }
+
+    bool connected() override
+    {
+        if (fd < 0)
+            return false;
+        uint8_t c;
+        ssize_t n = recv(fd, &c, 1, MSG_PEEK | MSG_DONTWAIT);
+        return n > 0 || (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK));
+    }
+
+    void stop() override
+    {
+        if (fd >= 0)
+            close(fd);
+        fd = -1;
+    }
+
+    IPAddress localIP() override { return address(true); }
+    IPAddress remoteIP() override { return address(false); }
+    uint16_t remotePort() override
+    {
+        sockaddr_in addr = {};
+        socklen_t length = sizeof(addr);
+        return fd >= 0 && getpeername(fd, (sockaddr *)&addr, &length) == 0 ? ntohs(addr.sin_port) : 0;
+    }
+};
+
+WiFiClient::WiFiClient(int fd) : impl(std::make_shared<SocketClient>(fd))
+{
+}
+
+int WiFiClient::connect(IPAddress ip, uint16_t port)
+{
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0)
+        return 0;
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(hostPort(port));
+    addr.sin_addr.s_addr = (uint32_t)ip;
+    if (::connect(fd, (sockaddr *)&addr, sizeof(addr)) != 0)
+    {
+        close(fd);
+        return 0;
+    }
+    impl = std::make_shared<SocketClient>(fd);
+    return 1;
+}
@@ -0,0 +1,63 @@
+/*
+    WiFiClient.h (PC)
+    Una conexion TCP. Las copias comparten la conexion (como en el ESP32).
+    Puede ser un socket de verdad o un MemClient (ver MemClient.h).
+
+    JJTeam - 2021
+*/
+
+#pragma once
+#include <memory>
+#include "Arduino.h"
+
+class WiFiClientImpl
+{
+public:
+    virtual ~WiFiClientImpl() {}
+    virtual size_t write(const uint8_t *buf, size_t size) = 0;
+    virtual int available() = 0;
+    virtual int read(uint8_t *buf, size_t size) = 0; // -1 si se cerro
+    virtual int peek() = 0;
+    virtual bool connected() = 0;
+    virtual void stop() = 0;
+    virtual IPAddress localIP() = 0;
+    virtual IPAddress remoteIP() = 0;
+    virtual uint16_t remotePort() = 0;
+};
+
+class WiFiClient : public Stream
+{
+protected:
+    std::shared_ptr<WiFiClientImpl> impl;
+
+public:
+    WiFiClient() {}
+    WiFiClient(std::shared_ptr<WiFiClientImpl> impl) : impl(impl) {}
+    explicit WiFiClient(int fd); // toma un socket ya conectado
+
+    int connect(IPAddress ip, uint16_t port); // a 127.0.0.1:hostPort(port) si ip es la del equipo
+
+    size_t write(uint8_t c) override { return write(&c, 1); }
+    size_t write(const uint8_t *buf, size_t size) override { return impl ? impl->write(buf, size) : 0; }
+    using Print::write;
+    int available() override { return impl ? impl->available() : 0; }
+    int read() override
+    {
+        uint8_t c;
+        return read(&c, 1) == 1 ? c : -1;
+    }
+    int read(uint8_t *buf, size_t size) { return impl ? impl->read(buf, size) : -1; }
+    int peek() override { return impl ? impl->peek() : -1; }
+    void flush() override {}
+    void stop()
+    {
+        if (impl)
+            impl->stop();
+    }
+    uint8_t connected() { return impl && impl->connected(); }
+    operator bool() { return connected(); }
+
+    IPAddress localIP() { return impl ? impl->localIP() : IPAddress(); }
+    IPAddress remoteIP() { return impl ? impl->remoteIP() : IPAddress(); }
+    uint16_t remotePort() { return impl ? impl->remotePort() : 0; }
+};
@@ -0,0 +1,103 @@
+/*
+    WiFiUdp.cpp (PC)
+    Ver WiFiUdp.h
+
+    JJTeam - 2021
+*/
+
+#include "WiFiUdp.h"
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+uint8_t WiFiUDP::begin(uint16_t port)
+{
+    stop();
+    fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0)
+        return 0;
+
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(hostPort(port));
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (bind(fd, (sockaddr *)&addr, sizeof(addr)) != 0)
+    {
+        perror("WiFiUDP::begin");
+        stop();
+        return 0;
+    }
+    return 1;
+}
+
+void WiFiUDP::stop()
+{
+    if (fd >= 0)
+        close(fd);
+    fd = -1;
+    rxLength = rxPos = 0;
+}
+
+int WiFiUDP::beginPacket(IPAddress ip, uint16_t port)
+{
+    txAddress = ip;
+    txPort = port;
+    txLength = 0;
+    return 1;
+}
+
+size_t WiFiUDP::write(const uint8_t *buffer, size_t size)
+{
+    size_t n = std::min(size, sizeof(tx) - txLength);
+    memcpy(tx + txLength, buffer, n);
+    txLength += n;
+    return n;
+}
+
+int WiFiUDP::endPacket()
+{
+    if (fd < 0)
+        return 0;
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(txPort);
+    addr.sin_addr.s_addr = (uint32_t)txAddress; // ya esta en orden de red
+    ssize_t sent = sendto(fd, tx, txLength, 0, (sockaddr *)&addr, sizeof(addr));
+    txLength = 0;
+    return sent >= 0 ? 1 : 0;
+}
+
+int WiFiUDP::parsePacket()
+{
+    rxLength = rxPos = 0;
+    if (fd < 0)
+        return 0;
+    sockaddr_in addr = {};
+    socklen_t addrLength = sizeof(addr);
+    ssize_t n = recvfrom(fd, rx, sizeof(rx), 0, (sockaddr *)&addr, &addrLength);
+    if (n <= 0)
+        return 0;
+    rxLength = n;
+    remoteAddress = IPAddress((uint32_t)addr.sin_addr.s_addr);
+    remotePortNumber = ntohs(addr.sin_port);
+    return n;
+}
+
+int WiFiUDP::read()
+{
+    return rxPos < rxLength ? rx[rxPos++] : -1;
+}
+
+int WiFiUDP::read(unsigned char *buffer, size_t len)
+{
+    size_t n = std::min(len, rxLength - rxPos);
+    memcpy(buffer, rx + rxPos, n);
+    rxPos += n;
+    return n;
+}
@@ -0,0 +1,50 @@
+/*
+    WiFiUdp.h (PC)
+    UDP con un socket de verdad, escuchando en 127.0.0.1:hostPort(port).
+    Los buffers son fijos: no se pide memoria por paquete (como en el ESP32 despues del begin()).
+
+    JJTeam - 2021
+*/
+
+#pragma once
+#include "Udp.h"
+
+#define WIFI_UDP_BUFFER 1460
+
+class WiFiUDP : public UDP
+{
+private:
+    int fd = -1;
+    uint8_t rx[WIFI_UDP_BUFFER];
+    size_t rxLength = 0;
+    size_t rxPos = 0;
+    uint8_t tx[WIFI_UDP_BUFFER];
+    size_t txLength = 0;
+    IPAddress remoteAddress;
+    uint16_t remotePortNumber = 0;
+    IPAddress txAddress;
+    uint16_t txPort = 0;
+
+public:
+    ~WiFiUDP() { stop(); }
+
+    uint8_t begin(uint16_t port) override;
+    void stop() override;
+
+    int beginPacket(IPAddress ip, uint16_t port) override;
+    int endPacket() override;
+    size_t write(uint8_t c) override { return write(&c, 1); }
+    size_t write(const uint8_t *buffer, size_t size) override;
+    using Print::write;
+
+    int parsePacket() override;
+    int available() override { return rxLength - rxPos; }
+    int read() override;
+    int read(unsigned char *buffer, size_t len) override;
+    int read(char *buffer, size_t len) override { return read((unsigned char *)buffer, len); }
+    int peek() override { return rxPos < rxLength ? rx[rxPos] : -1; }
+    void flush() override { rxPos = rxLength; }
+
+    IPAddress remoteIP() override { return remoteAddress; }
+    uint16_t remotePort() override { return remotePortNumber; }
+};
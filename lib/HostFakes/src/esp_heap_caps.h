@@ -0,0 +1,26 @@
+/*
+    esp_heap_caps.h (PC)
+    El heap de la PC no tiene limite: se simula uno de HOST_HEAP_SIZE bytes
+    al que se le resta lo que malloc tiene en uso (sin fragmentacion: el bloque mas grande es todo lo libre).
+
+    JJTeam - 2021
+*/
+
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef HOST_HEAP_SIZE
+#define HOST_HEAP_SIZE (256 * 1024)
+#endif
+
+#define MALLOC_CAP_EXEC (1 << 0)
+#define MALLOC_CAP_32BIT (1 << 1)
+#define MALLOC_CAP_8BIT (1 << 2)
+#define MALLOC_CAP_DMA (1 << 3)
+#define MALLOC_CAP_INTERNAL (1 << 11)
+#define MALLOC_CAP_DEFAULT (1 << 12)
+
+size_t heap_caps_get_free_size(uint32_t caps);
+size_t heap_caps_get_minimum_free_size(uint32_t caps);
+size_t heap_caps_get_largest_free_block(uint32_t caps);
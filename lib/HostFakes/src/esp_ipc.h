@@ -0,0 +1,15 @@
+/*
+    esp_ipc.h (PC)
+    Hay una sola CPU: la funcion se llama directamente.
+
+    JJTeam - 2021
+*/
+
+#pragma once
+#include <stdint.h>
+#include "esp_err.h"
+
+typedef void (*esp_ipc_func_t)(void *arg);
+
+esp_err_t esp_ipc_call(uint32_t cpu_id, esp_ipc_func_t func, void *arg);
+esp_err_t esp_ipc_call_blocking(uint32_t cpu_id, esp_ipc_func_t func, void *arg);
@@ -0,0 +1,34 @@
+/*
+    esp_system.h (PC)
+    La MAC es siempre la misma (el numero de serie tambien), y esp_restart() termina el programa.
+
+    JJTeam - 2021
+*/
+
+#pragma once
+#include <stdint.h>
+#include "esp_err.h"
+
+typedef enum
+{
+    ESP_RST_UNKNOWN,
+    ESP_RST_POWERON,
+    ESP_RST_EXT,
+    ESP_RST_SW,
+    ESP_RST_PANIC,
+    ESP_RST_INT_WDT,
+    ESP_RST_TASK_WDT,
+    ESP_RST_WDT,
+    ESP_RST_DEEPSLEEP,
+    ESP_RST_BROWNOUT,
+    ESP_RST_SDIO,
+} esp_reset_reason_t;
+
+typedef void (*shutdown_handler_t)(void);
+
+esp_reset_reason_t esp_reset_reason();
+esp_err_t esp_efuse_mac_get_default(uint8_t *mac);
+esp_err_t esp_register_shutdown_handler(shutdown_handler_t handler);
+const char *esp_get_idf_version();
+uint32_t esp_get_free_heap_size();
+void esp_restart() __attribute__((noreturn));
@@ -0,0 +1,11 @@
+/*
+    esp_timer.h (PC)
+    Ver Arduino.h
+
+    JJTeam - 2021
+*/
+
+#pragma once
+#include <stdint.h>
+
+int64_t esp_timer_get_time(); // us desde que arranco el programa
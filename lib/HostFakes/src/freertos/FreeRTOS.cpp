@@ -0,0 +1,177 @@
+/*
+    freertos/FreeRTOS.cpp (PC)
+    Ver FreeRTOS.h, task.h y semphr.h
+
+    JJTeam - 2021
+*/
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+#include <condition_variable>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <string.h>
+
+struct HostTask
+{
+    char name[configMAX_TASK_NAME_LEN];
+    TaskFunction_t code;
+    void *param;
+    std::mutex mutex;
+    std::condition_variable notified;
+    uint32_t notifications = 0;
+};
+
+struct HostSemaphore
+{
+    std::timed_mutex mutex;
+};
+
+// threads que no se crearon con xTaskCreate (el principal): se les da una entrada de aca,
+// sin pedir memoria (xTaskGetCurrentTaskHandle() se llama desde los hooks de malloc de MemStats)
+#define HOST_ADOPTED_TASKS 16
+
+static pthread_mutex_t interruptMask = PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP;
+static thread_local HostTask *currentTask = nullptr;
+static HostTask adopted[HOST_ADOPTED_TASKS];
+static int adoptedCount = 0;
+
+uint32_t portSET_INTERRUPT_MASK_FROM_ISR()
+{
+    pthread_mutex_lock(&interruptMask);
+    return 0;
+}
+
+void portCLEAR_INTERRUPT_MASK_FROM_ISR(uint32_t state)
+{
+    pthread_mutex_unlock(&interruptMask);
+}
+
+static void setName(HostTask *task, const char *name)
+{
+    strncpy(task->name, name, sizeof(task->name) - 1);
+    task->name[sizeof(task->name) - 1] = 0;
+}
+
+static void *runTask(void *arg)
+{
+    currentTask = (HostTask *)arg;
+    currentTask->code(currentTask->param);
+    return nullptr;
+}
+
+// los HostTask no se liberan: el handle de una tarea que termino no se reusa para otra
+BaseType_t xTaskCreate(TaskFunction_t code, const char *name, uint32_t stackDepth, void *param,
+                       UBaseType_t priority, TaskHandle_t *created)
+{
+    HostTask *task = new HostTask();
+    setName(task, name);
+    task->code = code;
+    task->param = param;
+    if (created)
+        *created = task;
+
+    pthread_t thread;
+    if (pthread_create(&thread, nullptr, runTask, task) != 0)
+        return pdFAIL;
+    pthread_detach(thread);
+    return pdPASS;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t code, const char *name, uint32_t stackDepth, void *param,
+                                   UBaseType_t priority, TaskHandle_t *created, BaseType_t core)
+{
+    return xTaskCreate(code, name, stackDepth, param, priority, created);
+}
+
+void vTaskDelete(TaskHandle_t task)
+{
+    if (task == nullptr || task == currentTask)
+        pthread_exit(nullptr);
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(ticks * portTICK_PERIOD_MS));
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle()
+{
+    if (currentTask == nullptr)
+    {
+        int index = __atomic_fetch_add(&adoptedCount, 1, __ATOMIC_RELAXED);
+        currentTask = &adopted[index < HOST_ADOPTED_TASKS ? index : HOST_ADOPTED_TASKS - 1];
+        setName(currentTask, index == 0 ? "loopTask" : "thread");
+    }
+    return currentTask;
+}
+
+char *pcTaskGetTaskName(TaskHandle_t task)
+{
+    return (task ? task : xTaskGetCurrentTaskHandle())->name;
+}
+
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task)
+{
+    return 0;
+}
+
+BaseType_t xTaskGetSchedulerState()
+{
+    return taskSCHEDULER_RUNNING;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clearCountOnExit, TickType_t ticksToWait)
+{
+    HostTask *task = xTaskGetCurrentTaskHandle();
+    std::unique_lock<std::mutex> lock(task->mutex);
+    auto ready = [task]
+    { return task->notifications > 0; };
+    if (ticksToWait == portMAX_DELAY)
+        task->notified.wait(lock, ready);
+    else
+        task->notified.wait_for(lock, std::chrono::milliseconds(ticksToWait * portTICK_PERIOD_MS), ready);
+
+    uint32_t count = task->notifications;
+    if (count > 0)
+        task->notifications = clearCountOnExit ? 0 : count - 1;
+    return count;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task)
+{
+    {
+        std::lock_guard<std::mutex> lock(task->mutex);
+        task->notifications++;
+    }
+    task->notified.notify_one();
+    return pdPASS;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex()
+{
+    return new HostSemaphore();
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticksToWait)
+{
+    if (ticksToWait == portMAX_DELAY)
+    {
+        semaphore->mutex.lock();
+        return pdTRUE;
+    }
+    return semaphore->mutex.try_lock_for(std::chrono::milliseconds(ticksToWait * portTICK_PERIOD_MS)) ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore)
+{
+    semaphore->mutex.unlock();
+    return pdTRUE;
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t semaphore)
+{
+    delete semaphore;
+}
@@ -0,0 +1,48 @@
+/*
+    freertos/FreeRTOS.h (PC)
+    Lo que usa el proyecto de FreeRTOS, con pthreads.
+    Las secciones criticas son un mutex recursivo (no se apagan las interrupciones, no hay),
+    y hay una sola CPU: xPortGetCoreID() siempre es 0.
+
+    JJTeam - 2021
+*/
+
+#pragma once
+#include <stdint.h>
+#include <pthread.h>
+
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdFALSE 0
+#define pdTRUE 1
+#define pdFAIL 0
+#define pdPASS 1
+
+#define portMAX_DELAY ((TickType_t)0xffffffffUL)
+#define configTICK_RATE_HZ 1000
+#define portTICK_PERIOD_MS (1000 / configTICK_RATE_HZ)
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms) * configTICK_RATE_HZ / 1000)
+#define configMAX_TASK_NAME_LEN 16
+#define tskIDLE_PRIORITY 0
+#define tskNO_AFFINITY 0x7FFFFFFF
+#define portNUM_PROCESSORS 1
+
+struct portMUX_TYPE
+{
+    pthread_mutex_t mutex;
+};
+
+#define portMUX_INITIALIZER_UNLOCKED {PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP}
+
+inline void portENTER_CRITICAL(portMUX_TYPE *mux) { pthread_mutex_lock(&mux->mutex); }
+inline void portEXIT_CRITICAL(portMUX_TYPE *mux) { pthread_mutex_unlock(&mux->mutex); }
+#define portENTER_CRITICAL_ISR portENTER_CRITICAL
+#define portEXIT_CRITICAL_ISR portEXIT_CRITICAL
+
+// "sin interrupciones": un mutex recursivo global
+uint32_t portSET_INTERRUPT_MASK_FROM_ISR();
+void portCLEAR_INTERRUPT_MASK_FROM_ISR(uint32_t state);
+
+inline BaseType_t xPortGetCoreID() { return 0; }
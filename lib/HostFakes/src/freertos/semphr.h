@@ -0,0 +1,16 @@
+/*
+    freertos/semphr.h (PC)
+    Solo mutex (no recursivos, como los de xSemaphoreCreateMutex()).
+
+    JJTeam - 2021
+*/
+
+#pragma once
+#include "FreeRTOS.h"
+
+typedef struct HostSemaphore *SemaphoreHandle_t;
+
+SemaphoreHandle_t xSemaphoreCreateMutex();
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticksToWait);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore);
+void vSemaphoreDelete(SemaphoreHandle_t semaphore);
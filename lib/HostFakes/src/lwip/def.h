@@ -0,0 +1,13 @@
+/*
+    lwip/def.h (PC)
+
+    JJTeam - 2021
+*/
+
+#pragma once
+#include <arpa/inet.h>
+
+#define lwip_htons(x) htons(x)
+#define lwip_ntohs(x) ntohs(x)
+#define lwip_htonl(x) htonl(x)
+#define lwip_ntohl(x) ntohl(x)
@@ -0,0 +1,11 @@
+/*
+    soc/soc.h (PC)
+    Solo el rango de la flash mapeada (no existe en la PC, nada cae adentro).
+
+    JJTeam - 2021
+*/
+
+#pragma once
+
+#define SOC_DROM_LOW 0x3F400000
+#define SOC_DROM_HIGH 0x3F800000
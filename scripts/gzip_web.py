@@ -0,0 +1,46 @@
+"""
+gzip_web.py
+Script de PlatformIO (extra_scripts = pre:scripts/gzip_web.py).
+
+Antes de compilar comprime con gzip los archivos de web/ que se sirven
+comprimidos (web/style.css => web/style.css.gz). Con board_build.embed_files
+se linkean los dos: el .gz va a los navegadores que aceptan gzip y el
+original al resto. Ver include/WebResources.h
+
+En el env:native no hay embed_files: los archivos se linkean con .incbin
+(lib/HostFakes/src/web_resources.S), y aca se agrega la carpeta del
+proyecto al path del assembler para que los encuentre.
+
+El .gz solo se regenera si el original cambio, y sale siempre igual para
+el mismo contenido (sin fecha ni nombre adentro), asi el ETag no cambia.
+
+JJTeam - 2021
+"""
+
+import gzip
+import os
+
+Import("env")  # noqa: F821 (lo define PlatformIO)
+
+# archivos a comprimir (las imagenes ya vienen comprimidas)
+GZIP_FILES = ["web/style.css"]
+
+
+def gzip_file(src):
+    dst = src + ".gz"
+    if os.path.exists(dst) and os.path.getmtime(dst) >= os.path.getmtime(src):
+        return
+    with open(src, "rb") as f:
+        data = f.read()
+    with open(dst, "wb") as f:
+        with gzip.GzipFile(filename="", mode="wb", fileobj=f, compresslevel=9, mtime=0) as gz:
+            gz.write(data)
+    print("gzip_web: %s (%d => %d bytes)" % (dst, len(data), os.path.getsize(dst)))
+
+
+project_dir = env.subst("$PROJECT_DIR")  # noqa: F821
+for name in GZIP_FILES:
+    gzip_file(os.path.join(project_dir, name))
+
+if env.subst("$PIOPLATFORM") == "native":  # noqa: F821
+    env.Append(ASPPFLAGS=["-Wa,-I" + project_dir], CCFLAGS=["-Wa,-I" + project_dir])  # noqa: F821
@@ -0,0 +1,47 @@
+#include "DNSRateLimiter.h"
+
+void DNSRateLimiter::clear()
+{
+  memset(_buckets, 0, sizeof(_buckets));
+}
+
+bool DNSRateLimiter::take(uint32_t ip, uint32_t now,
+                          uint16_t rate, uint16_t burst)
+{
+  DNSBucket &bucket = find(ip, now, rate, burst);
+  uint64_t tokens = bucket.tokens + (uint64_t)(now - bucket.lastRefill) * rate;
+  bucket.tokens = min(tokens, (uint64_t)burst * 1000);
+  bucket.lastRefill = now;
+  if (bucket.tokens < 1000)
+    return false;
+  bucket.tokens -= 1000;
+  return true;
+}
+
+// the client's bucket, or a new (full) one in place of a bucket that refilled
+// completely or else of the least recently used one
+DNSBucket &DNSRateLimiter::find(uint32_t ip, uint32_t now,
+                                uint16_t rate, uint16_t burst)
+{
+  DNSBucket *victim = nullptr;
+  DNSBucket *oldest = &_buckets[0];
+  for (DNSBucket &bucket : _buckets)
+  {
+    if (bucket.ip == ip)
+      return bucket;
+    if (victim != nullptr)
+      continue;
+    uint32_t idle = now - bucket.lastRefill;
+    if (bucket.ip == 0
+        || bucket.tokens + (uint64_t)idle * rate >= (uint64_t)burst * 1000)
+      victim = &bucket;
+    else if (idle > now - oldest->lastRefill)
+      oldest = &bucket;
+  }
+  if (victim == nullptr)
+    victim = oldest;
+  victim->ip = ip;
+  victim->tokens = UINT32_MAX; // full, take() caps it to the burst
+  victim->lastRefill = now;
+  return *victim;
+}
@@ -0,0 +1,37 @@
+#ifndef DNSRateLimiter_h
+#define DNSRateLimiter_h
+#include <Arduino.h>
+
+// Per client IP token buckets for the DNS server. The table is its own, not
+// the telemetry's: clearing the statistics doesn't refill anyone's bucket.
+// When it's full a new client takes the slot of one whose bucket is already
+// full again (dropping it changes nothing), and only if there is none the
+// least recently seen one. So only a flood from more than DNS_RATE_CLIENTS
+// addresses at once can cycle the entries to dodge the limit; the soft AP
+// accepts 10 stations at most.
+
+#define DNS_RATE_CLIENTS 32
+
+struct DNSBucket
+{
+  uint32_t ip;         // 0 if the slot is empty
+  uint32_t tokens;     // in 1/1000 of a query
+  uint32_t lastRefill; // millis()
+};
+
+class DNSRateLimiter
+{
+public:
+  DNSRateLimiter() { clear(); }
+  void clear();
+
+  // takes a token from ip's bucket (rate tokens/s, up to burst).
+  // Returns false if it is empty and the query must be refused.
+  bool take(uint32_t ip, uint32_t now, uint16_t rate, uint16_t burst);
+
+private:
+  DNSBucket _buckets[DNS_RATE_CLIENTS];
+
+  DNSBucket &find(uint32_t ip, uint32_t now, uint16_t rate, uint16_t burst);
+};
+#endif
@@ -1,7 +1,8 @@
 #include "DNSServer.h"
 #include <lwip/def.h>
 #include <Arduino.h>
-#include <memory>
+#include "PerfStats.h"
+#include "Trace.h"
 
 #ifdef DEBUG_ESP_PORT
 #define DEBUG_OUTPUT DEBUG_ESP_PORT
@@ -11,26 +12,211 @@
 
 #define DNS_HEADER_SIZE sizeof(DNSHeader)
 
-DNSServer::DNSServer()
+#define FNV_OFFSET 2166136261u
+#define FNV_PRIME 16777619u
+
+static inline uint8_t *writeNBOShort(uint8_t *dst, uint16_t value)
+{
+  dst[0] = value >> 8;
+  dst[1] = value & 0xff;
+  return dst + 2;
+}
+
+DNSServer::DNSServer() : _udp(_ownUdp)
+{
+  init();
+}
+
+DNSServer::DNSServer(UDP &udp) : _udp(udp)
+{
+  init();
+}
+
+void DNSServer::init()
 {
   _ttl = lwip_htonl(60);
   _errorReplyCode = DNSReplyCode::NonExistentDomain;
+  buildSOA();
+  _batchBudget = DNS_DEFAULT_BATCH;
+  _rateLimit = DNS_DEFAULT_RATE;
+  _rateBurst = DNS_DEFAULT_BURST;
+  _stats = {};
+  _edns = false;
+  _ednsRcode = 0;
+  _task = nullptr;
+  _stopTask = false;
+  clearZones();
 }
 
 bool DNSServer::start(const uint16_t &port, const String &domainName,
                      const IPAddress &resolvedIP)
 {
   _port = port;
-  
-  _domainName = domainName;
-  _resolvedIP[0] = resolvedIP[0];
-  _resolvedIP[1] = resolvedIP[1];
-  _resolvedIP[2] = resolvedIP[2];
-  _resolvedIP[3] = resolvedIP[3];
-  downcaseAndRemoveWwwPrefix(_domainName);
+
+  clearZones();
+  if (!domainName.isEmpty())
+    addZone(domainName, resolvedIP);
   return _udp.begin(_port) == 1;
 }
 
+void DNSServer::clearZones()
+{
+  _zoneCount = 0;
+  _defaultZone = -1;
+  memset(_zoneSlots, -1, sizeof(_zoneSlots));
+}
+
+// FNV-1a over the wire-format name, walked from the end so the hash of
+// every label suffix is computed in the same single pass (see lookup())
+static uint32_t hashName(const uint8_t *name, size_t length)
+{
+  uint32_t hash = FNV_OFFSET;
+  while (length > 0)
+    hash = (hash ^ name[--length]) * FNV_PRIME;
+  return hash;
+}
+
+bool DNSServer::addZone(const String &name, const IPAddress &ip, uint32_t ttl)
+{
+  if (_zoneCount == DNS_MAX_ZONES)
+    return false;
+
+  DNSZone &zone = _zones[_zoneCount];
+  String domainName = name;
+  zone.wildcard = false;
+  if (domainName == "*")
+  {
+    zone.nameLength = 0;
+  }
+  else
+  {
+    if (domainName.startsWith("*."))
+    {
+      zone.wildcard = true;
+      domainName.remove(0, 2);
+    }
+    if (domainName.endsWith("."))
+      domainName.remove(domainName.length() - 1);
+    if (zone.wildcard)
+      domainName.toLowerCase();
+    else
+      downcaseAndRemoveWwwPrefix(domainName);
+
+    // "foo.local" => 3 'f' 'o' 'o' 5 'l' 'o' 'c' 'a' 'l'
+    if (domainName.isEmpty() || domainName.length() + 1 > DNS_MAX_ZONE_NAME)
+      return false;
+    size_t labelStart = 0;
+    zone.name[0] = 0;
+    for (size_t i = 0; i < domainName.length(); i++)
+    {
+      char c = domainName[i];
+      if (c == '.')
+      {
+        if (zone.name[labelStart] == 0)
+          return false; // empty label
+        labelStart = i + 1;
+        zone.name[labelStart] = 0;
+        continue;
+      }
+      if (zone.name[labelStart] == 63)
+        return false;
+      zone.name[labelStart]++;
+      zone.name[i + 1] = c;
+    }
+    if (zone.name[labelStart] == 0)
+      return false;
+    zone.nameLength = domainName.length() + 1;
+  }
+
+  zone.hash = hashName(zone.name, zone.nameLength);
+  zone.ip[0] = ip[0];
+  zone.ip[1] = ip[1];
+  zone.ip[2] = ip[2];
+  zone.ip[3] = ip[3];
+  zone.defaultTTL = ttl == 0;
+  zone.ttl = ttl == 0 ? _ttl : lwip_htonl(ttl);
+  buildAnswer(zone);
+
+  if (zone.nameLength == 0)
+  {
+    _defaultZone = _zoneCount++;
+    return true;
+  }
+
+  // open addressing, linear probing
+  uint8_t slot = zone.hash & (DNS_ZONE_SLOTS - 1);
+  while (_zoneSlots[slot] >= 0)
+    slot = (slot + 1) & (DNS_ZONE_SLOTS - 1);
+  _zoneSlots[slot] = _zoneCount++;
+  return true;
+}
+
+const DNSZone *DNSServer::findZone(uint32_t hash, bool wildcard,
+                                   const uint8_t *name, size_t length) const
+{
+  uint8_t slot = hash & (DNS_ZONE_SLOTS - 1);
+  while (_zoneSlots[slot] >= 0)
+  {
+    const DNSZone &zone = _zones[_zoneSlots[slot]];
+    if (zone.hash == hash && zone.wildcard == wildcard &&
+        zone.nameLength == length && memcmp(zone.name, name, length) == 0)
+      return &zone;
+    slot = (slot + 1) & (DNS_ZONE_SLOTS - 1);
+  }
+  return nullptr;
+}
+
+// Finds the zone for the query name in O(name length): one pass to
+// lowercase it and find the labels, one backwards pass hashing every
+// label suffix, then a hash probe per label.
+const DNSZone *DNSServer::lookup(const uint8_t *query) const
+{
+  uint8_t name[MAX_DNSNAME_LENGTH + 2];
+  uint8_t labels[MAX_DNSNAME_LENGTH / 2 + 1]; // offset of each label
+  uint32_t hashes[MAX_DNSNAME_LENGTH / 2 + 1];
+  size_t length = 0, count = 0;
+
+  // the request was already checked to be well formed
+  while (query[length] != 0)
+  {
+    size_t labelLength = query[length];
+    if (length + labelLength + 1 > sizeof(name) - 1 || count == sizeof(labels))
+      return _defaultZone >= 0 ? &_zones[_defaultZone] : nullptr;
+    labels[count++] = length;
+    name[length] = labelLength;
+    for (size_t i = 1; i <= labelLength; i++)
+      name[length + i] = tolower(query[length + i]);
+    length += labelLength + 1;
+  }
+
+  uint32_t hash = FNV_OFFSET;
+  size_t pos = length;
+  for (size_t label = count; label-- > 0;)
+  {
+    while (pos > labels[label])
+      hash = (hash ^ name[--pos]) * FNV_PRIME;
+    hashes[label] = hash;
+  }
+
+  const DNSZone *zone;
+  if (count > 0)
+  {
+    // exact name, or the name without a leading "www"
+    if ((zone = findZone(hashes[0], false, name, length)))
+      return zone;
+    if (count > 1 && name[0] == 3 && memcmp(name + 1, "www", 3) == 0 &&
+        (zone = findZone(hashes[1], false, name + labels[1], length - labels[1])))
+      return zone;
+
+    // the most specific wildcard
+    for (size_t label = 1; label < count; label++)
+      if ((zone = findZone(hashes[label], true, name + labels[label], length - labels[label])))
+        return zone;
+  }
+
+  return _defaultZone >= 0 ? &_zones[_defaultZone] : nullptr;
+}
+
 void DNSServer::setErrorReplyCode(const DNSReplyCode &replyCode)
 {
   _errorReplyCode = replyCode;
@@ -39,13 +225,133 @@ void DNSServer::setErrorReplyCode(const DNSReplyCode &replyCode)
 void DNSServer::setTTL(const uint32_t &ttl)
 {
   _ttl = lwip_htonl(ttl);
+  for (uint8_t i = 0; i < _zoneCount; i++)
+    if (_zones[i].defaultTTL)
+    {
+      _zones[i].ttl = _ttl;
+      buildAnswer(_zones[i]);
+    }
+  buildSOA();
+}
+
+// The answer section only depends on the zone (the name is a pointer to
+// the query, which always starts right after the header), so it is built
+// once here and every reply just copies it.
+void DNSServer::buildAnswer(DNSZone &zone)
+{
+  uint8_t *answer = zone.answer;
+
+  // Rather than restate the name here, we use a pointer to the name contained
+  // in the query section. Pointers have the top two bits set.
+  answer = writeNBOShort(answer, 0xC000 | DNS_HEADER_SIZE);
+
+  // Answer is type A (an IPv4 address)
+  answer = writeNBOShort(answer, DNS_QTYPE_A);
+
+  // Answer is in the Internet Class
+  answer = writeNBOShort(answer, DNS_QCLASS_IN);
+
+  // Output TTL (already NBO)
+  memcpy(answer, &zone.ttl, 4);
+  answer += 4;
+
+  // Length of RData is 4 bytes (because, in this case, RData is IPv4)
+  answer = writeNBOShort(answer, sizeof(zone.ip));
+  memcpy(answer, zone.ip, sizeof(zone.ip));
+}
+
+// SOA for the authority section of NODATA replies. Without it resolvers
+// don't cache the negative answer (RFC 2308) and keep asking for AAAA.
+// Its TTL and MINIMUM are the server TTL.
+void DNSServer::buildSOA()
+{
+  uint8_t *soa = _soa;
+
+  soa = writeNBOShort(soa, 0xC000 | DNS_HEADER_SIZE);
+  soa = writeNBOShort(soa, DNS_QTYPE_SOA);
+  soa = writeNBOShort(soa, DNS_QCLASS_IN);
+  memcpy(soa, &_ttl, 4);
+  soa += 4;
+  soa = writeNBOShort(soa, DNS_SOA_SIZE - 12);
+  *soa++ = 0; // MNAME: root
+  *soa++ = 0; // RNAME: root
+  uint32_t serial = lwip_htonl(1);
+  memcpy(soa, &serial, 4); // SERIAL
+  soa += 4;
+  for (int i = 0; i < 4; i++, soa += 4)
+    memcpy(soa, &_ttl, 4); // REFRESH, RETRY, EXPIRE, MINIMUM
+}
+
+void DNSServer::setRateLimit(uint16_t rate, uint16_t burst)
+{
+  _rateLimit = rate;
+  _rateBurst = burst > 0 ? burst : 1;
+}
+
+void DNSServer::telemetry(DNSTelemetry &copy)
+{
+  portENTER_CRITICAL(&_telemetryMux);
+  copy = _telemetry;
+  portEXIT_CRITICAL(&_telemetryMux);
+}
+
+void DNSServer::clearTelemetry()
+{
+  portENTER_CRITICAL(&_telemetryMux);
+  _telemetry.clear();
+  portEXIT_CRITICAL(&_telemetryMux);
+}
+
+void DNSServer::setBatchBudget(uint16_t budget)
+{
+  _batchBudget = budget > 0 ? budget : 1;
 }
 
 void DNSServer::stop()
 {
+  if (_task)
+  {
+    // let the task finish its current packet and exit by itself
+    _stopTask = true;
+    while (_task)
+      vTaskDelay(1);
+  }
   _udp.stop();
 }
 
+bool DNSServer::startTask(UBaseType_t priority, uint32_t stackSize)
+{
+  if (_task)
+    return true;
+
+  _stopTask = false;
+  TaskHandle_t task;
+  if (xTaskCreate(taskLoop, "dns", stackSize, this, priority, &task) != pdPASS)
+    return false;
+  _task = task;
+  return true;
+}
+
+void DNSServer::taskLoop(void *param)
+{
+  DNSServer *self = (DNSServer *)param;
+
+  // WiFiUDP has no blocking receive, so drain what is pending and sleep a
+  // tick when the socket is empty. A batch that used the whole budget
+  // sleeps too: under a flood the loop task (HTTP, logs) still gets the CPU.
+  while (!self->_stopTask)
+  {
+    uint16_t handled = self->drainRequests(self->_batchBudget);
+    if (handled == 0 || handled >= self->_batchBudget)
+      vTaskDelay(1);
+  }
+
+  self->_task = nullptr;
+  MemStatsTaskEnd(); // frees its MemStats and Trace slots for the next task
+  TraceTaskEnd();
+  vTaskDelete(NULL);
+}
+
 void DNSServer::downcaseAndRemoveWwwPrefix(String &domainName)
 {
   domainName.toLowerCase();
@@ -53,33 +359,119 @@ void DNSServer::downcaseAndRemoveWwwPrefix(String &domainName)
       domainName.remove(0, 4);
 }
 
+// Skips a name, which may end in a compression pointer.
+// Returns nullptr if it is malformed or runs past end.
+static const uint8_t *skipName(const uint8_t *p, const uint8_t *end)
+{
+  while (p < end)
+  {
+    uint8_t labelLength = *p;
+    if (labelLength == 0)
+      return p + 1;
+    if ((labelLength & 0xC0) == 0xC0)
+      return p + 2 <= end ? p + 2 : nullptr;
+    if (labelLength > 63)
+      return nullptr;
+    p += labelLength + 1;
+  }
+  return nullptr;
+}
+
+// Walks the rest of the request: the other questions and the answer and
+// authority records (not expected in a query, but harmless) are skipped,
+// the additional section is searched for the OPT record.
+// Every step moves forward inside the packet, so it ends after at most
+// length / 5 iterations whatever the counts in the header say.
+// Returns false if the packet is malformed.
+bool DNSServer::parseExtraSections(const uint8_t *start, const uint8_t *end,
+                                   const DNSHeader *dnsHeader)
+{
+  const uint8_t *p = start;
+  uint32_t questions = lwip_ntohs(dnsHeader->QDCount) - 1;
+  uint32_t records = (uint32_t)lwip_ntohs(dnsHeader->ANCount)
+                     + lwip_ntohs(dnsHeader->NSCount);
+  uint32_t additional = lwip_ntohs(dnsHeader->ARCount);
+
+  for (; questions > 0; questions--)
+  {
+    p = skipName(p, end);
+    if (p == nullptr || p + 4 > end)
+      return false;
+    p += 4; // qtype, qclass
+  }
+
+  for (uint32_t i = 0; i < records + additional; i++)
+  {
+    const uint8_t *name = p;
+    p = skipName(p, end);
+    // type, class, TTL, RDLENGTH
+    if (p == nullptr || p + 10 > end)
+      return false;
+    uint16_t type = (p[0] << 8) | p[1];
+    uint16_t rdLength = (p[8] << 8) | p[9];
+    if (p + 10 + rdLength > end)
+      return false;
+
+    if (type == DNS_QTYPE_OPT)
+    {
+      // only one, in the additional section and owned by the root
+      if (i < records || _edns || *name != 0)
+        return false;
+      _edns = true;
+      // TTL = extended RCODE, version, flags
+      if (p[5] != 0)
+        _ednsRcode = DNS_EDNS_BADVERS;
+    }
+    p += 10 + rdLength;
+  }
+  return true;
+}
+
 void DNSServer::respondToRequest(uint8_t *buffer, size_t length)
 {
+  PERF_SCOPE("dns");
+  TRACE_SCOPE("dns");
   DNSHeader *dnsHeader;
   uint8_t *query, *start;
-  const char *matchString;
   size_t remaining, labelLength, queryLength;
   uint16_t qtype, qclass;
 
   dnsHeader = (DNSHeader *)buffer;
+  _edns = false;
+  _ednsRcode = 0;
 
   // Must be a query for us to do anything with it
   if (dnsHeader->QR != DNS_QR_QUERY)
+  {
+    _stats.dropped++;
     return;
+  }
+
+  // A client over its rate gets no reply, so one phone flooding us
+  // can't starve the rest (token buckets keyed by IP).
+  // It's charged before parsing: malformed queries cost a token too.
+  uint32_t now = millis();
+  uint32_t ip = _udp.remoteIP();
+  bool allowed = _rateLimit == 0
+                 || _limiter.take(ip, now, _rateLimit, _rateBurst);
+  portENTER_CRITICAL(&_telemetryMux);
+  DNSClient &client = _telemetry.recordClient(ip, now);
+  if (!allowed)
+    client.refused++;
+  portEXIT_CRITICAL(&_telemetryMux);
+  if (!allowed)
+  {
+    _stats.refused++;
+    return;
+  }
 
   // If operation is anything other than query, we don't do it
   if (dnsHeader->OPCode != DNS_OPCODE_QUERY)
     return replyWithError(dnsHeader, DNSReplyCode::NotImplemented);
 
-  // Only support requests containing single queries - everything else
-  // is badly defined
-  if (dnsHeader->QDCount != lwip_htons(1))
-    return replyWithError(dnsHeader, DNSReplyCode::FormError);
-
-  // We must return a FormError in the case of a non-zero ARCount to
-  // be minimally compatible with EDNS resolvers
-  if (dnsHeader->ANCount != 0 || dnsHeader->NSCount != 0
-      || dnsHeader->ARCount != 0)
+  // We need at least one question. If there are more, only the first
+  // one is answered (and echoed), which is what every resolver expects
+  if (dnsHeader->QDCount == 0)
     return replyWithError(dnsHeader, DNSReplyCode::FormError);
 
   // Even if we're not going to use the query, we need to parse it
@@ -89,7 +481,8 @@ void DNSServer::respondToRequest(uint8_t *buffer, size_t length)
   remaining = length - DNS_HEADER_SIZE;
   while (remaining != 0 && *start != 0) {
     labelLength = *start;
-    if (labelLength + 1 > remaining)
+    // no compression in the first name, there is nothing to point to
+    if (labelLength > 63 || labelLength + 1 > remaining)
 	return replyWithError(dnsHeader, DNSReplyCode::FormError);
     remaining -= (labelLength + 1);
     start += (labelLength + 1);
@@ -108,122 +501,153 @@ void DNSServer::respondToRequest(uint8_t *buffer, size_t length)
 
   queryLength = start - query;
 
-  if (qclass != lwip_htons(DNS_QCLASS_ANY)
-      && qclass != lwip_htons(DNS_QCLASS_IN))
-    return replyWithError(dnsHeader, DNSReplyCode::NonExistentDomain,
+  portENTER_CRITICAL(&_telemetryMux);
+  _telemetry.recordQuestion(lwip_ntohs(qtype), query);
+  portEXIT_CRITICAL(&_telemetryMux);
+
+  // Looks for an OPT record (EDNS0) after the question. Everything after
+  // the first question is overwritten by the reply, so it's read first.
+  if (!parseExtraSections(start, buffer + length, dnsHeader))
+    return replyWithError(dnsHeader, DNSReplyCode::FormError,
+			  query, queryLength);
+
+  // We only speak EDNS version 0
+  if (_ednsRcode == DNS_EDNS_BADVERS)
+    return replyWithError(dnsHeader, DNSReplyCode::NoError,
 			  query, queryLength);
 
-  if (qtype != lwip_htons(DNS_QTYPE_A)
-      && qtype != lwip_htons(DNS_QTYPE_ANY))
+  if (qclass != lwip_htons(DNS_QCLASS_ANY)
+      && qclass != lwip_htons(DNS_QCLASS_IN))
     return replyWithError(dnsHeader, DNSReplyCode::NonExistentDomain,
 			  query, queryLength);
 
-  // If we have no domain name configured, just return an error
-  if (_domainName.isEmpty())
+  // One hash lookup per label, whatever the number of zones
+  const DNSZone *zone = lookup(query);
+  if (zone == nullptr)
     return replyWithError(dnsHeader, _errorReplyCode,
 			  query, queryLength);
 
-  // If we're running with a wildcard we can just return a result now
-  if (_domainName == "*")
-    return replyWithIP(dnsHeader, query, queryLength);
+  if (qtype == lwip_htons(DNS_QTYPE_A)
+      || qtype == lwip_htons(DNS_QTYPE_ANY))
+    return replyWithIP(dnsHeader, query, queryLength, zone);
 
-  matchString = _domainName.c_str();
+  // Phones ask for AAAA and HTTPS next to every A. The name exists, so
+  // answer "no records of that type" and let them cache it instead of
+  // retrying (NXDOMAIN would also hide the A record from some resolvers).
+  if (qtype == lwip_htons(DNS_QTYPE_AAAA)
+      || qtype == lwip_htons(DNS_QTYPE_HTTPS))
+    return replyWithNoData(dnsHeader, query, queryLength);
 
-  start = query;
-
-  // If there's a leading 'www', skip it
-  if (*start == 3 && strncasecmp("www", (char *) start + 1, 3) == 0)
-      start += 4;
+  return replyWithError(dnsHeader, DNSReplyCode::NonExistentDomain,
+			query, queryLength);
+}
 
-  while (*start != 0) {
-    labelLength = *start;
-    start += 1;
-    while (labelLength > 0) {
-      if (tolower(*start) != *matchString)
-	return replyWithError(dnsHeader, _errorReplyCode,
-			      query, queryLength);
-      ++start;
-      ++matchString;
-      --labelLength;
-    }
-    if (*start == 0 && *matchString == '\0')
-      return replyWithIP(dnsHeader, query, queryLength);
+void DNSServer::processNextRequest()
+{
+  drainRequests(_batchBudget);
+}
 
-    if (*matchString != '.')
-      return replyWithError(dnsHeader, _errorReplyCode,
-			    query, queryLength);
-    ++matchString;
-  }
+// handles up to budget pending packets, returns how many were found
+uint16_t DNSServer::drainRequests(uint16_t budget)
+{
+  uint16_t handled = 0;
+  while (handled < budget && processOnePacket())
+    handled++;
 
-  return replyWithError(dnsHeader, _errorReplyCode,
-			query, queryLength);
+  if (handled > _stats.maxBatch)
+    _stats.maxBatch = handled;
+  return handled;
 }
 
-void DNSServer::processNextRequest()
+// returns false if there was no packet pending
+bool DNSServer::processOnePacket()
 {
   size_t currentPacketSize;
 
   currentPacketSize = _udp.parsePacket();
   if (currentPacketSize == 0)
-    return;
+    return false;
+
+  _stats.received++;
 
   // The DNS RFC requires that DNS packets be less than 512 bytes in size,
   // so just discard them if they are larger
-  if (currentPacketSize > MAX_DNS_PACKETSIZE)
-    return;
-
   // If the packet size is smaller than the DNS header, then someone is
   // messing with us
-  if (currentPacketSize < DNS_HEADER_SIZE)
-    return;
+  if (currentPacketSize > MAX_DNS_PACKETSIZE || currentPacketSize < DNS_HEADER_SIZE)
+  {
+    _stats.dropped++;
+    return true;
+  }
 
-  std::unique_ptr<uint8_t[]> buffer(new (std::nothrow) uint8_t[currentPacketSize]);
-  if (buffer == nullptr)
-    return;
+  uint32_t started = micros();
+  _udp.read(_buffer, currentPacketSize);
+  respondToRequest(_buffer, currentPacketSize);
+  uint32_t elapsed = micros() - started;
 
-  _udp.read(buffer.get(), currentPacketSize);
-  respondToRequest(buffer.get(), currentPacketSize);
+  portENTER_CRITICAL(&_telemetryMux);
+  _telemetry.recordLatency(elapsed);
+  portEXIT_CRITICAL(&_telemetryMux);
+  return true;
 }
 
-void DNSServer::writeNBOShort(uint16_t value)
+// the whole reply goes out in a single write
+void DNSServer::sendReply(uint8_t *reply, size_t length)
 {
-   _udp.write((unsigned char *)&value, 2);
+  // EDNS requests get our OPT record back in the additional section
+  // (there is always room for it: the request had one too)
+  if (_edns)
+  {
+    uint8_t *opt = reply + length;
+    *opt++ = 0; // root name
+    opt = writeNBOShort(opt, DNS_QTYPE_OPT);
+    opt = writeNBOShort(opt, DNS_EDNS_PAYLOAD); // class: UDP payload size
+    *opt++ = _ednsRcode;                        // TTL: extended RCODE,
+    *opt++ = 0;                                 //      version 0
+    opt = writeNBOShort(opt, 0);                //      and no flags
+    opt = writeNBOShort(opt, 0);                // no options
+    ((DNSHeader *)reply)->ARCount = lwip_htons(1);
+    length = opt - reply;
+  }
+
+  _udp.beginPacket(_udp.remoteIP(), _udp.remotePort());
+  _udp.write(reply, length);
+  _udp.endPacket();
+  _stats.answered++;
 }
 
 void DNSServer::replyWithIP(DNSHeader *dnsHeader,
 			    unsigned char * query,
-			    size_t queryLength)
+			    size_t queryLength,
+			    const DNSZone *zone)
 {
-  uint16_t value;
-
   dnsHeader->QR = DNS_QR_RESPONSE;
   dnsHeader->QDCount = lwip_htons(1);
   dnsHeader->ANCount = lwip_htons(1);
   dnsHeader->NSCount = 0;
   dnsHeader->ARCount = 0;
 
-  _udp.beginPacket(_udp.remoteIP(), _udp.remotePort());
-  _udp.write((unsigned char *) dnsHeader, sizeof(DNSHeader));
-  _udp.write(query, queryLength);
+  // The query follows the header in the request buffer, so the answer is
+  // appended right after it and the reply is header + query + answer.
+  memcpy(query + queryLength, zone->answer, DNS_ANSWER_SIZE);
 
-  // Rather than restate the name here, we use a pointer to the name contained
-  // in the query section. Pointers have the top two bits set.
-  value = 0xC000 | DNS_HEADER_SIZE;
-  writeNBOShort(lwip_htons(value));
-
-  // Answer is type A (an IPv4 address)
-  writeNBOShort(lwip_htons(DNS_QTYPE_A));
+  sendReply((uint8_t *)dnsHeader, DNS_HEADER_SIZE + queryLength + DNS_ANSWER_SIZE);
+}
 
-  // Answer is in the Internet Class
-  writeNBOShort(lwip_htons(DNS_QCLASS_IN));
+void DNSServer::replyWithNoData(DNSHeader *dnsHeader,
+				unsigned char *query,
+				size_t queryLength)
+{
+  dnsHeader->QR = DNS_QR_RESPONSE;
+  dnsHeader->RCode = (unsigned char) DNSReplyCode::NoError;
+  dnsHeader->QDCount = lwip_htons(1);
+  dnsHeader->ANCount = 0;
+  dnsHeader->NSCount = lwip_htons(1);
+  dnsHeader->ARCount = 0;
 
-  // Output TTL (already NBO)
-  _udp.write((unsigned char*)&_ttl, 4);
+  memcpy(query + queryLength, _soa, DNS_SOA_SIZE);
 
-  // Length of RData is 4 bytes (because, in this case, RData is IPv4)
-  writeNBOShort(lwip_htons(sizeof(_resolvedIP)));
-  _udp.write(_resolvedIP, sizeof(_resolvedIP));
-  _udp.endPacket();
+  sendReply((uint8_t *)dnsHeader, DNS_HEADER_SIZE + queryLength + DNS_SOA_SIZE);
 }
 
 void DNSServer::replyWithError(DNSHeader *dnsHeader,
@@ -241,15 +665,12 @@ void DNSServer::replyWithError(DNSHeader *dnsHeader,
   dnsHeader->NSCount = 0;
   dnsHeader->ARCount = 0;
 
-  _udp.beginPacket(_udp.remoteIP(), _udp.remotePort());
-  _udp.write((unsigned char *)dnsHeader, sizeof(DNSHeader));
-  if (query != NULL)
-     _udp.write(query, queryLength);
-  _udp.endPacket();
+  // the query (if any) already follows the header in the buffer
+  sendReply((uint8_t *)dnsHeader, sizeof(DNSHeader) + (query ? queryLength : 0));
 }
 
 void DNSServer::replyWithError(DNSHeader *dnsHeader,
 			       DNSReplyCode rcode)
 {
   replyWithError(dnsHeader, rcode, NULL, 0);
-}
\ No newline at end of file
+}
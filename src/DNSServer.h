@@ -1,6 +1,10 @@
 #ifndef DNSServer_h
 #define DNSServer_h
 #include <WiFiUdp.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include "DNSRateLimiter.h"
+#include "DNSTelemetry.h"
 
 #define DNS_QR_QUERY 0
 #define DNS_QR_RESPONSE 1
@@ -10,11 +14,42 @@
 #define DNS_QCLASS_ANY 255
 
 #define DNS_QTYPE_A 1
+#define DNS_QTYPE_SOA 6
+#define DNS_QTYPE_AAAA 28
+#define DNS_QTYPE_OPT 41
+#define DNS_QTYPE_HTTPS 65
 #define DNS_QTYPE_ANY 255
 
 #define MAX_DNSNAME_LENGTH 253
 #define MAX_DNS_PACKETSIZE 512
 
+// room after the request for the answer/authority section of the reply
+#define DNS_REPLY_EXTRA 64
+
+// precomputed records: A answer (pointer, type, class, TTL, RDLENGTH, IP)
+// and the SOA sent with negative answers (root mname/rname + 5 counters)
+#define DNS_ANSWER_SIZE 16
+#define DNS_SOA_SIZE 34
+
+// EDNS0: the OPT record we echo (root name, type, class, TTL, RDLENGTH),
+// the UDP payload size we announce in it and the BADVERS extended RCODE
+// (upper 8 bits of 16)
+#define DNS_OPT_SIZE 11
+#define DNS_EDNS_PAYLOAD 512
+#define DNS_EDNS_BADVERS 1
+
+// max packets handled by a single processNextRequest() call
+#define DNS_DEFAULT_BATCH 16
+
+// per client rate limit: queries/second and burst (0 disables it)
+#define DNS_DEFAULT_RATE 20
+#define DNS_DEFAULT_BURST 40
+
+// zone table: capacity, hash slots (power of 2) and max wire-format name length
+#define DNS_MAX_ZONES 16
+#define DNS_ZONE_SLOTS 32
+#define DNS_MAX_ZONE_NAME 64
+
 enum class DNSReplyCode
 {
   NoError = 0,
@@ -45,44 +80,130 @@ struct DNSHeader
   uint16_t ARCount;         // number of resource entries
 };
 
+struct DNSServerStats
+{
+  uint32_t received;  // packets read from the socket
+  uint32_t answered;  // replies sent
+  uint32_t dropped;   // packets ignored (bad size, not a query)
+  uint32_t refused;   // queries ignored by the per client rate limit
+  // most packets handled in a single processNextRequest() pass. It's capped
+  // by the batch budget (setBatchBudget()), so it is not the socket queue
+  // depth: hitting the budget means packets were left pending.
+  uint32_t maxBatch;
+};
+
+// a name we answer for, stored as lowercase wire-format labels
+// (for "*.example.com" only "example.com" is stored, with wildcard set)
+struct DNSZone
+{
+  uint8_t name[DNS_MAX_ZONE_NAME];
+  uint8_t nameLength;
+  bool wildcard;
+  bool defaultTTL; // follows setTTL()
+  uint32_t hash;
+  unsigned char ip[4];
+  uint32_t ttl; // NBO
+  uint8_t answer[DNS_ANSWER_SIZE]; // the A record, appended as is to replies
+};
+
 class DNSServer
 {
 public:
   DNSServer();
+  // uses the given socket instead of its own WiFiUDP (any Arduino UDP:
+  // another network stack, or a fake one to run the server off-device)
+  DNSServer(UDP &udp);
   ~DNSServer()
   {
     stop();
   };
+  // answers every pending request, up to the batch budget
   void processNextRequest();
   void setErrorReplyCode(const DNSReplyCode &replyCode);
   void setTTL(const uint32_t &ttl);
+  void setBatchBudget(uint16_t budget);
+  // queries/second allowed per client IP, with bursts of up to burst
+  // queries. Over the limit queries get no reply. rate 0 disables it.
+  void setRateLimit(uint16_t rate, uint16_t burst);
+
+  // runs the server in its own task (processNextRequest() must not be
+  // called from the loop then). Call after start(). Priority 1 is the one
+  // of the Arduino loop task, so both share the CPU even under a flood.
+  bool startTask(UBaseType_t priority = 1, uint32_t stackSize = 3072);
+  bool hasTask() const { return _task != nullptr; }
+  TaskHandle_t task() const { return _task; }
+  const DNSServerStats &stats() const { return _stats; }
+  // consistent copy of the query statistics (safe while the task runs)
+  void telemetry(DNSTelemetry &copy);
+  void clearTelemetry();
 
   // Returns true if successful, false if there are no sockets available
+  // (domainName is added as the first zone, "*" answers every name)
   bool start(const uint16_t &port,
              const String &domainName,
              const IPAddress &resolvedIP);
+
+  // Names to answer for: "host.local" (exact, a leading "www." also matches),
+  // "*.example.com" (any name below example.com) or "*" (everything else).
+  // ttl 0 uses the server TTL. Add zones before startTask().
+  bool addZone(const String &name, const IPAddress &ip, uint32_t ttl = 0);
+  void clearZones();
   // stops the DNS server
   void stop();
 
 private:
-  WiFiUDP _udp;
+  WiFiUDP _ownUdp;
+  UDP &_udp;
   uint16_t _port;
-  String _domainName;
-  unsigned char _resolvedIP[4];
   uint32_t _ttl;
+  DNSZone _zones[DNS_MAX_ZONES];
+  uint8_t _zoneCount;
+  int8_t _zoneSlots[DNS_ZONE_SLOTS]; // index in _zones, -1 if empty
+  int8_t _defaultZone;               // the "*" zone, -1 if none
   DNSReplyCode _errorReplyCode;
+  uint8_t _soa[DNS_SOA_SIZE]; // authority of NODATA replies, follows setTTL()
+  // requests are read here and replies are built in place (header and
+  // query are reused, the answer is appended) so no heap is used per packet
+  uint8_t _buffer[MAX_DNS_PACKETSIZE + DNS_REPLY_EXTRA];
+  uint16_t _batchBudget;
+  uint16_t _rateLimit;
+  uint16_t _rateBurst;
+  DNSServerStats _stats;
+  DNSRateLimiter _limiter; // only the packet handling touches it
+  DNSTelemetry _telemetry;
+  portMUX_TYPE _telemetryMux = portMUX_INITIALIZER_UNLOCKED;
+  bool _edns;         // the current request had an OPT record
+  uint8_t _ednsRcode; // extended RCODE for the OPT of the reply
+  TaskHandle_t volatile _task;
+  volatile bool _stopTask;
+
+  uint16_t drainRequests(uint16_t budget);
+  bool processOnePacket();
+  static void taskLoop(void *param);
 
   void downcaseAndRemoveWwwPrefix(String &domainName);
+  void buildAnswer(DNSZone &zone);
+  void buildSOA();
+  const DNSZone *findZone(uint32_t hash, bool wildcard,
+                          const uint8_t *name, size_t length) const;
+  const DNSZone *lookup(const uint8_t *query) const;
   void replyWithIP(DNSHeader *dnsHeader,
                    unsigned char *query,
-                   size_t queryLength);
+                   size_t queryLength,
+                   const DNSZone *zone);
+  void replyWithNoData(DNSHeader *dnsHeader,
+                       unsigned char *query,
+                       size_t queryLength);
   void replyWithError(DNSHeader *dnsHeader,
                       DNSReplyCode rcode,
                       unsigned char *query,
                       size_t queryLength);
   void replyWithError(DNSHeader *dnsHeader,
                       DNSReplyCode rcode);
+  void init();
+  bool parseExtraSections(const uint8_t *start, const uint8_t *end,
+                          const DNSHeader *dnsHeader);
   void respondToRequest(uint8_t *buffer, size_t length);
-  void writeNBOShort(uint16_t value);
+  void sendReply(uint8_t *reply, size_t length);
 };
 #endif
\ No newline at end of file
@@ -0,0 +1,146 @@
+#include "DNSTelemetry.h"
+#include "DNSServer.h"
+
+#define FNV_OFFSET 2166136261u
+#define FNV_PRIME 16777619u
+
+void DNSTelemetry::clear()
+{
+  memset(qtypes, 0, sizeof(qtypes));
+  memset(topNames, 0, sizeof(topNames));
+  memset(clients, 0, sizeof(clients));
+  memset(latency, 0, sizeof(latency));
+  current = DNS_CLIENTS;
+}
+
+DNSClient &DNSTelemetry::recordClient(uint32_t ip, uint32_t now)
+{
+  DNSClient &client = findClient(ip, now);
+  client.count++;
+  client.lastSeen = now;
+  if (now - client.windowStart >= 1000)
+  {
+    // a gap longer than a window means nothing was asked in the last one
+    client.rate = now - client.windowStart < 2000 ? client.windowCount : 0;
+    client.windowStart = now;
+    client.windowCount = 0;
+  }
+  client.windowCount++;
+  current = &client - clients;
+  return client;
+}
+
+void DNSTelemetry::recordQuestion(uint16_t qtype, const uint8_t *name)
+{
+  switch (qtype)
+  {
+  case DNS_QTYPE_A:
+    qtypes[DNS_SLOT_A]++;
+    break;
+  case DNS_QTYPE_AAAA:
+    qtypes[DNS_SLOT_AAAA]++;
+    break;
+  case DNS_QTYPE_HTTPS:
+    qtypes[DNS_SLOT_HTTPS]++;
+    break;
+  case DNS_QTYPE_ANY:
+    qtypes[DNS_SLOT_ANY]++;
+    break;
+  default:
+    qtypes[DNS_SLOT_OTHER]++;
+  }
+
+  countName(name);
+}
+
+// the client's entry, or a new one in place of the least recently seen
+DNSClient &DNSTelemetry::findClient(uint32_t ip, uint32_t now)
+{
+  DNSClient *oldest = &clients[0];
+  for (DNSClient &client : clients)
+  {
+    if (client.ip == ip)
+      return client;
+    if (client.ip == 0)
+    {
+      oldest = &client;
+      break;
+    }
+    if (now - client.lastSeen > now - oldest->lastSeen)
+      oldest = &client;
+  }
+  memset(oldest, 0, sizeof(*oldest));
+  oldest->ip = ip;
+  oldest->windowStart = now;
+  return *oldest;
+}
+
+void DNSTelemetry::countName(const uint8_t *name)
+{
+  // names are compared case insensitive (some resolvers randomize the case)
+  uint32_t hash = FNV_OFFSET;
+  for (const uint8_t *p = name; *p != 0; p++)
+    hash = (hash ^ tolower(*p)) * FNV_PRIME;
+  if (hash == 0)
+    hash = 1;
+
+  DNSTopName *least = &topNames[0];
+  for (DNSTopName &top : topNames)
+  {
+    if (top.hash == hash)
+    {
+      top.count++;
+      return;
+    }
+    if (top.count < least->count)
+      least = &top;
+  }
+
+  // not counted yet: takes the place of the least counted name (or of an
+  // empty slot, count 0), which becomes its error bound
+  least->hash = hash;
+  least->error = least->count;
+  least->count++;
+
+  // "\3www\6google\3com" => "www.google.com"
+  size_t length = 0;
+  for (const uint8_t *p = name; *p != 0 && length < DNS_TOP_NAME_LENGTH - 1; p += *p + 1)
+  {
+    if (length > 0)
+      least->name[length++] = '.';
+    size_t labelLength = min((size_t)*p, DNS_TOP_NAME_LENGTH - 1 - length);
+    for (size_t i = 0; i < labelLength; i++)
+      least->name[length++] = tolower(p[i + 1]);
+  }
+  least->name[length] = 0;
+}
+
+void DNSTelemetry::recordLatency(uint32_t micros)
+{
+  uint8_t bucket = 0;
+  while (micros >= 2 && bucket < DNS_LATENCY_BUCKETS - 1)
+  {
+    micros >>= 1;
+    bucket++;
+  }
+  latency[bucket]++;
+
+  if (current < DNS_CLIENTS)
+  {
+    uint16_t &count = clients[current].latency[bucket];
+    if (count < UINT16_MAX)
+      count++;
+    current = DNS_CLIENTS;
+  }
+}
+
+const char *DNSTelemetry::qtypeName(uint8_t slot)
+{
+  static const char *const names[DNS_QTYPE_SLOTS] = {"A", "AAAA", "HTTPS", "ANY", "other"};
+  return slot < DNS_QTYPE_SLOTS ? names[slot] : "";
+}
+
+uint32_t DNSTelemetry::latencyLimit(uint8_t bucket)
+{
+  return bucket < DNS_LATENCY_BUCKETS - 1 ? 2u << bucket : UINT32_MAX;
+}
@@ -0,0 +1,80 @@
+#ifndef DNSTelemetry_h
+#define DNSTelemetry_h
+#include <Arduino.h>
+
+// Fixed-size statistics about the queries the DNS server gets.
+// Memory never grows and every update touches a bounded number of entries:
+//  - counters per query type
+//  - the most queried names (space-saving: the least counted entry is
+//    replaced, its count is kept as the error bound of the new name)
+//  - per client IP totals, queries/second and queries refused by the rate
+//    limit (least recently seen evicted; the token buckets themselves are
+//    in DNSRateLimiter, so clear() doesn't reset the limit)
+//  - a log2 histogram of the time spent on each packet, overall and per
+//    client (16 bit counters there, they stop at 65535)
+
+#define DNS_TOP_NAMES 8
+#define DNS_TOP_NAME_LENGTH 48 // dotted name, longer ones are cut
+#define DNS_CLIENTS 32
+#define DNS_LATENCY_BUCKETS 16 // bucket i: < 2^(i+1) us, the last one is the rest
+
+enum DNSQTypeSlot
+{
+  DNS_SLOT_A,
+  DNS_SLOT_AAAA,
+  DNS_SLOT_HTTPS,
+  DNS_SLOT_ANY,
+  DNS_SLOT_OTHER,
+  DNS_QTYPE_SLOTS
+};
+
+struct DNSTopName
+{
+  uint32_t hash; // 0 if the slot is empty
+  uint32_t count;
+  uint32_t error; // count may be overestimated by up to this
+  char name[DNS_TOP_NAME_LENGTH];
+};
+
+struct DNSClient
+{
+  uint32_t ip; // 0 if the slot is empty
+  uint32_t count;
+  uint32_t lastSeen;    // millis()
+  uint32_t windowStart; // millis() of the current 1 s window
+  uint16_t windowCount; // queries in the current window
+  uint16_t rate;        // queries in the last complete window
+  uint32_t refused;     // queries dropped by the rate limit
+  uint16_t latency[DNS_LATENCY_BUCKETS];
+};
+
+class DNSTelemetry
+{
+public:
+  uint32_t qtypes[DNS_QTYPE_SLOTS];
+  DNSTopName topNames[DNS_TOP_NAMES];
+  DNSClient clients[DNS_CLIENTS];
+  uint32_t latency[DNS_LATENCY_BUCKETS];
+
+  DNSTelemetry() { clear(); }
+  void clear();
+
+  // counts a packet from ip, before it is parsed. Returns the entry of the client.
+  DNSClient &recordClient(uint32_t ip, uint32_t now);
+  // name is the wire-format question name (already validated)
+  void recordQuestion(uint16_t qtype, const uint8_t *name);
+  // the time spent on the packet, also for its client if recordClient()
+  // was called for it
+  void recordLatency(uint32_t micros);
+
+  static const char *qtypeName(uint8_t slot);
+  // upper bound (us) of a latency bucket, UINT32_MAX for the last one
+  static uint32_t latencyLimit(uint8_t bucket);
+
+private:
+  uint8_t current; // index of the client of the packet being handled, DNS_CLIENTS if none
+
+  DNSClient &findClient(uint32_t ip, uint32_t now);
+  void countName(const uint8_t *name);
+};
+#endif
@@ -0,0 +1,68 @@
+/*
+    DeviceId.cpp
+    Ver DeviceId.h
+
+    JJTeam - 2021
+*/
+
+#include "DeviceId.h"
+#include <esp_system.h>
+
+static char serial[DEVICE_ID_SIZE];
+static char hostname[DEVICE_ID_SIZE + 8];       // "pigguard" + serial
+static char localHostname[DEVICE_ID_SIZE + 14]; // + ".local"
+static char softAPSSID[DEVICE_ID_SIZE + 10];    // "Pig Guard " + serial
+
+/**
+ * El ID del ESP32 es la Mac Address, pero la muestro en Base 36
+ *
+ * En la pagina de https://macaddress.io/ se puede ver esto:
+ *
+ * =============================================================
+ *  Vendor details, OUI [7C:9E:BD], Company name: Espressif Inc
+ * =============================================================
+ *
+ * Por eso voy a usar como numero de serie solo los 3 bytes ultimos.
+ */
+static void computeIdentity()
+{
+    if (serial[0] != 0)
+        return;
+
+    struct
+    {
+        uint32_t h;
+        uint32_t l;
+    } u;
+    esp_efuse_mac_get_default((uint8_t *)(&u));
+    uint32_t id = ((u.h >> 8) & 0xff0000) | ((u.l << 8) & 0xff00) | ((u.l >> 8) & 0x00ff);
+    utoa(id, serial, 36);
+
+    snprintf(hostname, sizeof(hostname), "pigguard%s", serial);
+    snprintf(localHostname, sizeof(localHostname), "%s.local", hostname);
+    snprintf(softAPSSID, sizeof(softAPSSID), "Pig Guard %s", serial);
+}
+
+const char *DeviceSerial()
+{
+    computeIdentity();
+    return serial;
+}
+
+const char *DeviceHostname()
+{
+    computeIdentity();
+    return hostname;
+}
+
+const char *DeviceLocalHostname()
+{
+    computeIdentity();
+    return localHostname;
+}
+
+const char *DeviceSoftAPSSID()
+{
+    computeIdentity();
+    return softAPSSID;
+}
@@ -10,6 +10,8 @@
 #define LOG_LOCAL_LEVEL ESP_LOG_VERBOSE
 #include "esp_log.h"
 #include "FSBuffer.h"
+#include "PerfStats.h"
+#include "Trace.h"
 #include <SPIFFS.h>
 #include <SPI.h>
 #include <SD.h>
@@ -31,18 +33,35 @@ void FsBuffer::initFile()
     if (!f)
     {
         // esta guardado en formato .ini
-        fileIndexActual = filesCount - 1; // fuerzo al archivo 1.
-        storeConfig();                    //
-        nextFile();                       // dejo preparado el nombre a usar.
+        fileIndexActual = filesCount - 1; // fuerzo al archivo 0.
+        nextFile();                       // dejo preparado el nombre a usar (y guarda la config).
     }
     else
     {
         // la primer linea contiene el indice, ej: "fileIndexActual=2\n"
         f.readStringUntil('=');
-        fileIndexActual = f.readStringUntil('\n').toInt();
+        long index = f.readStringUntil('\n').toInt();
+        // despues "totalFiles=4\n" y "seqInicial=1234\n" (no esta en configs viejas)
+        f.readStringUntil('\n');
+        f.readStringUntil('=');
+        seqInicial = f.readStringUntil('\n').toInt();
         f.close();
-        bufFileName = getFileName(fileIndexActual);
+        if (index >= 0 && index < filesCount)
+        {
+            fileIndexActual = index;
+            bufFileName = getFileName(fileIndexActual);
+        }
+        else
+        {
+            // config rota o de cuando habia mas archivos: arranco en uno nuevo
+            ESP_LOGW("*", "fileIndexActual=%ld fuera de rango, se cambia de archivo", index);
+            fileIndexActual = filesCount - 1;
+            nextFile();
+        }
     }
+
+    // el indice del archivo actual se arma ahora, despues se actualiza en cada write.
+    getIndex(fileIndexActual);
 }
 
 // guarda cosas en flash (por si un reset)
@@ -56,7 +75,8 @@ void FsBuffer::storeConfig()
     {
         // dejo constancia en el archivo de configuracion, como leer los logs,
         // por las dudas que se levanten desde una PC.
-        f.printf("fileIndexActual=%d\ntotalFiles=%d\n", fileIndexActual, filesCount);
+        f.printf("fileIndexActual=%d\ntotalFiles=%d\nseqInicial=%u\n", fileIndexActual, filesCount, seqInicial);
+        f.close();
     }
 }
 
@@ -66,6 +86,8 @@ void FsBuffer::nextFile()
     if (fileSystemError)
         return;
 
+    closeBufFile();
+    seqInicial += getIndex(fileIndexActual).lines;
     fileIndexActual++;
     if (fileIndexActual == filesCount)
     {
@@ -76,6 +98,26 @@ void FsBuffer::nextFile()
     // ejemplo: /log/buf.1
     bufFileName = getFileName(fileIndexActual);
     remove(bufFileName);
+    lineIndex[fileIndexActual].reset();
+
+    // la config solo cambia al rotar, no hace falta grabarla en cada write.
+    storeConfig();
+}
+
+// abre el archivo actual en modo append y toma su tamaño una sola vez.
+void FsBuffer::openBufFile()
+{
+    bufFile = open(bufFileName, FILE_APPEND);
+    bufFileSize = bufFile ? bufFile.size() : 0;
+    pendingBytes = 0;
+    lastSync = millis();
+}
+
+void FsBuffer::closeBufFile()
+{
+    if (bufFile)
+        bufFile.close();
+    pendingBytes = 0;
 }
 
 String FsBuffer::getFileName(int index)
@@ -83,28 +125,161 @@ String FsBuffer::getFileName(int index)
     return baseFilename + "/buf." + index;
 }
 
+//----------------------------------------------------------------------------
+
+void FsBufferIndex::reset()
+{
+    valid = true;
+    lines = 0;
+    bytes = 0;
+    step = 8;
+    count = 1;
+    offsets[0] = 0; // la linea 0 empieza al principio
+}
+
+void FsBufferIndex::feed(const uint8_t *data, size_t len)
+{
+    const uint8_t *p = data;
+    const uint8_t *end = data + len;
+    while ((p = (const uint8_t *)memchr(p, '\n', end - p)) != nullptr)
+    {
+        p++;
+        lines++;
+        if (lines % step != 0)
+            continue;
+
+        if (count == FSBUFFER_INDEX_SIZE)
+        {
+            // lleno: me quedo con una de cada dos entradas
+            for (uint16_t i = 1; i < FSBUFFER_INDEX_SIZE / 2; i++)
+                offsets[i] = offsets[2 * i];
+            count = FSBUFFER_INDEX_SIZE / 2;
+            step *= 2;
+            if (lines % step != 0)
+                continue;
+        }
+        offsets[count++] = bytes + (p - data);
+    }
+    bytes += len;
+}
+
+// devuelve el indice del archivo, si no esta armado recorre el archivo una vez.
+FsBufferIndex &FsBuffer::getIndex(int index)
+{
+    FsBufferIndex &idx = lineIndex[index];
+    if (idx.valid)
+        return idx;
+
+    if (index == fileIndexActual)
+        sync();
+
+    idx.reset();
+    File f = open(getFileName(index), FILE_READ);
+    if (f)
+    {
+        uint8_t buffer[FSBUFFER_BLOCK_SIZE];
+        size_t bytes;
+        while ((bytes = f.read(buffer, sizeof(buffer))) > 0)
+            idx.feed(buffer, bytes);
+        f.close();
+    }
+    return idx;
+}
+
+// lee count lineas empezando en offset (y salteando las primeras skip). Devuelve las que se pasaron al callback.
+uint32_t FsBuffer::readLines(const String &filename, uint32_t offset, uint32_t skip, uint32_t count, ForEachLineCallback callback, void *ctx)
+{
+    uint32_t done = 0;
+    File f = open(filename, FILE_READ);
+    if (f)
+    {
+        f.seek(offset);
+        done = scanLines(f, skip, count, callback, ctx);
+        f.close();
+    }
+    return done;
+}
+
+/**
+ * Lee el archivo de a bloques y llama al callback por cada linea (saltea las primeras skip, y corta despues de count).
+ * Si la linea esta entera en el bloque se pasa un puntero al bloque (sin copiar),
+ * si cae entre dos bloques se arma en un buffer aparte. No usa memoria dinamica.
+ * Devuelve la cantidad de lineas que se pasaron al callback.
+ */
+uint32_t FsBuffer::scanLines(File &f, uint32_t skip, uint32_t count, ForEachLineCallback callback, void *ctx)
+{
+    char block[FSBUFFER_BLOCK_SIZE + 1]; // +1 para poner el '\0' al final
+    char line[FSBUFFER_LINE_SIZE + 1];
+    size_t lineLen = 0;
+    uint32_t done = 0;
+    size_t bytes;
+
+    while (done < count && (bytes = f.read((uint8_t *)block, FSBUFFER_BLOCK_SIZE)) > 0)
+    {
+        char *p = block;
+        char *end = block + bytes;
+        while (p < end && done < count)
+        {
+            char *nl = (char *)memchr(p, '\n', end - p);
+            size_t len = (nl ? nl : end) - p;
+
+            if (!nl || lineLen > 0)
+            {
+                // la linea sigue en el proximo bloque (o viene del anterior): la junto aparte
+                size_t n = min(len, FSBUFFER_LINE_SIZE - lineLen);
+                memcpy(line + lineLen, p, n);
+                lineLen += n;
+                if (!nl)
+                    break;
+            }
+
+            *nl = 0;
+            if (skip > 0)
+                skip--;
+            else if (lineLen > 0)
+            {
+                line[lineLen] = 0;
+                callback(line, lineLen, ctx);
+                done++;
+            }
+            else
+            {
+                callback(p, len, ctx);
+                done++;
+            }
+            lineLen = 0;
+            p = nl + 1;
+        }
+    }
+
+    // ultima linea sin '\n'
+    if (lineLen > 0 && done < count && skip == 0)
+    {
+        line[lineLen] = 0;
+        callback(line, lineLen, ctx);
+        done++;
+    }
+    return done;
+}
+
+// sin file system (no se pudo montar ninguno) no hacen nada
 File FsBuffer::open(const String &path, const char *mode)
 {
-    if (microSDExists)
-        return SD.open(path, mode);
-    else
-        return SPIFFS.open(path, mode);
+    if (fileSystem == nullptr)
+        return File();
+    return fileSystem->open(path, mode);
 }
 
 void FsBuffer::mkdir(const String &folder)
 {
-    if (microSDExists)
-        SD.mkdir(folder);
-    else
-        SPIFFS.mkdir(folder);
+    if (fileSystem != nullptr)
+        fileSystem->mkdir(folder);
 }
 
 void FsBuffer::remove(const String &path)
 {
-    if (microSDExists)
-        SD.remove(path);
-    else
-        SPIFFS.remove(path);
+    if (fileSystem != nullptr)
+        fileSystem->remove(path);
 }
 
 void FsBuffer::printFromFile(String filename, Print &printer)
@@ -164,8 +339,24 @@ void FsBuffer::begin(int pin_CS_microSD, uint32_t bytesPerFile, uint8_t filesQua
         ESP_LOGI("*", "Se encontró una micro-SD, se grabarán Info y Errores");
     }
 
+    if (microSDExists)
+        begin(SD, true, bytesPerFile, filesQuantity, folder);
+    else
+        begin(SPIFFS, false, bytesPerFile, filesQuantity, folder);
+}
+
+/**
+     * Igual que el otro begin(), pero con un file system que ya esta montado.
+     */
+void FsBuffer::begin(fs::FS &fs, bool isMicroSD, uint32_t bytesPerFile, uint8_t filesQuantity, const String &folder)
+{
+    fileSystem = &fs;
+    microSDExists = isMicroSD;
+
     fileSystemError = false;
     filesCount = filesQuantity;
+    delete[] lineIndex;
+    lineIndex = new FsBufferIndex[filesCount];
     maxFileSize = bytesPerFile;
     baseFilename = folder;
     cfgFileName = folder + CONFIG_FILENAME;
@@ -173,41 +364,68 @@ void FsBuffer::begin(int pin_CS_microSD, uint32_t bytesPerFile, uint8_t filesQua
     initFile();
 }
 
-inline size_t FsBuffer::write(uint8_t c)
+size_t FsBuffer::write(uint8_t c)
 {
     return write(&c, 1);
 }
 
-inline size_t FsBuffer::write(const uint8_t *txt)
+size_t FsBuffer::write(const uint8_t *txt)
 {
     return write(txt, strlen((char *)txt));
 }
 
 /**
      * Agrega texto al archivo actual.
+     * El archivo queda abierto, y el tamaño se lleva en RAM.
      * Si se excede el tamaño máximo, sigue con otro archivo.
+     * El flush se hace segun la politica de setSyncPolicy() (o a mano con sync()).
      */
-inline size_t FsBuffer::write(const uint8_t *txt, size_t len)
+size_t FsBuffer::write(const uint8_t *txt, size_t len)
 {
     if (fileSystemError)
         return 0;
 
-    size_t size = 0;
-    File f = open(bufFileName, FILE_APPEND);
-    if (f)
-    {
-        size = f.write(txt, len);
-        f.flush();
-        int filesize = f.size();
-        f.close();
-        // si se excede el tamaño del archivo, cambia a siguiente.
-        if (filesize > maxFileSize)
-            nextFile();
-        storeConfig();
-    }
+    PERF_SCOPE("fs.write");
+    TRACE_SCOPE("fs.write");
+
+    if (!bufFile)
+        openBufFile();
+    if (!bufFile)
+        return 0;
+
+    size_t size = bufFile.write(txt, len);
+    bufFileSize += size;
+    pendingBytes += size;
+    lineIndex[fileIndexActual].feed(txt, size);
+
+    // si se excede el tamaño del archivo, cambia a siguiente (al cerrar se hace el flush).
+    if (bufFileSize > maxFileSize)
+        nextFile();
+    else if (size != len || pendingBytes >= syncBytes || millis() - lastSync >= syncMillis)
+        sync();
+
     return size;
 }
 
+/**
+     * Configura cada cuantos bytes o milisegundos se baja el archivo a disco.
+     * Con (0, 0) se hace flush en cada write (como antes).
+     */
+void FsBuffer::setSyncPolicy(uint32_t bytes, uint32_t millis)
+{
+    syncBytes = bytes;
+    syncMillis = millis;
+}
+
+// baja a disco lo pendiente del archivo actual.
+void FsBuffer::sync()
+{
+    if (bufFile && pendingBytes > 0)
+        bufFile.flush();
+    pendingBytes = 0;
+    lastSync = millis();
+}
+
 /**
      * Envía todos los archivos al Printable que sea...(otro stream)
      */
@@ -216,6 +434,8 @@ void FsBuffer::printTo(Print &printer)
     if (fileSystemError)
         return;
 
+    sync(); // para que se lea lo ultimo que se escribio
+
     // Ejemplo: 2-3-0-1
     // (si el actual es el 2, empiezo con el 3 (el mas viejo) y sigo en forma circular)
     int index = fileIndexActual;
@@ -228,48 +448,118 @@ void FsBuffer::printTo(Print &printer)
 }
 
 // abre un archivo, y por cada linea llama el callback.
-void FsBuffer::forEachLineFromFile(String filename, ForEachLineCallback callback)
+void FsBuffer::forEachLineFromFile(String filename, ForEachLineCallback callback, void *ctx)
 {
     File f = open(filename, FILE_READ);
     if (f)
     {
-        String line;
-        do
-        {
-            line = f.readStringUntil('\n');
-            callback(line);
-        } while (!line.isEmpty());
+        scanLines(f, 0, UINT32_MAX, callback, ctx);
         f.close();
     }
 }
 
 // por cada archivo llama a recorrer las lineas...
-void FsBuffer::forEachLine(ForEachLineCallback callback)
+void FsBuffer::forEachLine(ForEachLineCallback callback, void *ctx)
 {
     if (fileSystemError)
         return;
 
+    sync(); // para que se lea lo ultimo que se escribio
+
     // Ejemplo: 2-3-0-1
     // (si el actual es el 2, empiezo con el 3 (el mas viejo) y sigo en forma circular)
     int index = fileIndexActual;
     do
     {
-        forEachLineFromFile(getFileName(index), callback);
+        forEachLineFromFile(getFileName(index), callback, ctx);
         if (++index == filesCount)
             index = 0;
     } while (index != fileIndexActual);
 }
 
+/**
+ * Recorre hasta count lineas empezando por la de numero de secuencia seq
+ * (si ya no existe, empieza por la mas vieja que haya).
+ * Usa los indices para ir directo a la linea, sin leer los archivos desde el principio.
+ * Devuelve el numero de secuencia siguiente a la ultima linea que se paso al callback
+ * (para pedir la proxima pagina, o consultar lo nuevo desde ahi).
+ * Con callback == nullptr no lee los archivos, solo devuelve hasta donde llegaria segun los indices.
+ */
+uint32_t FsBuffer::forEachLineFrom(uint32_t seq, uint32_t count, ForEachLineCallback callback, void *ctx)
+{
+    if (fileSystemError)
+        return seq;
+
+    sync(); // para que se lea lo ultimo que se escribio (el indice ya lo cuenta)
+
+    uint32_t segSeq = firstSeq();
+    seq = max(seq, segSeq);
+
+    // empiezo por el mas viejo (el siguiente al actual) y sigo en forma circular
+    int index = fileIndexActual;
+    for (int i = 0; i < filesCount && count > 0; i++)
+    {
+        if (++index == filesCount)
+            index = 0;
+
+        FsBufferIndex &idx = getIndex(index);
+        if (seq < segSeq + idx.lines)
+        {
+            uint32_t line = seq - segSeq;
+            uint32_t n = min(count, idx.lines - line);
+            uint16_t k = min(line / idx.step, (uint32_t)idx.count - 1);
+            uint32_t done = n;
+            if (callback != nullptr)
+                done = readLines(getFileName(index), idx.offsets[k], line - k * idx.step, n, callback, ctx);
+            seq += done;
+            count -= done;
+            if (done < n)
+                break; // el archivo tenia menos de lo que dice el indice: se sigue desde aca la proxima
+        }
+        segSeq += idx.lines;
+    }
+    return min(seq, nextSeq());
+}
+
+// numero de secuencia de la linea mas vieja que hay
+uint32_t FsBuffer::firstSeq()
+{
+    if (fileSystemError)
+        return 0;
+
+    // voy para atras desde el archivo actual
+    uint32_t seq = seqInicial;
+    int index = fileIndexActual;
+    for (int i = 1; i < filesCount; i++)
+    {
+        index = index == 0 ? filesCount - 1 : index - 1;
+        uint32_t lines = getIndex(index).lines;
+        seq = seq > lines ? seq - lines : 0;
+    }
+    return seq;
+}
+
+// numero de secuencia que va a tener la proxima linea
+uint32_t FsBuffer::nextSeq()
+{
+    if (fileSystemError)
+        return 0;
+    return seqInicial + getIndex(fileIndexActual).lines;
+}
+
 // elimina todos los archivos!
 void FsBuffer::clear()
 {
     if (fileSystemError)
         return;
 
+    closeBufFile();
+    seqInicial = nextSeq(); // la secuencia sigue (por si alguien consulta lo nuevo)
     for (size_t i = 0; i < filesCount; i++)
     {
         bufFileName = getFileName(i);
         remove(bufFileName);
+        lineIndex[i].reset();
     }
     fileIndexActual = 0;
     storeConfig();
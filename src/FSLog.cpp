@@ -10,6 +10,10 @@
 */
 
 #include "FSLog.h"
+#include "FSLogRecord.h"
+#include "PerfStats.h"
+#include "Trace.h"
+#include <esp_system.h>
 
 //-- unica instancia para todo el proyecto...
 FsLog FSLOG;
@@ -20,12 +24,58 @@ FsLog FSLOG;
 constexpr char STARTUP_FILENAME[] = "/startup.log";
 constexpr char NotInitialized[] = "FsLog class not initialized";
 
+// bloque maximo que se baja al FS de una vez
+#define FSLOG_DRAIN_BLOCK 512
+
+// si la cola pasa este nivel se despierta la tarea de flush
+#define FSLOG_RING_WAKEUP (FSLOG_RING_SIZE / 2)
+
+// cada cuanto la tarea de flush revisa la cola aunque nadie la despierte
+#define FSLOG_FLUSH_PERIOD_MS 500
+
+static portMUX_TYPE ringMux = portMUX_INITIALIZER_UNLOCKED;
+
+// formatea sin pasarse de buf; si no entra se corta, pero sigue terminando en '\n'
+static size_t formatLine(char *buf, size_t size, const char *format, va_list args)
+{
+    int n = vsnprintf(buf, size, format, args);
+    if (n < 0)
+    {
+        buf[0] = 0;
+        return 0;
+    }
+    if ((size_t)n >= size)
+    {
+        n = size - 1;
+        buf[n - 1] = '\n';
+    }
+    return n;
+}
+
 void FsLog::begin(int pin_CS_microSD, HardwareSerial &out, uint32_t bytesPerFile)
+{
+    if (!initialized)
+        FsBuffer::begin(pin_CS_microSD, bytesPerFile, 4, folder);
+    start(out);
+}
+
+void FsLog::begin(fs::FS &fs, bool isMicroSD, HardwareSerial &out, uint32_t bytesPerFile)
+{
+    if (!initialized)
+        FsBuffer::begin(fs, isMicroSD, bytesPerFile, 4, folder);
+    start(out);
+}
+
+// lo que sigue a FsBuffer::begin() en los dos begin()
+void FsLog::start(HardwareSerial &out)
 {
     output = &out;
     if (!initialized)
     {
-        FsBuffer::begin(pin_CS_microSD, bytesPerFile, 4, folder);
+        fsMutex = xSemaphoreCreateMutex();
+        xTaskCreate(flushTaskLoop, "fslog", 3072, this, tskIDLE_PRIORITY + 1, &flushTask);
+        esp_register_shutdown_handler([]()
+                                      { FSLOG.flush(); }); // si hay un esp_restart() no pierdo lo encolado
         initialized = true;
     }
     startupLogFileName = folder + STARTUP_FILENAME;
@@ -47,12 +97,12 @@ void FsLog::startup(const char *format, ...)
     va_list argptr;
     char buf[TAM_BUF];
     va_start(argptr, format);
-    vsprintf(buf, format, argptr);
+    size_t len = formatLine(buf, sizeof(buf), format, argptr);
 
     File f = open(startupLogFileName, FILE_APPEND);
     if (f)
     {
-        f.write((uint8_t *)buf, strlen(buf));
+        f.write((uint8_t *)buf, len);
         f.close();
     }
     else
@@ -68,9 +118,9 @@ void FsLog::printStartupTo(Print &printer)
     printFromFile(startupLogFileName, printer);
 }
 
-void FsLog::forEachStartup(ForEachLineCallback callback)
+void FsLog::forEachStartup(ForEachLineCallback callback, void *ctx)
 {
-    forEachLineFromFile(startupLogFileName, callback);
+    forEachLineFromFile(startupLogFileName, callback, ctx);
 }
 
 /**
@@ -80,40 +130,315 @@ void FsLog::forEachStartup(ForEachLineCallback callback)
  * LogDebug => solo Serie
  * LogInfo  => Serie y en la micro-SD (si existe)
  * LogError => Serie y en el FS que exista (microSD o ESP flash)
+ *
+ * El nivel lo pasan las macros (es constante en cada llamada), ver toSerial() y toFile().
  */
-void FsLog::log(const char *format, ...)
+void FsLog::log(FsLogNivel nivel, const char *format, ...)
 {
     if (!initialized)
         throw NotInitialized;
 
+    PERF_SCOPE("log");
+    TRACE_SCOPE("log");
+
+    bool serie = toSerial(nivel);
+    bool archivo = toFile(nivel);
+
     va_list argptr;
+
+#ifdef FSLOG_BINARIO
+    // el texto solo se arma si sale por el puerto serie, al archivo va el registro binario.
+    if (serie)
+    {
+        char buf[TAM_BUF];
+        va_start(argptr, format);
+        vsnprintf(buf, sizeof(buf), format, argptr);
+        va_end(argptr);
+        output->print(buf);
+    }
+    if (archivo)
+    {
+        char rec[2 * TAM_BUF]; // peor caso: todo escapado
+        va_start(argptr, format);
+        size_t len = FsLogEncode(rec, sizeof(rec), format, argptr);
+        va_end(argptr);
+        enqueue(rec, len);
+    }
+#else
+    if (!serie && !archivo)
+        return;
+
     char buf[TAM_BUF];
     va_start(argptr, format);
-    vsprintf(buf, format, argptr);
-    int len = strlen(buf);
+    size_t len = formatLine(buf, sizeof(buf), format, argptr);
+    va_end(argptr);
 
-    // todo sale por el puerto serie...salvo que no este el ModoDiagnostico
-    if (format[1] == 'D' || format[1] == 'I' || format[1] == 'E' ||
-        (format[1] == 'T' && modoDiagnostico) ||
-        (format[1] == 'V' && modoDiagnostico))
-    {
+    if (serie)
         output->print(buf);
+    if (archivo)
+        enqueue(buf, len);
+#endif
+
+    // los errores se bajan a disco enseguida (por si hay un reset),
+    // junto con todo lo anterior para que queden en orden.
+    if (archivo && nivel == FsLogNivel::Error)
+        flush();
+}
+
+/**
+ * Encola una linea en la RAM. Si no hay lugar descarta las lineas mas viejas.
+ */
+void FsLog::enqueue(const char *line, size_t len)
+{
+    if (len > FSLOG_RING_SIZE)
+        len = FSLOG_RING_SIZE; // no deberia pasar nunca (TAM_BUF es mucho menor)
+
+    portENTER_CRITICAL(&ringMux);
+
+    // descarto las lineas mas viejas hasta que entre la nueva
+    while (FSLOG_RING_SIZE - ringUsed < len)
+    {
+        size_t n = oldestLine();
+        ringTail = (ringTail + n) % FSLOG_RING_SIZE;
+        ringUsed -= n;
+        droppedLines++;
     }
 
-    // algunas cosas se graban...y verifica el ModoDiagnostico
-    if (format[1] == 'E' ||
-        (microSDExists && format[1] == 'I') ||
-        (microSDExists && modoDiagnostico && format[1] == 'V'))
+    size_t first = min(len, (size_t)(FSLOG_RING_SIZE - ringHead));
+    memcpy(ring + ringHead, line, first);
+    memcpy(ring, line + first, len - first);
+    ringHead = (ringHead + len) % FSLOG_RING_SIZE;
+    ringUsed += len;
+    bool wakeup = ringUsed >= FSLOG_RING_WAKEUP;
+
+    portEXIT_CRITICAL(&ringMux);
+
+    if (wakeup && flushTask)
+        xTaskNotifyGive(flushTask);
+}
+
+// se llama en la seccion critica: a lo sumo dos memchr (la cola puede dar la vuelta)
+size_t FsLog::oldestLine() const
+{
+    size_t first = min(ringUsed, (size_t)(FSLOG_RING_SIZE - ringTail));
+    const char *nl = (const char *)memchr(ring + ringTail, '\n', first);
+    if (nl != nullptr)
+        return nl - (ring + ringTail) + 1;
+    nl = (const char *)memchr(ring, '\n', ringUsed - first);
+    return nl != nullptr ? first + (nl - ring) + 1 : ringUsed;
+}
+
+/**
+ * Baja la cola al FsBuffer en bloques grandes, siempre cortando en un fin de linea
+ * (asi una linea nunca queda partida entre dos archivos).
+ * Se llama con el fsMutex tomado.
+ */
+void FsLog::drain()
+{
+    TRACE_SCOPE("log drain");
+
+    char block[FSLOG_DRAIN_BLOCK];
+    for (;;)
     {
-        write((uint8_t *)buf, len);
+        portENTER_CRITICAL(&ringMux);
+        size_t avail = min(ringUsed, (size_t)FSLOG_DRAIN_BLOCK);
+        size_t first = min(avail, (size_t)(FSLOG_RING_SIZE - ringTail));
+        memcpy(block, ring + ringTail, first);
+        memcpy(block + first, ring, avail - first);
+        // la cola termina en '\n'; si no entro toda, se corta en la ultima linea completa del bloque
+        size_t n = avail;
+        if (avail < ringUsed)
+        {
+            while (n > 0 && block[n - 1] != '\n')
+                n--;
+            if (n == 0)
+                n = avail; // una linea mas larga que el bloque (no deberia pasar)
+        }
+        ringTail = (ringTail + n) % FSLOG_RING_SIZE;
+        ringUsed -= n;
+        portEXIT_CRITICAL(&ringMux);
+
+        if (n == 0)
+            return;
+        FsBuffer::write((uint8_t *)block, n);
     }
+}
 
-    va_end(argptr);
+// baja al FS todo lo que esta en la cola (bloqueante)
+void FsLog::flush()
+{
+    if (!initialized)
+        return;
+
+    TRACE_SCOPE("log flush");
+
+    xSemaphoreTake(fsMutex, portMAX_DELAY);
+    drain();
+    sync();
+    xSemaphoreGive(fsMutex);
+}
+
+size_t FsLog::write(uint8_t c)
+{
+    return write(&c, 1);
+}
+
+size_t FsLog::write(const uint8_t *txt)
+{
+    return write(txt, strlen((const char *)txt));
+}
+
+// lo que ya estaba en la cola va antes
+size_t FsLog::write(const uint8_t *txt, size_t len)
+{
+    if (!initialized)
+        return FsBuffer::write(txt, len);
+
+    xSemaphoreTake(fsMutex, portMAX_DELAY);
+    drain();
+    size_t n = FsBuffer::write(txt, len);
+    xSemaphoreGive(fsMutex);
+    return n;
+}
+
+void FsLog::clear()
+{
+    if (!initialized)
+        return FsBuffer::clear();
+
+    xSemaphoreTake(fsMutex, portMAX_DELAY);
+    portENTER_CRITICAL(&ringMux);
+    ringHead = ringTail = ringUsed = 0;
+    portEXIT_CRITICAL(&ringMux);
+    FsBuffer::clear();
+    xSemaphoreGive(fsMutex);
+}
+
+// tarea de baja prioridad que vacia la cola
+void FsLog::flushTaskLoop(void *param)
+{
+    FsLog *self = (FsLog *)param;
+    for (;;)
+    {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(FSLOG_FLUSH_PERIOD_MS));
+        xSemaphoreTake(self->fsMutex, portMAX_DELAY);
+        self->drain();
+        xSemaphoreGive(self->fsMutex);
+    }
+}
+
+#ifdef FSLOG_BINARIO
+// a quien se le pasan las lineas ya convertidas a texto
+struct RenderCtx
+{
+    ForEachLineCallback callback;
+    void *ctx;
+};
+
+// convierte los registros binarios en texto, las lineas de texto pasan igual.
+static void renderToCallback(const char *line, size_t len, void *ctx)
+{
+    RenderCtx *render = (RenderCtx *)ctx;
+    if (!FsLogIsRecord(line, len))
+        return render->callback(line, len, render->ctx);
+
+    char buf[TAM_BUF];
+    len = FsLogRender(line, len, buf, sizeof(buf));
+    if (len == 0)
+    {
+        strcpy(buf, "[?]: registro de log invalido (otro firmware?)");
+        len = strlen(buf);
+    }
+    else if (buf[len - 1] == '\n')
+        buf[--len] = 0; // las lineas se pasan sin el '\n'
+    render->callback(buf, len, render->ctx);
+}
+
+static void printLine(const char *line, size_t len, void *ctx)
+{
+    Print *printer = (Print *)ctx;
+    printer->write((const uint8_t *)line, len);
+    printer->write('\n');
+}
+#endif
+
+void FsLog::printTo(Print &printer)
+{
+    if (!initialized)
+        return;
+
+    xSemaphoreTake(fsMutex, portMAX_DELAY);
+    drain();
+#ifdef FSLOG_BINARIO
+    RenderCtx render = {printLine, &printer};
+    FsBuffer::forEachLine(renderToCallback, &render);
+#else
+    FsBuffer::printTo(printer);
+#endif
+    xSemaphoreGive(fsMutex);
+}
+
+void FsLog::forEachLine(ForEachLineCallback callback, void *ctx)
+{
+    if (!initialized)
+        return;
+
+    xSemaphoreTake(fsMutex, portMAX_DELAY);
+    drain();
+#ifdef FSLOG_BINARIO
+    RenderCtx render = {callback, ctx};
+    FsBuffer::forEachLine(renderToCallback, &render);
+#else
+    FsBuffer::forEachLine(callback, ctx);
+#endif
+    xSemaphoreGive(fsMutex);
+}
+
+// recorre desde la linea seq (ver FsBuffer::forEachLineFrom)
+uint32_t FsLog::forEachLineFrom(uint32_t seq, uint32_t count, ForEachLineCallback callback, void *ctx)
+{
+    if (!initialized)
+        return seq;
+
+    xSemaphoreTake(fsMutex, portMAX_DELAY);
+    drain();
+#ifdef FSLOG_BINARIO
+    RenderCtx render = {callback, ctx};
+    seq = FsBuffer::forEachLineFrom(seq, count, callback ? renderToCallback : nullptr, &render);
+#else
+    seq = FsBuffer::forEachLineFrom(seq, count, callback, ctx);
+#endif
+    xSemaphoreGive(fsMutex);
+    return seq;
+}
+
+uint32_t FsLog::firstSeq()
+{
+    if (!initialized)
+        return 0;
+
+    xSemaphoreTake(fsMutex, portMAX_DELAY);
+    uint32_t seq = FsBuffer::firstSeq();
+    xSemaphoreGive(fsMutex);
+    return seq;
+}
+
+uint32_t FsLog::nextSeq()
+{
+    if (!initialized)
+        return 0;
+
+    xSemaphoreTake(fsMutex, portMAX_DELAY);
+    drain();
+    uint32_t seq = FsBuffer::nextSeq();
+    xSemaphoreGive(fsMutex);
+    return seq;
 }
 
 String FsLog::getStatus()
 {
     return String("micro-SD ") + (microSDExists ? "Exists" : "NOT Exists") +
            String(", modoDiagnostico=") + (modoDiagnostico ? "on" : "off") +
+           String(", lineas descartadas=") + droppedLines +
            "\nstartupLogFileName=" + startupLogFileName;
 }
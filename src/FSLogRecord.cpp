@@ -0,0 +1,379 @@
+/*
+    FsLogRecord.cpp
+    Codificacion y decodificacion de los registros binarios de log.
+    Ver FSLogRecord.h
+
+    JJTeam - 2021
+*/
+
+#include "FSLogRecord.h"
+#include <soc/soc.h>
+
+// tamaño maximo del registro sin escapar
+#define FSLOG_REC_RAW 200
+
+// un especificador de formato: %[flags][ancho][.precision][largo]conversion
+struct FsLogSpec
+{
+    const char *start; // apunta al '%'
+    size_t len;        // largo total del especificador
+    char conv;         // conversion ('d', 's', 'f', ...) o 0 si el formato esta cortado
+    uint8_t stars;     // ancho y/o precision pasados como argumento ('*')
+    uint8_t longs;     // 2 o mas => argumento de 64 bits
+    bool sized;        // 'z' o 't' (size_t, ptrdiff_t)
+};
+
+// parsea el especificador que empieza en p (el '%'). Devuelve el puntero a la conversion.
+static const char *parseSpec(const char *p, FsLogSpec &spec)
+{
+    spec.start = p;
+    spec.stars = 0;
+    spec.longs = 0;
+    spec.sized = false;
+    p++;
+    while (*p && strchr("-+ #0", *p))
+        p++;
+    if (*p == '*')
+    {
+        spec.stars++;
+        p++;
+    }
+    while (isdigit(*p))
+        p++;
+    if (*p == '.')
+    {
+        p++;
+        if (*p == '*')
+        {
+            spec.stars++;
+            p++;
+        }
+        while (isdigit(*p))
+            p++;
+    }
+    while (*p && strchr("hlLqjzt", *p))
+    {
+        if (*p == 'l')
+            spec.longs++;
+        else if (*p == 'q' || *p == 'j')
+            spec.longs += 2;
+        else if (*p == 'z' || *p == 't')
+            spec.sized = true;
+        p++;
+    }
+    spec.conv = *p;
+    spec.len = p - spec.start + (*p ? 1 : 0);
+    return *p ? p : p - 1;
+}
+
+static bool isFloatConv(char c)
+{
+    return c && strchr("fFeEgGaA", c);
+}
+
+// bytes que ocupa en el registro un argumento entero (o puntero): lo mismo que en el va_list.
+// En el ESP32 todo es de 4 bytes salvo los long long; en la PC (64 bits) tambien long, size_t y punteros.
+static size_t intSize(const FsLogSpec &spec)
+{
+    if (spec.conv == 'p')
+        return sizeof(void *);
+    if (spec.longs >= 2)
+        return sizeof(long long);
+    if (spec.longs == 1)
+        return sizeof(long);
+    if (spec.sized)
+        return sizeof(size_t);
+    return sizeof(int);
+}
+
+// el id del formato que se guarda en el registro (32 bits).
+// En el ESP32 es la direccion del string en la flash; en la PC, donde las direcciones son de 64 bits,
+// la distancia al principio del ejecutable (alcanza: mientras no cambie el programa es la misma).
+#ifdef ESP_PLATFORM
+static uint32_t formatId(const char *format)
+{
+    return (uint32_t)format;
+}
+
+// el string de formato tiene que estar en la flash (si el registro es de otro firmware puede ser basura)
+static const char *formatFromId(uint32_t id)
+{
+    return id >= SOC_DROM_LOW && id < SOC_DROM_HIGH ? (const char *)id : nullptr;
+}
+#else
+extern "C" const char __executable_start[];
+extern "C" const char _end[];
+
+static uint32_t formatId(const char *format)
+{
+    return (uint32_t)(format - __executable_start);
+}
+
+static const char *formatFromId(uint32_t id)
+{
+    return id < (uintptr_t)(_end - __executable_start) ? __executable_start + id : nullptr;
+}
+#endif
+
+//----------------------------------------------------------------------------
+
+// escribe el registro crudo; si algo no entra deja de escribir (se cortan los ultimos argumentos)
+class RecWriter
+{
+public:
+    char data[FSLOG_REC_RAW];
+    size_t len = 0;
+    bool full = false;
+
+    void put(const void *d, size_t n)
+    {
+        if (full || len + n > sizeof(data))
+        {
+            full = true;
+            return;
+        }
+        memcpy(data + len, d, n);
+        len += n;
+    }
+    void putString(const char *s)
+    {
+        if (s == nullptr)
+            s = "(null)";
+        size_t n = strnlen(s, FSLOG_REC_MAX_STR);
+        if (full || len + n + 1 > sizeof(data))
+        {
+            full = true;
+            return;
+        }
+        memcpy(data + len, s, n);
+        data[len + n] = 0;
+        len += n + 1;
+    }
+};
+
+size_t FsLogEncode(char *out, size_t size, const char *format, va_list args)
+{
+    RecWriter rec;
+    uint32_t value = formatId(format);
+    rec.put(&value, 4);
+    value = millis();
+    rec.put(&value, 4);
+
+    for (const char *p = format; *p && !rec.full; p++)
+    {
+        if (*p != '%')
+            continue;
+
+        FsLogSpec spec;
+        p = parseSpec(p, spec);
+        if (spec.conv == '%' || spec.conv == 0)
+            continue;
+
+        for (int i = 0; i < spec.stars; i++)
+        {
+            int star = va_arg(args, int);
+            rec.put(&star, 4);
+        }
+
+        if (spec.conv == 's')
+        {
+            rec.putString(va_arg(args, const char *));
+        }
+        else if (isFloatConv(spec.conv))
+        {
+            double d = va_arg(args, double);
+            rec.put(&d, 8);
+        }
+        else if (spec.conv == 'n')
+        {
+            va_arg(args, void *); // no se soporta, se descarta
+        }
+        else
+        {
+            // cada uno con su tipo, y se guardan los intSize() bytes de abajo (little endian)
+            uint64_t i;
+            if (spec.conv == 'p')
+                i = (uintptr_t)va_arg(args, void *);
+            else if (spec.longs >= 2)
+                i = va_arg(args, unsigned long long);
+            else if (spec.longs == 1)
+                i = va_arg(args, unsigned long);
+            else if (spec.sized)
+                i = va_arg(args, size_t);
+            else
+                i = va_arg(args, unsigned int); // char y short tambien llegan como int
+            rec.put(&i, intSize(spec));
+        }
+    }
+
+    // escapo y armo la linea: MARK + datos + '\n'
+    size_t n = 0;
+    if (size < 2)
+        return 0;
+    out[n++] = FSLOG_REC_MARK;
+    for (size_t i = 0; i < rec.len; i++)
+    {
+        char c = rec.data[i];
+        bool esc = c == '\n' || c == 0 || c == FSLOG_REC_ESC;
+        if (n + (esc ? 2 : 1) + 1 > size)
+            break;
+        if (esc)
+        {
+            out[n++] = FSLOG_REC_ESC;
+            c ^= FSLOG_REC_XOR;
+        }
+        out[n++] = c;
+    }
+    out[n++] = '\n';
+    return n;
+}
+
+//----------------------------------------------------------------------------
+
+// lee el registro crudo; si faltan datos marca ok=false
+class RecReader
+{
+public:
+    const char *data;
+    size_t len;
+    size_t pos = 0;
+    bool ok = true;
+
+    RecReader(const char *d, size_t l) : data(d), len(l) {}
+
+    void get(void *d, size_t n)
+    {
+        if (!ok || pos + n > len)
+        {
+            ok = false;
+            return;
+        }
+        memcpy(d, data + pos, n);
+        pos += n;
+    }
+    const char *getString()
+    {
+        const char *s = data + pos;
+        size_t n = ok ? strnlen(s, len - pos) : 0;
+        if (!ok || pos + n >= len)
+        {
+            ok = false;
+            return "";
+        }
+        pos += n + 1;
+        return s;
+    }
+};
+
+template <typename T>
+static int renderArg(char *out, size_t size, const char *fmt, const int *stars, uint8_t nstars, T value)
+{
+    switch (nstars)
+    {
+    case 0:
+        return snprintf(out, size, fmt, value);
+    case 1:
+        return snprintf(out, size, fmt, stars[0], value);
+    default:
+        return snprintf(out, size, fmt, stars[0], stars[1], value);
+    }
+}
+
+size_t FsLogRender(const char *line, size_t len, char *out, size_t size, uint32_t *timestamp)
+{
+    if (!FsLogIsRecord(line, len) || size == 0)
+        return 0;
+
+    // saco los escapes
+    char raw[FSLOG_REC_RAW];
+    size_t rawLen = 0;
+    for (size_t i = 1; i < len && line[i] != '\n' && rawLen < sizeof(raw); i++)
+    {
+        char c = line[i];
+        if (c == FSLOG_REC_ESC && i + 1 < len)
+            c = line[++i] ^ FSLOG_REC_XOR;
+        raw[rawLen++] = c;
+    }
+
+    RecReader rec(raw, rawLen);
+    uint32_t id, ms;
+    rec.get(&id, 4);
+    rec.get(&ms, 4);
+    const char *format = rec.ok ? formatFromId(id) : nullptr;
+    if (format == nullptr)
+        return 0;
+    if (timestamp)
+        *timestamp = ms;
+
+    size_t n = 0;
+    for (const char *p = format; *p && n + 1 < size; p++)
+    {
+        if (*p != '%')
+        {
+            out[n++] = *p;
+            continue;
+        }
+
+        FsLogSpec spec;
+        p = parseSpec(p, spec);
+        if (spec.conv == 0)
+            break;
+        if (spec.conv == '%')
+        {
+            out[n++] = '%';
+            continue;
+        }
+        if (spec.conv == 'n')
+            continue;
+
+        char fmt[16];
+        if (spec.len >= sizeof(fmt))
+            continue;
+        memcpy(fmt, spec.start, spec.len);
+        fmt[spec.len] = 0;
+
+        int stars[2] = {0, 0};
+        for (int i = 0; i < spec.stars && i < 2; i++)
+            rec.get(&stars[i], 4);
+
+        int w;
+        if (spec.conv == 's')
+        {
+            const char *s = rec.getString();
+            w = rec.ok ? renderArg(out + n, size - n, fmt, stars, spec.stars, s) : 0;
+        }
+        else if (isFloatConv(spec.conv))
+        {
+            double d;
+            rec.get(&d, 8);
+            w = rec.ok ? renderArg(out + n, size - n, fmt, stars, spec.stars, d) : 0;
+        }
+        else
+        {
+            uint64_t i = 0;
+            rec.get(&i, intSize(spec));
+            if (!rec.ok)
+                w = 0;
+            else if (spec.conv == 'p')
+                w = renderArg(out + n, size - n, fmt, stars, spec.stars, (void *)(uintptr_t)i);
+            else if (spec.longs >= 2)
+                w = renderArg(out + n, size - n, fmt, stars, spec.stars, (unsigned long long)i);
+            else if (spec.longs == 1)
+                w = renderArg(out + n, size - n, fmt, stars, spec.stars, (unsigned long)i);
+            else if (spec.sized)
+                w = renderArg(out + n, size - n, fmt, stars, spec.stars, (size_t)i);
+            else
+                w = renderArg(out + n, size - n, fmt, stars, spec.stars, (unsigned int)i);
+        }
+
+        if (!rec.ok)
+        {
+            out[n++] = '?'; // el registro se corto al grabarlo
+            continue;
+        }
+        if (w > 0)
+            n += min((size_t)w, size - n - 1);
+    }
+    out[n] = 0;
+    return n;
+}
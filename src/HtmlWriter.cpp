@@ -0,0 +1,164 @@
+/*
+    HtmlWriter.cpp
+    Ver HtmlWriter.h
+
+    JJTeam - 2021
+*/
+
+#include "HtmlWriter.h"
+
+void HtmlWriter::begin(int code, const char *contentType)
+{
+    server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+    server.send(code, contentType, "");
+    started = true;
+}
+
+void HtmlWriter::flush()
+{
+    if (len == 0)
+        return;
+    server.sendContent_P(buffer, len);
+    len = 0;
+}
+
+void HtmlWriter::end()
+{
+    if (!started)
+        return;
+    flush();
+    server.sendContent(""); // END CHUNK!
+    started = false;
+}
+
+size_t HtmlWriter::write(uint8_t c)
+{
+    if (len == HTML_WRITER_SIZE)
+        flush();
+    buffer[len++] = c;
+    return 1;
+}
+
+size_t HtmlWriter::write(const uint8_t *data, size_t size)
+{
+    size_t total = size;
+    while (size > 0)
+    {
+        if (len == HTML_WRITER_SIZE)
+            flush();
+        size_t n = min(size, HTML_WRITER_SIZE - len);
+        memcpy(buffer + len, data, n);
+        len += n;
+        data += n;
+        size -= n;
+    }
+    return total;
+}
+
+HtmlWriter &HtmlWriter::text(const char *s)
+{
+    write((const uint8_t *)s, strlen(s));
+    return *this;
+}
+
+HtmlWriter &HtmlWriter::escaped(const char *s)
+{
+    return escaped(s, strlen(s));
+}
+
+HtmlWriter &HtmlWriter::escaped(const char *s, size_t size)
+{
+    for (size_t i = 0; i < size; i++)
+    {
+        switch (s[i])
+        {
+        case '<':
+            text("&lt;");
+            break;
+        case '>':
+            text("&gt;");
+            break;
+        case '&':
+            text("&amp;");
+            break;
+        case '"':
+            text("&quot;");
+            break;
+        case '\'':
+            text("&#39;");
+            break;
+        default:
+            write((uint8_t)s[i]);
+        }
+    }
+    return *this;
+}
+
+HtmlWriter &HtmlWriter::open(const char *tag, const char *classs)
+{
+    write('<');
+    text(tag);
+    if (classs && *classs)
+        text(" class=\"").text(classs).write('"');
+    write('>');
+    return *this;
+}
+
+HtmlWriter &HtmlWriter::close(const char *tag)
+{
+    text("</").text(tag).write('>');
+    return *this;
+}
+
+HtmlWriter &HtmlWriter::tag(const char *tag, const char *text, const char *classs)
+{
+    return open(tag, classs).text(text).close(tag);
+}
+
+HtmlWriter &HtmlWriter::option(const char *text, const char *value)
+{
+    this->text("<option value=\"").escaped(value).text("\">").escaped(text).text("</option>");
+    return *this;
+}
+
+HtmlWriter &HtmlWriter::json(const char *s)
+{
+    write('"');
+    for (; *s; s++)
+    {
+        if (*s == '"' || *s == '\\')
+            write('\\');
+        if ((uint8_t)*s < 0x20)
+            printf("\\u%04x", *s);
+        else
+            write((uint8_t)*s);
+    }
+    write('"');
+    return *this;
+}
+
+/**
+ * El printf() de Print pide memoria cuando el texto pasa de 64 bytes (y despues lo copia):
+ * este formatea directo en el buffer. Si no entra en lo que queda, se manda el buffer y se vuelve a formatear.
+ * Lo que no entra ni en el buffer vacio (HTML_WRITER_SIZE) se corta: los textos largos van con text().
+ */
+HtmlWriter &HtmlWriter::printf(const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    va_list copy;
+    va_copy(copy, args);
+    int n = vsnprintf(buffer + len, sizeof(buffer) - len, format, copy);
+    va_end(copy);
+
+    if (n > 0 && (size_t)n < sizeof(buffer) - len)
+        len += n;
+    else if (n > 0)
+    {
+        flush();
+        vsnprintf(buffer, sizeof(buffer), format, args);
+        len = min((size_t)n, (size_t)HTML_WRITER_SIZE);
+    }
+    va_end(args);
+    return *this;
+}
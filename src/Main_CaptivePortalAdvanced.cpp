@@ -6,6 +6,7 @@
 #include "WifiCheck.h"
 #include <Arduino.h>
 #include "FSLog.h"
+#include "MemStats.h"
 
 /*
   Ejemplo tomado de :
@@ -40,6 +41,11 @@ void setup()
 
   LogAtStartUp("idf version:%s", esp_get_idf_version()); //3.10006.210326 (1.0.6)
   LogAtStartUp("start %X", random(0xfff));
+
+  MemStatsHeap heap;
+  MemStatsGet(heap);
+  LogAtStartUp("heap libre %u (minimo %u, bloque mayor %u), %u pedidos al heap, stack libre del loop %u",
+               heap.free, heap.minFree, heap.largest, heap.allocs, MemStatsStackFree(nullptr));
   LogInfo("hola %X", random(0xfff));
   LogError("esto es un error %X", random(0xfff));
 }
@@ -0,0 +1,212 @@
+/*
+    MemStats.cpp
+    Ver MemStats.h
+
+    JJTeam - 2021
+*/
+
+#include "MemStats.h"
+#include <esp_heap_caps.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+struct MemTaskCounters
+{
+    TaskHandle_t task; // solo se compara, nunca se usa
+    uint32_t allocs;
+    uint32_t bytes;
+    // los bloques abiertos de la tarea (solo los toca la tarea duena)
+    uint32_t scopes;     // cuantos hay abiertos
+    uint32_t scopeStart; // heap libre antes del primer pedido del bloque (0 = todavia no pidio)
+    uint32_t scopeMinFree;
+    uint32_t scopeMinLargest;
+};
+
+static MemTaskCounters tasks[MEM_STATS_TASKS + 1]; // la ultima es para el resto de las tareas
+static MemTaskCounters &others = tasks[MEM_STATS_TASKS];
+static uint32_t totalAllocs = 0;
+static uint32_t totalFrees = 0;
+static uint32_t totalBytes = 0;
+
+#ifdef MEM_STATS_HABILITADO
+
+// claim: si la tarea no tiene lugar toma el primero libre (si no, cuenta con el resto)
+static MemTaskCounters &taskCounters(bool claim)
+{
+    TaskHandle_t task = xTaskGetCurrentTaskHandle();
+    for (int i = 0; i < MEM_STATS_TASKS; i++)
+        if (__atomic_load_n(&tasks[i].task, __ATOMIC_RELAXED) == task)
+            return tasks[i];
+    if (!claim)
+        return others;
+    for (int i = 0; i < MEM_STATS_TASKS; i++)
+    {
+        TaskHandle_t empty = nullptr;
+        if (__atomic_compare_exchange_n(&tasks[i].task, &empty, task, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+            return tasks[i];
+    }
+    return others;
+}
+
+static MemTaskCounters *count(size_t size)
+{
+    __atomic_fetch_add(&totalAllocs, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&totalBytes, size, __ATOMIC_RELAXED);
+    if (xTaskGetSchedulerState() == taskSCHEDULER_NOT_STARTED)
+        return nullptr;
+    MemTaskCounters &counters = taskCounters(false);
+    __atomic_fetch_add(&counters.allocs, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&counters.bytes, size, __ATOMIC_RELAXED);
+    return &counters;
+}
+
+// con un bloque abierto: como quedo el heap despues del pedido (size: lo que se pidio, aproximado en realloc).
+// El heap libre es un contador, el bloque mas grande recorre el heap: ese solo en el primer pedido
+// del bloque y despues cada MEM_STATS_LARGEST_EVERY (y al cerrarlo)
+static void sample(MemTaskCounters *counters, size_t size)
+{
+    if (counters == nullptr || counters == &others || counters->scopes == 0)
+        return;
+    uint32_t free = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+    if (counters->scopeStart == 0)
+    {
+        counters->scopeStart = free + size;
+        counters->scopeMinFree = free;
+        counters->scopeMinLargest = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+        return;
+    }
+    counters->scopeMinFree = min(counters->scopeMinFree, free);
+    if (counters->allocs % MEM_STATS_LARGEST_EVERY == 0)
+        counters->scopeMinLargest = min(counters->scopeMinLargest, (uint32_t)heap_caps_get_largest_free_block(MALLOC_CAP_8BIT));
+}
+
+extern "C"
+{
+    void *__real_malloc(size_t size);
+    void *__real_calloc(size_t n, size_t size);
+    void *__real_realloc(void *ptr, size_t size);
+    void __real_free(void *ptr);
+
+    void *__wrap_malloc(size_t size)
+    {
+        MemTaskCounters *counters = count(size);
+        void *p = __real_malloc(size);
+        sample(counters, size);
+        return p;
+    }
+
+    void *__wrap_calloc(size_t n, size_t size)
+    {
+        MemTaskCounters *counters = count(n * size);
+        void *p = __real_calloc(n, size);
+        sample(counters, n * size);
+        return p;
+    }
+
+    void *__wrap_realloc(void *ptr, size_t size)
+    {
+        MemTaskCounters *counters = count(size);
+        void *p = __real_realloc(ptr, size);
+        sample(counters, size);
+        return p;
+    }
+
+    void __wrap_free(void *ptr)
+    {
+        if (ptr != nullptr)
+            __atomic_fetch_add(&totalFrees, 1, __ATOMIC_RELAXED);
+        __real_free(ptr);
+    }
+}
+#endif
+
+void MemStatsTask(uint32_t &allocs, uint32_t &bytes)
+{
+#ifdef MEM_STATS_HABILITADO
+    MemTaskCounters &counters = taskCounters(true);
+    allocs = counters.allocs;
+    bytes = counters.bytes;
+#else
+    allocs = bytes = 0;
+#endif
+}
+
+void MemStatsTaskEnd()
+{
+#ifdef MEM_STATS_HABILITADO
+    MemTaskCounters &counters = taskCounters(false);
+    if (&counters == &others)
+        return;
+    counters.allocs = counters.bytes = 0;
+    counters.scopes = counters.scopeStart = 0;
+    __atomic_store_n(&counters.task, nullptr, __ATOMIC_RELEASE); // recien ahora otra tarea lo puede tomar
+#endif
+}
+
+void MemStatsScopeBegin(MemStatsScope &scope)
+{
+#ifdef MEM_STATS_HABILITADO
+    MemTaskCounters &counters = taskCounters(true);
+    scope.allocs = counters.allocs;
+    scope.bytes = counters.bytes;
+    if (&counters == &others)
+        return;
+    scope.outerStart = counters.scopeStart;
+    scope.outerMinFree = counters.scopeMinFree;
+    scope.outerMinLargest = counters.scopeMinLargest;
+    counters.scopeStart = 0;
+    counters.scopes++;
+#else
+    memset(&scope, 0, sizeof(scope));
+#endif
+}
+
+void MemStatsScopeEnd(MemStatsScope &scope, MemStatsUse &use)
+{
+    memset(&use, 0, sizeof(use));
+#ifdef MEM_STATS_HABILITADO
+    MemTaskCounters &counters = taskCounters(false);
+    use.allocs = counters.allocs - scope.allocs;
+    use.bytes = counters.bytes - scope.bytes;
+    if (&counters == &others || counters.scopes == 0)
+        return;
+    counters.scopes--;
+    if (counters.scopeStart != 0)
+    {
+        counters.scopeMinLargest = min(counters.scopeMinLargest, (uint32_t)heap_caps_get_largest_free_block(MALLOC_CAP_8BIT));
+        use.peak = counters.scopeStart > counters.scopeMinFree ? counters.scopeStart - counters.scopeMinFree : 0;
+        use.largest = counters.scopeMinLargest;
+        // el de afuera ve lo mismo; si no habia pedido, empieza donde empezo este
+        if (scope.outerStart != 0)
+        {
+            counters.scopeStart = scope.outerStart;
+            counters.scopeMinFree = min(counters.scopeMinFree, scope.outerMinFree);
+            counters.scopeMinLargest = min(counters.scopeMinLargest, scope.outerMinLargest);
+        }
+    }
+    else
+    {
+        counters.scopeStart = scope.outerStart;
+        counters.scopeMinFree = scope.outerMinFree;
+        counters.scopeMinLargest = scope.outerMinLargest;
+    }
+#else
+    (void)scope;
+#endif
+}
+
+void MemStatsGet(MemStatsHeap &heap)
+{
+    heap.allocs = totalAllocs;
+    heap.frees = totalFrees;
+    heap.bytes = totalBytes;
+    heap.free = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+    heap.minFree = heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT);
+    heap.largest = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+}
+
+uint32_t MemStatsStackFree(TaskHandle_t task)
+{
+    // en el ESP32 el high water mark ya esta en bytes
+    return uxTaskGetStackHighWaterMark(task);
+}
@@ -0,0 +1,98 @@
+/*
+    PerfStats.cpp
+    Ver PerfStats.h
+
+    JJTeam - 2021
+*/
+
+#include "PerfStats.h"
+#include <freertos/FreeRTOS.h>
+
+static PerfStat stats[PERF_STATS_MAX];
+static int statsCount = 0;
+static portMUX_TYPE statsMux = portMUX_INITIALIZER_UNLOCKED;
+
+PerfStat *PerfStatGet(const char *name)
+{
+    PerfStat *stat = nullptr;
+    portENTER_CRITICAL(&statsMux);
+    for (int i = 0; i < statsCount && stat == nullptr; i++)
+        if (strcmp(stats[i].name, name) == 0)
+            stat = &stats[i];
+    if (stat == nullptr && statsCount < PERF_STATS_MAX)
+    {
+        stat = &stats[statsCount++];
+        memset(stat, 0, sizeof(*stat));
+        stat->name = name;
+    }
+    portEXIT_CRITICAL(&statsMux);
+    return stat;
+}
+
+void PerfStatAdd(PerfStat *stat, uint32_t micros, const MemStatsUse *mem)
+{
+    if (stat == nullptr)
+        return;
+
+    int bucket = 0;
+    for (uint32_t m = micros; m >= 2 && bucket < PERF_STATS_BUCKETS - 1; m >>= 1)
+        bucket++;
+
+    portENTER_CRITICAL(&statsMux);
+    stat->count++;
+    stat->totalMicros += micros;
+    if (micros > stat->maxMicros)
+        stat->maxMicros = micros;
+    stat->buckets[bucket]++;
+    if (mem != nullptr)
+    {
+        stat->allocs += mem->allocs;
+        stat->allocBytes += mem->bytes;
+        stat->peakHeap = max(stat->peakHeap, mem->peak);
+        if (mem->largest > 0 && (stat->minLargest == 0 || mem->largest < stat->minLargest))
+            stat->minLargest = mem->largest;
+    }
+    portEXIT_CRITICAL(&statsMux);
+}
+
+int PerfStatCount()
+{
+    return statsCount;
+}
+
+bool PerfStatCopy(int index, PerfStat &copy)
+{
+    if (index < 0 || index >= statsCount)
+        return false;
+    portENTER_CRITICAL(&statsMux);
+    copy = stats[index];
+    portEXIT_CRITICAL(&statsMux);
+    return true;
+}
+
+uint32_t PerfStatPercentile(const PerfStat &stat, int pct)
+{
+    if (stat.count == 0)
+        return 0;
+    uint64_t target = ((uint64_t)stat.count * pct + 99) / 100; // la medicion que cae en el percentil
+    uint64_t seen = 0;
+    for (int i = 0; i < PERF_STATS_BUCKETS - 1; i++)
+    {
+        seen += stat.buckets[i];
+        if (seen >= target)
+            return min((uint32_t)(2u << i), stat.maxMicros);
+    }
+    return stat.maxMicros;
+}
+
+void PerfStatClear()
+{
+    portENTER_CRITICAL(&statsMux);
+    for (int i = 0; i < statsCount; i++)
+    {
+        const char *name = stats[i].name;
+        memset(&stats[i], 0, sizeof(stats[i]));
+        stats[i].name = name;
+    }
+    portEXIT_CRITICAL(&statsMux);
+}
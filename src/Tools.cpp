@@ -0,0 +1,69 @@
+/*
+    Tools.cpp
+    Ver Tools.h
+
+    JJTeam - 2021
+*/
+
+#include "Tools.h"
+#include "DeviceId.h"
+#include <esp_system.h>
+
+const String getSerialNumber()
+{
+    return DeviceSerial();
+}
+
+const char *getResetReason()
+{
+    switch (esp_reset_reason())
+    {
+    case ESP_RST_POWERON:
+        return "Power on Reset";
+    case ESP_RST_SW:
+        return "Reset via esp_restart";
+    case ESP_RST_PANIC:
+        return "Reset by exception or panic";
+    case ESP_RST_INT_WDT:
+    case ESP_RST_TASK_WDT:
+    case ESP_RST_WDT:
+        return "Reset by watchdog";
+    case ESP_RST_DEEPSLEEP:
+        return "Reset after sleep";
+    case ESP_RST_BROWNOUT:
+        return "Reset by Brownout";
+    case ESP_RST_SDIO:
+        return "Reset over SDIO";
+    default:
+        return "Reset reason can not be determined";
+    }
+}
+
+boolean isIp(const char *str)
+{
+    for (; *str; str++)
+    {
+        if (*str != '.' && (*str < '0' || *str > '9'))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+boolean isIp(const String &str)
+{
+    return isIp(str.c_str());
+}
+
+String toStringIp(IPAddress ip)
+{
+    char buf[IP_STRING_SIZE];
+    return ipToString(ip, buf);
+}
+
+char *ipToString(IPAddress ip, char *buf, size_t size)
+{
+    snprintf(buf, size, "%u.%u.%u.%u", ip[0], ip[1], ip[2], ip[3]);
+    return buf;
+}
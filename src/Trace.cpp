@@ -0,0 +1,286 @@
+/*
+    Trace.cpp
+    Ver Trace.h
+
+    JJTeam - 2021
+*/
+
+#include "Trace.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <esp_ipc.h>
+
+// un evento del anillo (8 bytes)
+struct TraceRecord
+{
+    uint32_t ccount; // contador de ciclos de la CPU que lo grabo
+    uint8_t name;    // indice en names[] (0 = lugar vacio)
+    char phase;      // 'B', 'E' o 'i'
+    uint8_t core;    //
+    uint8_t task;    // indice en tasks[] (TRACE_TASKS = las demas tareas)
+};
+
+struct TraceTask
+{
+    TaskHandle_t task; // solo se compara, nunca se usa (nullptr = libre o terminada)
+    bool ended;        // la tarea termino (TraceTaskEnd), el nombre queda para sus eventos del anillo
+    uint32_t endedAt;  // next al terminar: el lugar se puede volver a usar cuando el anillo dio la vuelta
+    char name[configMAX_TASK_NAME_LEN];
+};
+
+#if TRACE_HABILITADO
+
+static volatile bool recording = true; // false mientras esta congelada o se esta leyendo
+static bool frozen = false;            // se congelo por una trabada
+static uint32_t stallMicros = 0;       // lo que tardo esa vuelta del loop
+static uint32_t generation = 0;
+
+static TraceRecord ring[TRACE_EVENTS];
+static uint32_t next = 0; // crece siempre, el lugar es next % TRACE_EVENTS
+static TraceTask tasks[TRACE_TASKS];
+static const char *names[TRACE_NAMES] = {""};
+static uint8_t namesCount = 1;
+static portMUX_TYPE namesMux = portMUX_INITIALIZER_UNLOCKED;
+
+static inline uint32_t cycles()
+{
+#ifdef __XTENSA__
+    uint32_t ccount;
+    __asm__ __volatile__("rsr %0, ccount"
+                         : "=a"(ccount));
+    return ccount;
+#else
+    // sin CCOUNT (la PC): los us del timer pasados a ciclos, asi el resto no cambia
+    return (uint32_t)(esp_timer_get_time() * getCpuFrequencyMhz());
+#endif
+}
+
+// cada tarea toma la primera entrada libre la primera vez que graba; las que terminan (TraceTaskEnd)
+// la devuelven, pero no se reusa hasta que el anillo da la vuelta (sus eventos llevan ese nombre)
+static uint8_t taskIndex()
+{
+    TaskHandle_t task = xTaskGetCurrentTaskHandle();
+    for (uint8_t i = 0; i < TRACE_TASKS; i++)
+        if (__atomic_load_n(&tasks[i].task, __ATOMIC_RELAXED) == task)
+            return i;
+    for (uint8_t i = 0; i < TRACE_TASKS; i++)
+    {
+        if (tasks[i].ended && next - tasks[i].endedAt < TRACE_EVENTS)
+            continue;
+        TaskHandle_t empty = nullptr;
+        if (__atomic_compare_exchange_n(&tasks[i].task, &empty, task, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+        {
+            tasks[i].ended = false;
+            strlcpy(tasks[i].name, pcTaskGetTaskName(nullptr), sizeof(tasks[i].name));
+            return i;
+        }
+    }
+    return TRACE_TASKS;
+}
+
+static void readCycles(void *arg)
+{
+    *(uint32_t *)arg = cycles();
+}
+
+// el contador de cada CPU arranca en un momento distinto: diferencia con el de la CPU actual.
+// Se mide pidiendole el contador a la otra CPU (queda un error de unos pocos us).
+// Se llama desde el loop, que no cambia de CPU.
+static void coreOffsets(uint32_t offsets[portNUM_PROCESSORS])
+{
+    int me = xPortGetCoreID();
+    for (int core = 0; core < portNUM_PROCESSORS; core++)
+    {
+        offsets[core] = 0;
+        if (core == me)
+            continue;
+        uint32_t other = 0;
+        uint32_t before = cycles();
+        if (esp_ipc_call_blocking(core, readCycles, &other) != ESP_OK)
+            continue;
+        uint32_t after = cycles();
+        offsets[core] = other - (before + (after - before) / 2);
+    }
+}
+
+uint8_t TraceName(const char *name)
+{
+    uint8_t id = 0;
+    portENTER_CRITICAL(&namesMux);
+    for (uint8_t i = 1; i < namesCount && id == 0; i++)
+        if (strcmp(names[i], name) == 0)
+            id = i;
+    if (id == 0 && namesCount < TRACE_NAMES)
+    {
+        id = namesCount;
+        names[namesCount++] = name;
+    }
+    portEXIT_CRITICAL(&namesMux);
+    return id;
+}
+
+void TraceEvent(uint8_t name, char phase)
+{
+    if (!recording || name == 0)
+        return;
+
+    // sin interrupciones la tarea no cambia de CPU entre leer el contador y tomar el lugar,
+    // asi los eventos de cada CPU quedan en orden en el anillo
+    uint32_t state = portSET_INTERRUPT_MASK_FROM_ISR();
+    uint32_t ccount = cycles();
+    TraceRecord &record = ring[__atomic_fetch_add(&next, 1, __ATOMIC_RELAXED) % TRACE_EVENTS];
+    record.ccount = ccount;
+    record.phase = phase;
+    record.core = xPortGetCoreID();
+    record.task = taskIndex();
+    record.name = name;
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(state);
+}
+
+void TraceLoopEnd(uint32_t loopGeneration, uint32_t micros)
+{
+    if (TRACE_STALL_MS == 0 || micros < TRACE_STALL_MS * 1000 || loopGeneration != generation || !recording)
+        return;
+
+    static uint8_t stall = TraceName("trabada");
+    TraceEvent(stall, 'i');
+    stallMicros = micros;
+    frozen = true;
+    recording = false;
+}
+
+uint32_t TraceGeneration()
+{
+    return generation;
+}
+
+void TraceTaskEnd()
+{
+    TaskHandle_t task = xTaskGetCurrentTaskHandle();
+    for (uint8_t i = 0; i < TRACE_TASKS; i++)
+        if (tasks[i].task == task)
+        {
+            tasks[i].endedAt = next;
+            tasks[i].ended = true;
+            __atomic_store_n(&tasks[i].task, nullptr, __ATOMIC_RELEASE);
+        }
+}
+
+void TraceRestart()
+{
+    recording = false;
+    generation++;
+    memset(ring, 0, sizeof(ring));
+    memset(tasks, 0, sizeof(tasks)); // con el anillo vacio ningun evento las usa
+    next = 0;
+    frozen = false;
+    stallMicros = 0;
+    recording = true;
+}
+
+// como out.printf(), pero en el stack: el de Print pide memoria si el texto pasa de 64 bytes
+// (y la traza son miles de eventos de ~90 bytes)
+static void writef(Print &out, const char *format, ...) __attribute__((format(printf, 2, 3)));
+static void writef(Print &out, const char *format, ...)
+{
+    char line[192];
+    va_list args;
+    va_start(args, format);
+    int n = vsnprintf(line, sizeof(line), format, args);
+    va_end(args);
+    if (n > 0)
+        out.write((const uint8_t *)line, min((size_t)n, sizeof(line) - 1));
+}
+
+void TraceWriteJson(Print &out)
+{
+    bool wasRecording = recording;
+    recording = false;
+    generation++;
+
+    uint32_t offsets[portNUM_PROCESSORS];
+    coreOffsets(offsets);
+    uint32_t mhz = getCpuFrequencyMhz();
+    uint32_t end = next;
+    uint32_t first = end > TRACE_EVENTS ? end - TRACE_EVENTS : 0;
+
+    out.print("{\"traceEvents\":[");
+    for (uint8_t i = 0; i < TRACE_TASKS; i++)
+        if (tasks[i].name[0] != 0)
+            writef(out, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%u,\"args\":{\"name\":\"%s\"}},", i + 1, tasks[i].name);
+    writef(out, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%u,\"args\":{\"name\":\"otras\"}}", TRACE_TASKS + 1);
+
+    // eventos abiertos por tarea: el fin de algo que empezo antes del anillo no se manda
+    uint16_t depth[TRACE_TASKS + 1] = {0};
+    int64_t t = 0; // ciclos desde el primer evento
+    uint32_t prev = 0;
+    bool started = false;
+    for (uint32_t i = first; i < end; i++)
+    {
+        TraceRecord record = ring[i % TRACE_EVENTS];
+        if (record.name == 0 || record.name >= namesCount || record.task > TRACE_TASKS || record.core >= portNUM_PROCESSORS)
+            continue; // vacio o a medio escribir
+        if (record.phase == 'E')
+        {
+            if (depth[record.task] == 0)
+                continue;
+            depth[record.task]--;
+        }
+        else if (record.phase == 'B')
+            depth[record.task]++;
+
+        // diferencia con signo: pasa las vueltas del contador (cada 2^32 ciclos, ~18 s a 240 MHz)
+        // mientras no haya mas que eso entre dos eventos seguidos
+        uint32_t ccount = record.ccount - offsets[record.core];
+        if (!started)
+            prev = ccount;
+        started = true;
+        t += (int32_t)(ccount - prev);
+        prev = ccount;
+
+        uint64_t ns = t > 0 ? t * 1000 / mhz : 0;
+        writef(out, ",{\"name\":\"%s\",\"ph\":\"%c\",\"pid\":0,\"tid\":%u,\"ts\":%u.%03u%s}",
+                   names[record.name], record.phase, record.task + 1, (uint32_t)(ns / 1000), (uint32_t)(ns % 1000),
+                   record.phase == 'i' ? ",\"s\":\"g\"" : "");
+    }
+
+    writef(out, "],\"displayTimeUnit\":\"ms\",\"otherData\":{\"enabled\":true,\"events\":%u,\"lost\":%u,\"frozen\":%s,\"stallMs\":%u,\"cpuMHz\":%u}}",
+               end - first, first, frozen ? "true" : "false", stallMicros / 1000, mhz);
+
+    recording = wasRecording;
+}
+
+#else
+
+uint8_t TraceName(const char *)
+{
+    return 0;
+}
+
+void TraceEvent(uint8_t, char)
+{
+}
+
+void TraceLoopEnd(uint32_t, uint32_t)
+{
+}
+
+uint32_t TraceGeneration()
+{
+    return 0;
+}
+
+void TraceTaskEnd()
+{
+}
+
+void TraceRestart()
+{
+}
+
+void TraceWriteJson(Print &out)
+{
+    out.print("{\"traceEvents\":[],\"otherData\":{\"enabled\":false}}");
+}
+
+#endif
@@ -0,0 +1,185 @@
+/*
+    WebResources.cpp
+    Sirve los archivos de la carpeta web linkeados en la flash.
+    Ver WebResources.h
+
+    JJTeam - 2021
+*/
+
+#include "WebResources.h"
+#include "PerfStats.h"
+
+#define FNV_OFFSET 2166136261u
+#define FNV_PRIME 16777619u
+
+// se manda de a este tamaño (un segmento TCP), directo desde la flash
+#define WEB_RESOURCE_CHUNK 1460
+
+#define WEB_RESOURCE_ENTRY(_resource, _gzip, _path, _type) \
+  {_path, "http " _path, nullptr, _type, _resource, _resource##_end, _gzip, _gzip##_end, "", ""},
+
+static WebResource resources[] = {WEB_RESOURCES(WEB_RESOURCE_ENTRY)};
+
+// headers del request que usa sendResource() (el WebServer solo guarda los que se le piden)
+static const char *requestHeaders[] = {"If-None-Match", "Range", "If-Range", "Accept-Encoding"};
+
+enum class WebRange
+{
+  Full,    // sin Range (o uno que no entendemos): va todo
+  Partial, // un rango valido: 206
+  Invalid  // el rango esta fuera del archivo: 416
+};
+
+const WebResource *WebResourceFind(const char *path)
+{
+  for (const WebResource &res : resources)
+    if (strcmp(res.path, path) == 0)
+      return &res;
+  return nullptr;
+}
+
+// "Accept-Encoding: gzip, deflate, br": acepta gzip si esta en la lista (o "*") sin "q=0"
+static bool acceptsGzip(const char *accept)
+{
+  while (*accept)
+  {
+    while (*accept == ' ' || *accept == ',')
+      accept++;
+    size_t nameLength = strcspn(accept, ";, ");
+    size_t length = strcspn(accept, ",");
+    bool gzip = (nameLength == 4 && strncasecmp(accept, "gzip", 4) == 0) || (nameLength == 1 && *accept == '*');
+    if (gzip)
+    {
+      const char *q = strstr(accept, "q=");
+      return q == nullptr || q >= accept + length || atof(q + 2) > 0;
+    }
+    accept += length;
+  }
+  return false;
+}
+
+// "Range: bytes=inicio-fin", "bytes=inicio-" o "bytes=-ultimos". Varios rangos no se soportan (va todo).
+// first y length solo cambian si devuelve Partial
+static WebRange parseRange(const char *range, size_t size, size_t &first, size_t &length)
+{
+  if (strncmp(range, "bytes=", 6) != 0 || strchr(range, ',') != nullptr)
+    return WebRange::Full;
+
+  const char *p = range + 6;
+  char *end;
+  size_t start, last;
+  if (*p == '-')
+  {
+    size_t n = strtoul(p + 1, &end, 10);
+    if (end == p + 1 || *end != 0)
+      return WebRange::Full;
+    if (n == 0 || size == 0)
+      return WebRange::Invalid;
+    start = n >= size ? 0 : size - n;
+    last = size - 1;
+  }
+  else
+  {
+    start = strtoul(p, &end, 10);
+    if (end == p || *end != '-')
+      return WebRange::Full;
+    p = end + 1;
+    last = SIZE_MAX;
+    if (*p != 0)
+    {
+      last = strtoul(p, &end, 10);
+      if (end == p || *end != 0 || last < start)
+        return WebRange::Full;
+    }
+    if (start >= size)
+      return WebRange::Invalid;
+    last = min(last, size - 1);
+  }
+  first = start;
+  length = last + 1 - start;
+  return WebRange::Partial;
+}
+
+static void sendResource(WebServer &server, const WebResource &res)
+{
+  PERF_SCOPE_STAT(res.perf);
+  bool gzip = res.gzip() && acceptsGzip(server.header("Accept-Encoding").c_str());
+  const char *content = gzip ? res.gzipData : res.data;
+  const char *etag = gzip ? res.gzipEtag : res.etag;
+  size_t size = gzip ? res.gzipEnd - res.gzipData : res.size();
+  server.sendHeader("ETag", etag);
+  server.sendHeader("Cache-Control", "no-cache");
+  server.sendHeader("Accept-Ranges", "bytes");
+  if (res.gzip())
+    server.sendHeader("Vary", "Accept-Encoding");
+
+  // el navegador ya lo tiene
+  if (strstr(server.header("If-None-Match").c_str(), etag) != nullptr)
+  {
+    server.send(304);
+    return;
+  }
+
+  // con If-Range el rango vale solo si sigue siendo la misma version
+  size_t first = 0, length = size;
+  WebRange range = WebRange::Full;
+  String ifRange = server.header("If-Range");
+  if (ifRange.length() == 0 || ifRange == etag)
+    range = parseRange(server.header("Range").c_str(), size, first, length);
+
+  char contentRange[48];
+  if (range == WebRange::Invalid)
+  {
+    snprintf(contentRange, sizeof(contentRange), "bytes */%u", (unsigned)size);
+    server.sendHeader("Content-Range", contentRange);
+    server.send(416);
+    return;
+  }
+  if (range == WebRange::Partial)
+  {
+    snprintf(contentRange, sizeof(contentRange), "bytes %u-%u/%u", (unsigned)first, (unsigned)(first + length - 1), (unsigned)size);
+    server.sendHeader("Content-Range", contentRange);
+  }
+
+  // con gzip los rangos son sobre el archivo comprimido
+  if (gzip)
+    server.sendHeader("Content-Encoding", "gzip");
+  server.setContentLength(length);
+  server.send(range == WebRange::Partial ? 206 : 200, res.contentType, "");
+
+  // el contenido va directo desde la flash (mapeada en memoria) al socket, sin copiarlo a RAM
+  WiFiClient client = server.client();
+  const uint8_t *data = (const uint8_t *)content + first;
+  while (length > 0 && client.connected())
+  {
+    size_t sent = client.write(data, min(length, (size_t)WEB_RESOURCE_CHUNK));
+    if (sent == 0)
+      break;
+    data += sent;
+    length -= sent;
+  }
+}
+
+// ETag fuerte: FNV-1a del contenido, cambia solo si cambia el archivo
+static void computeEtag(char (&etag)[11], const char *data, const char *end)
+{
+  uint32_t hash = FNV_OFFSET;
+  for (const char *p = data; p < end; p++)
+    hash = (hash ^ (uint8_t)*p) * FNV_PRIME;
+  snprintf(etag, sizeof(etag), "\"%08x\"", hash);
+}
+
+void WebResourcesBegin(WebServer &server)
+{
+  for (WebResource &res : resources)
+  {
+    computeEtag(res.etag, res.data, res.end);
+    computeEtag(res.gzipEtag, res.gzipData, res.gzipEnd);
+    res.perf = PerfStatGet(res.perfName);
+
+    const WebResource *r = &res;
+    server.on(res.path, HTTP_GET, [&server, r]()
+              { sendResource(server, *r); });
+  }
+  server.collectHeaders(requestHeaders, sizeof(requestHeaders) / sizeof(requestHeaders[0]));
+}
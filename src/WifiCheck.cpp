@@ -15,14 +15,22 @@
 #include <ESPmDNS.h>
 #include <EEPROM.h>
 #include "Tools.h"
+#include "DeviceId.h"
 #include "WebResources.h"
+#include "HtmlWriter.h"
+#include "WifiScan.h"
+#include "WifiConnection.h"
 #include "FSLog.h"
+#include "PerfStats.h"
+#include "MemStats.h"
+#include "Trace.h"
 
-/* hostname for mDNS. Should work at least on windows. Try http://myHostname.local */
-inline const String getHostname() { return "pigguard" + getSerialNumber(); }
-inline const String getSoftAP_SSID() { return "Pig Guard " + getSerialNumber(); }
 constexpr char TEXT_HTML[] = "text/html";
 constexpr char TEXT_PLAIN[] = "text/plain";
+constexpr char APPLICATION_JSON[] = "application/json";
+
+// si el cache de redes es mas viejo que esto, /wifi pide un scan nuevo (ms)
+#define WIFI_SCAN_MAX_AGE 15000
 
 /* Don't set this wifi credentials. They are configurated at runtime and stored on EEPROM */
 char ssid[33] = "";
@@ -35,37 +43,62 @@ WebServer server(80);
 IPAddress apIP(172, 217, 28, 1);
 IPAddress netMsk(255, 255, 255, 0);
 
-/** Should I connect to WLAN asap? */
-boolean connect;
-
-/** Last time I tried to connect to WLAN */
-unsigned long lastConnectTry = 0;
-
 /** Current WLAN status */
 unsigned int status = WL_IDLE_STATUS;
 
-// arma un TAG HTML, y puede tener clase (optativa)
-String Tag(String tag, String text, String classs = "")
+/* URLs que piden los sistemas para saber si estan detras de un portal cautivo.
+   Se contestan con una redireccion al portal ya armada, sin generar HTML */
+const char *const PROBE_PATHS[] = {
+    "/generate_204",              // Android
+    "/gen_204",                   // Android
+    "/hotspot-detect.html",       // Apple
+    "/library/test/success.html", // Apple
+    "/connecttest.txt",           // Windows
+    "/ncsi.txt",                  // Windows
+    "/fwlink",                    // Windows
+    "/redirect",                  // Windows
+    "/canonical.html",            // Firefox
+    "/success.txt",               // Firefox
+};
+// respuesta HTTP completa (302 al portal) para la IP por la que llego el pedido
+struct ProbeReply
 {
-    if (classs.isEmpty())
-        return "<" + tag + ">" + text + "</" + tag + ">";
-    else
-        return "<" + tag + " class=\"" + classs + "\">" + text + "</" + tag + ">";
+    uint32_t ip; // 0 = todavia no se armo
+    size_t length;
+    char text[192];
+};
+ProbeReply probeReplyAP;  // se arma en WifiSetup()
+ProbeReply probeReplySTA; // se arma la primera vez (y de nuevo si cambia la IP de la red wifi)
+
+void buildProbeReply(ProbeReply &reply, IPAddress ip)
+{
+    char text[IP_STRING_SIZE];
+    reply.length = snprintf(reply.text, sizeof(reply.text),
+                            "HTTP/1.1 302 Found\r\n"
+                            "Location: http://%s/\r\n"
+                            "Cache-Control: no-cache, no-store\r\n"
+                            "Content-Length: 0\r\n"
+                            "Connection: close\r\n\r\n",
+                            ipToString(ip, text));
+    reply.ip = (uint32_t)ip;
 }
 
-// TAG OPTION (value optativo)
-String Option(String text, String value = "")
+/** El Host del request es el equipo? (una IP o el nombre, con o sin .local) */
+bool isOwnHost(const String &host)
 {
-    return "<option value=\"" + value + "\">" + text + "</option>";
+    const char *h = host.c_str();
+    return strcmp(h, DeviceLocalHostname()) == 0 || strcmp(h, DeviceHostname()) == 0 || isIp(h);
 }
 
 /** Redirect to captive portal if we got a request for another domain. Return true in that case so the page handler do not try to handle the request again. */
 boolean captivePortal()
 {
-    if (!isIp(server.hostHeader()) && server.hostHeader() != (getHostname() + ".local"))
+    if (!isOwnHost(server.hostHeader()))
     {
         Serial.println("Request redirected to captive portal");
-        server.sendHeader("Location", String("http://") + toStringIp(server.client().localIP()), true);
+        char location[7 + IP_STRING_SIZE] = "http://";
+        ipToString(server.client().localIP(), location + 7);
+        server.sendHeader("Location", location, true);
         server.send(302, TEXT_PLAIN, ""); // Empty content inhibits Content-length header so we have to close the socket ourselves.
         server.client().stop();           // Stop is needed because we sent no content length
         return true;
@@ -114,17 +147,21 @@ bool isLocalIP()
     return server.client().localIP() == apIP;
 }
 
-String GetConnectThrough()
+void GetConnectThrough(HtmlWriter &html)
 {
-    return Tag("p", "Est&aacute;s conectado a trav&eacute;s de<br>" +
-                        (isLocalIP()
-                             ? "soft AP: <b>" + getSoftAP_SSID() + "</b>"
-                             : "red wifi: <b>" + String(ssid) + "</b>"));
+    html.open("p").text("Est&aacute;s conectado a trav&eacute;s de<br>");
+    if (isLocalIP())
+        html.text("soft AP: <b>").escaped(DeviceSoftAPSSID()).text("</b>");
+    else
+        html.text("red wifi: <b>").escaped(ssid).text("</b>");
+    html.close("p");
 }
 
 /** Handle root or redirect to captive portal */
 void handleRoot()
 {
+    PERF_SCOPE("http /");
+
     if (captivePortal())
     { // If caprive portal redirect instead of displaying the page.
         return;
@@ -132,90 +169,359 @@ void handleRoot()
 
     SendCacheHeader();
 
-    String Page;
-    Page += HTML_BODY_START;
-    Page += GetConnectThrough();
-    Page += HTML_MENU_INDEX;
-    Page += HTML_BODY_END;
-    server.send(200, TEXT_HTML, Page);
+    HtmlWriter html(server);
+    html.begin(200, TEXT_HTML);
+    html.text(HTML_BODY_START);
+    GetConnectThrough(html);
+    html.text(HTML_MENU_INDEX);
+    html.text(HTML_BODY_END);
+    html.end();
 }
 
 // cada linea de log la decoro y la evío:
-void EnrichAndSend(String line)
+void EnrichAndSend(const char *line, size_t len, void *ctx)
+{
+    HtmlWriter &html = *(HtmlWriter *)ctx;
+    char type = len > 1 ? line[1] : 0;
+    const char *color = (type == 'E' ? "r" : (type == 'I' ? "b" : "n"));
+    html.open("p", color).escaped(line, len).close("p");
+}
+
+// valor numerico de un argumento del request (o def si no esta)
+uint32_t argUInt(const char *name, uint32_t def)
+{
+    if (!server.hasArg(name))
+        return def;
+    long value = server.arg(name).toInt();
+    return value > 0 ? value : 0;
+}
+
+// lineas por pagina de /logs (si no se pasa size), y el maximo para size y tail
+#define LOGS_PAGE_SIZE 50
+#define LOGS_PAGE_MAX 200
+
+/**
+ * Logs paginados, va directo a las lineas pedidas usando el indice de FsBuffer:
+ *   /logs?page=N&size=M  => pagina N (contando desde la linea mas vieja) de M lineas
+ *   /logs?tail=K         => las ultimas K lineas
+ *   /logs?since=S        => las lineas desde el numero de secuencia S
+ * M y K van hasta LOGS_PAGE_MAX (tail=0 no trae nada). Una pagina o un since despues
+ * de la ultima linea sale vacia.
+ * El header X-Next-Seq tiene la secuencia para pedir lo siguiente con since=.
+ */
+void handleLogsPage()
 {
-    String color = (line[1] == 'E' ? "r" : (line[1] == 'I' ? "b" : "n"));
-    server.sendContent(Tag("p", line, color));
+    uint32_t size = constrain(argUInt("size", LOGS_PAGE_SIZE), 1u, (uint32_t)LOGS_PAGE_MAX);
+    uint32_t first = FSLOG.firstSeq();
+    uint32_t next = FSLOG.nextSeq();
+    uint32_t seq;
+
+    if (server.hasArg("tail"))
+    {
+        size = min(argUInt("tail", 0), (uint32_t)LOGS_PAGE_MAX);
+        seq = next > size ? next - size : 0;
+    }
+    else if (server.hasArg("since"))
+        seq = argUInt("since", 0);
+    else
+    {
+        // en 64 bits: page * size no da la vuelta
+        uint64_t start = first + (uint64_t)argUInt("page", 0) * size;
+        seq = min(start, (uint64_t)next);
+    }
+
+    // pido justo hasta 'next', y el header sale de los indices (sin leer los archivos) antes de las lineas
+    seq = constrain(seq, first, next);
+    uint32_t count = seq < next ? min(size, next - seq) : 0;
+    next = FSLOG.forEachLineFrom(seq, count, nullptr);
+
+    SendCacheHeader();
+    server.sendHeader("X-Next-Seq", String(next));
+
+    HtmlWriter html(server);
+    html.begin(200, TEXT_HTML);
+    html.text(HTML_BODY_START);
+    html.tag("h2", "Logs hist&oacute;ricos");
+
+    html.text("<code>");
+    // el link sigue desde la ultima linea que se envio de verdad
+    next = FSLOG.forEachLineFrom(seq, count, EnrichAndSend, &html);
+    html.text("</code>");
+
+    html.open("p").printf("<a href='/logs?since=%u'>M&aacute;s nuevos</a>", next);
+    html.close("p");
+    html.text(HTML_BODY_END);
+    html.end();
 }
 
 void handleLogs()
 {
+    PERF_SCOPE("http /logs");
+
+    if (server.hasArg("page") || server.hasArg("tail") || server.hasArg("since"))
+        return handleLogsPage();
+
     SendCacheHeader();
 
     // envia con Chunk Mode HTTP 1.1
+    HtmlWriter html(server);
+    html.begin(200, TEXT_HTML);
+    html.text(HTML_BODY_START);
+    html.tag("h2", "Logs al iniciar el sistema");
 
-    server.setContentLength(CONTENT_LENGTH_UNKNOWN);
-    server.send(200, TEXT_HTML, HTML_BODY_START);
-    server.sendContent(Tag("h2", "Logs al iniciar el sistema"));
+    html.text("<code>");
+    FSLOG.forEachStartup(EnrichAndSend, &html);
+    html.text("</code>");
 
-    server.sendContent("<code>");
-    FSLOG.forEachStartup(EnrichAndSend);
-    server.sendContent("</code>");
+    html.tag("h2", "Logs hist&oacute;ricos");
 
-    server.sendContent(Tag("h2", "Logs hist&oacute;ricos"));
+    html.text("<code>");
+    FSLOG.forEachLine(EnrichAndSend, &html);
+    html.text("</code>");
 
-    server.sendContent("<code>");
-    FSLOG.forEachLine(EnrichAndSend);
-    server.sendContent("</code>");
-
-    server.sendContent(HTML_BODY_END);
-    server.sendContent(""); // END CHUNK!
+    html.text(HTML_BODY_END);
+    html.end();
 }
 
 /** Wifi config page handler */
 void handleWifi()
 {
-    SendCacheHeader();
+    PERF_SCOPE("http /wifi");
 
-    String Page;
-    Page += HTML_BODY_START;
-    Page += Tag("h1", "Pig Guard");
-    Page += GetConnectThrough();
-    Page += Tag("p", Tag("b", "SoftAP config"));
-    Page += Tag("p", "SSID: " + getSoftAP_SSID());
-    Page += Tag("p", "IP: " + toStringIp(WiFi.softAPIP()));
-    Page += Tag("p", Tag("b", "WLAN config"));
-    Page += Tag("p", "SSID: " + String(ssid));
-    Page += Tag("p", "IP: " + toStringIp(WiFi.localIP()));
-
-    Serial.println("scan start");
-    int n = WiFi.scanNetworks();
-    Serial.println("scan done");
+    SendCacheHeader();
 
+    HtmlWriter html(server);
+    html.begin(200, TEXT_HTML);
+    html.text(HTML_BODY_START);
+    html.tag("h1", "Pig Guard");
+    GetConnectThrough(html);
+    html.tag("p", "<b>SoftAP config</b>");
+    html.open("p").text("SSID: ").escaped(DeviceSoftAPSSID()).close("p");
+    html.open("p").text("IP: ").print(WiFi.softAPIP());
+    html.close("p");
+    html.tag("p", "<b>WLAN config</b>");
+    html.open("p").text("SSID: ").escaped(ssid).close("p");
+    html.open("p").text("IP: ").print(WiFi.localIP());
+    html.close("p");
+
+    // las redes salen del cache (el scan se hace en segundo plano), si esta viejo se pide otro.
+    if (server.hasArg("scan") || WifiScanAge() > WIFI_SCAN_MAX_AGE)
+        WifiScanRequest();
+
+    int n = WifiScanCount();
     if (n > 0)
     {
-        Page += Tag("h2", "Redes disponibles:");
-        Page += "<form method='POST' action='wifisave'>";
-        Page += "<select name=\"n\">";
-        Page += Option("Seleccione una red");
+        html.tag("h2", "Redes disponibles:");
+        html.text("<form method='POST' action='wifisave'>");
+        html.text("<select name=\"n\">");
+        html.option("Seleccione una red");
         for (int i = 0; i < n; i++)
-            Page += Option(WiFi.SSID(i) + "(" + WiFi.RSSI(i) + ")", WiFi.SSID(i));
-        Page += "</select>"
-                "<br><input type='text' placeholder='Ingrese la clave' size=\"15\" name='p'/>"
-                "<br><input type='submit' value='Conectar'/>"
-                "<br></form>";
-        Page += Tag("p", "(Actualiza la p&aacute;gina para refrescar)");
+        {
+            const WifiScanNet &net = WifiScanGet(i);
+            html.text("<option value=\"").escaped(net.ssid).text("\">");
+            html.escaped(net.ssid).printf("(%d)</option>", net.rssi);
+        }
+        html.text("</select>"
+                  "<br><input type='text' placeholder='Ingrese la clave' size=\"15\" name='p'/>"
+                  "<br><input type='submit' value='Conectar'/>"
+                  "<br></form>");
+        html.open("p").printf("(Actualizado hace %u segundos, ", WifiScanAge() / 1000);
+        html.text("<a href='/wifi?scan=1'>buscar de nuevo</a>)").close("p");
+    }
+    else if (WifiScanRunning() || WifiScanAge() == UINT32_MAX)
+    {
+        html.tag("p", "Buscando redes... (actualiza la p&aacute;gina en unos segundos)");
     }
     else
     {
-        Page += Tag("p", "No WLAN found", "r");
+        html.tag("p", "No WLAN found", "r");
+    }
+    html.text(HTML_BODY_END);
+    html.end();
+}
+
+/** Lo mismo que /wifi pero en JSON (sale del cache, no espera el scan) */
+void handleWifiJson()
+{
+    PERF_SCOPE("http /wifi.json");
+
+    if (server.hasArg("scan") || WifiScanAge() > WIFI_SCAN_MAX_AGE)
+        WifiScanRequest();
+
+    SendCacheHeader();
+
+    HtmlWriter json(server);
+    json.begin(200, APPLICATION_JSON);
+    uint32_t age = WifiScanAge();
+    if (age == UINT32_MAX)
+        json.text("{\"age\":null");
+    else
+        json.printf("{\"age\":%u", age);
+    json.printf(",\"scanning\":%s,\"networks\":[", WifiScanRunning() ? "true" : "false");
+    for (int i = 0; i < WifiScanCount(); i++)
+    {
+        const WifiScanNet &net = WifiScanGet(i);
+        json.text(i == 0 ? "{\"ssid\":" : ",{\"ssid\":").json(net.ssid);
+        json.printf(",\"rssi\":%d,\"enc\":%u}", net.rssi, net.encryption);
+    }
+    json.text("]}");
+    json.end();
+}
+
+/** Estadisticas del DNS en JSON: tipos de consulta, nombres mas pedidos, clientes y latencias */
+void handleDnsStats()
+{
+    PERF_SCOPE("http /stats/dns");
+
+    static DNSTelemetry t; // copia (no va en el stack)
+    dnsServer.telemetry(t);
+    const DNSServerStats &stats = dnsServer.stats();
+    uint32_t now = millis();
+
+    SendCacheHeader();
+
+    HtmlWriter json(server);
+    json.begin(200, APPLICATION_JSON);
+    json.printf("{\"received\":%u,\"answered\":%u,\"dropped\":%u,\"refused\":%u,\"maxBatch\":%u,\"qtypes\":{",
+                stats.received, stats.answered, stats.dropped, stats.refused, stats.maxBatch);
+    for (uint8_t i = 0; i < DNS_QTYPE_SLOTS; i++)
+        json.printf("%s\"%s\":%u", i == 0 ? "" : ",", DNSTelemetry::qtypeName(i), t.qtypes[i]);
+
+    json.text("},\"names\":[");
+    bool first = true;
+    for (const DNSTopName &top : t.topNames)
+    {
+        if (top.hash == 0)
+            continue;
+        json.text(first ? "{\"name\":" : ",{\"name\":").json(top.name);
+        json.printf(",\"count\":%u,\"error\":%u}", top.count, top.error);
+        first = false;
+    }
+
+    json.text("],\"clients\":[");
+    first = true;
+    for (const DNSClient &client : t.clients)
+    {
+        if (client.ip == 0)
+            continue;
+        IPAddress ip(client.ip);
+        json.printf("%s{\"ip\":\"%u.%u.%u.%u\",\"count\":%u,\"rate\":%u,\"refused\":%u,\"age\":%u,\"latency\":[", first ? "" : ",",
+                    ip[0], ip[1], ip[2], ip[3], client.count, client.rate, client.refused, now - client.lastSeen);
+        // solo los baldes con algo, mismo formato que el total
+        bool firstBucket = true;
+        for (uint8_t i = 0; i < DNS_LATENCY_BUCKETS; i++)
+        {
+            if (client.latency[i] == 0)
+                continue;
+            uint32_t limit = DNSTelemetry::latencyLimit(i);
+            if (limit == UINT32_MAX)
+                json.printf("%s[null,%u]", firstBucket ? "" : ",", client.latency[i]);
+            else
+                json.printf("%s[%u,%u]", firstBucket ? "" : ",", limit, client.latency[i]);
+            firstBucket = false;
+        }
+        json.text("]}");
+        first = false;
+    }
+
+    // latencia: [limite en us (null = sin limite), cantidad]
+    json.text("],\"latency\":[");
+    for (uint8_t i = 0; i < DNS_LATENCY_BUCKETS; i++)
+    {
+        uint32_t limit = DNSTelemetry::latencyLimit(i);
+        if (limit == UINT32_MAX)
+            json.printf("%s[null,%u]", i == 0 ? "" : ",", t.latency[i]);
+        else
+            json.printf("%s[%u,%u]", i == 0 ? "" : ",", limit, t.latency[i]);
+    }
+    json.text("]}");
+    json.end();
+}
+
+/** Tiempos de los caminos calientes en JSON (ver PerfStats.h) */
+void handlePerfStats()
+{
+    PERF_SCOPE("http /stats/perf");
+
+    SendCacheHeader();
+
+    HtmlWriter json(server);
+    json.begin(200, APPLICATION_JSON);
+    json.text("{\"stats\":[");
+    PerfStat stat;
+    for (int i = 0; PerfStatCopy(i, stat); i++)
+    {
+        json.text(i == 0 ? "{\"name\":" : ",{\"name\":").json(stat.name);
+        json.printf(",\"count\":%u,\"avg\":%u,\"p50\":%u,\"p99\":%u,\"max\":%u}",
+                    stat.count, stat.count ? (uint32_t)(stat.totalMicros / stat.count) : 0,
+                    PerfStatPercentile(stat, 50), PerfStatPercentile(stat, 99), stat.maxMicros);
+    }
+    json.text("]}");
+    json.end();
+
+    if (server.hasArg("reset"))
+        PerfStatClear();
+}
+
+/** Uso de memoria en JSON: heap, stack de las tareas y pedidos al heap de cada PERF_SCOPE */
+void handleMemStats()
+{
+    PERF_SCOPE("http /stats/mem");
+
+    MemStatsHeap heap;
+    MemStatsGet(heap);
+
+    SendCacheHeader();
+
+    HtmlWriter json(server);
+    json.begin(200, APPLICATION_JSON);
+    json.printf("{\"heap\":{\"free\":%u,\"minFree\":%u,\"largest\":%u,\"allocs\":%u,\"frees\":%u,\"bytes\":%u}",
+                heap.free, heap.minFree, heap.largest, heap.allocs, heap.frees, heap.bytes);
+
+    // stack libre minimo de cada tarea (en bytes)
+    json.printf(",\"stack\":{\"loop\":%u", MemStatsStackFree(nullptr));
+    if (dnsServer.hasTask())
+        json.printf(",\"dns\":%u", MemStatsStackFree(dnsServer.task()));
+    if (FSLOG.getFlushTask())
+        json.printf(",\"fslog\":%u", MemStatsStackFree(FSLOG.getFlushTask()));
+
+    json.text("},\"stats\":[");
+    PerfStat stat;
+    for (int i = 0; PerfStatCopy(i, stat); i++)
+    {
+        json.text(i == 0 ? "{\"name\":" : ",{\"name\":").json(stat.name);
+        json.printf(",\"count\":%u,\"allocs\":%u,\"bytes\":%u,\"peakHeap\":%u,\"minLargest\":%u}",
+                    stat.count, stat.allocs, stat.allocBytes, stat.peakHeap, stat.minLargest);
     }
-    server.send(200, TEXT_HTML, Page);
-    server.client().stop(); // Stop is needed because we sent no content length
+    json.text("]}");
+    json.end();
+}
+
+/**
+ * Traza de la ultima parte del loop (ver Trace.h), para abrir con chrome://tracing o ui.perfetto.dev
+ *   /trace.json          => la traza (si hubo una trabada queda congelada en esa)
+ *   /trace.json?restart  => ademas la vacia y la vuelve a largar
+ */
+void handleTrace()
+{
+    PERF_SCOPE("http /trace.json");
+
+    SendCacheHeader();
+
+    HtmlWriter json(server);
+    json.begin(200, APPLICATION_JSON);
+    TraceWriteJson(json);
+    json.end();
+
+    if (server.hasArg("restart"))
+        TraceRestart();
 }
 
 /** Handle the WLAN save form and redirect to WLAN config page again */
 void handleWifiSave()
 {
+    PERF_SCOPE("http /wifisave");
+
     Serial.println("wifi save");
 
     server.arg("n").toCharArray(ssid, sizeof(ssid) - 1);
@@ -227,29 +533,64 @@ void handleWifiSave()
     server.send(302, TEXT_PLAIN, ""); // Empty content inhibits Content-length header so we have to close the socket ourselves.
     server.client().stop();           // Stop is needed because we sent no content length
     saveCredentials();
-    connect = strlen(ssid) > 0; // Request WLAN connect with new credentials if there is a SSID
+    WifiConnectionStart(ssid, password); // Request WLAN connect with new credentials (if there is a SSID)
+}
+
+void handleNotFound();
+
+/** Deteccion de portal cautivo de algun sistema: manda la redireccion ya armada y cierra */
+void handleProbe()
+{
+    PERF_SCOPE("http probe");
+
+    // pedido al equipo mismo (no es la prueba de un sistema): como cualquier otra url
+    if (isOwnHost(server.hostHeader()))
+        return handleNotFound();
+
+    // al soft AP o por la red wifi: cada uno redirige a la IP que el cliente puede alcanzar
+    WiFiClient client = server.client();
+    IPAddress local = client.localIP();
+    ProbeReply *reply = &probeReplyAP;
+    if ((uint32_t)local != probeReplyAP.ip)
+    {
+        reply = &probeReplySTA;
+        if ((uint32_t)local != probeReplySTA.ip)
+            buildProbeReply(probeReplySTA, local);
+    }
+    client.write((const uint8_t *)reply->text, reply->length);
+    client.stop();
 }
 
 void handleNotFound()
 {
+    PERF_SCOPE("http notFound");
+
     if (captivePortal())
     { // If captive portal redirect instead of displaying the error page.
         return;
     }
-    String message = F("File Not Found\n\n");
-    message += F("URI: ");
-    message += server.uri();
-    message += F("\nMethod: ");
-    message += (server.method() == HTTP_GET) ? "GET" : "POST";
-    message += F("\nArguments: ");
-    message += server.args();
-    message += F("\n");
-
-    for (uint8_t i = 0; i < server.args(); i++)
-        message += String(F(" ")) + server.argName(i) + F(": ") + server.arg(i) + F("\n");
 
     SendCacheHeader();
-    server.send(404, TEXT_PLAIN, message);
+
+    HtmlWriter message(server);
+    message.begin(404, TEXT_PLAIN);
+    message.print(F("File Not Found\n\nURI: "));
+    message.print(server.uri());
+    message.print(F("\nMethod: "));
+    message.print((server.method() == HTTP_GET) ? "GET" : "POST");
+    message.print(F("\nArguments: "));
+    message.print(server.args());
+    message.print(F("\n"));
+
+    for (uint8_t i = 0; i < server.args(); i++)
+    {
+        message.print(F(" "));
+        message.print(server.argName(i));
+        message.print(F(": "));
+        message.print(server.arg(i));
+        message.print(F("\n"));
+    }
+    message.end();
 }
 
 void PrintWiFiStatus(uint8_t st)
@@ -279,36 +620,17 @@ void PrintWiFiStatus(uint8_t st)
         break;
     }
 }
-void connectWifi()
-{
-    uint8_t st;
-    Serial.println("Connecting as wifi client...");
-    WiFi.disconnect();
-    st = WiFi.begin(ssid, password);
-    PrintWiFiStatus(st);
-    st = WiFi.waitForConnectResult();
-    PrintWiFiStatus(st);
-
-    // Serial.printf("status : %d\n", st);
-    /* WL_IDLE_STATUS      = 0,
-    WL_NO_SSID_AVAIL    = 1,
-    WL_SCAN_COMPLETED   = 2,
-    WL_CONNECTED        = 3,
-    WL_CONNECT_FAILED   = 4,
-    WL_CONNECTION_LOST  = 5,
-    WL_DISCONNECTED     = 6*/
-    //Serial.println(st);
-}
-
 void WifiSetup()
 {
     Serial.println();
     Serial.println("Configuring access point...");
     bool f;
 
+    buildProbeReply(probeReplyAP, apIP);
+
     f = WiFi.softAPConfig(apIP, apIP, netMsk);
     Serial.println(f ? "OK" : "ERR");
-    f = WiFi.softAP(getSoftAP_SSID().c_str(), ""); // sin contraseña (AP OPEN)
+    f = WiFi.softAP(DeviceSoftAPSSID(), ""); // sin contraseña (AP OPEN)
     Serial.println(f ? "OK" : "ERR");
 
     delay(500); // Without delay I've seen the IP address blank
@@ -318,46 +640,59 @@ void WifiSetup()
     /* Setup the DNS server redirecting all the domains to the apIP */
     dnsServer.setErrorReplyCode(DNSReplyCode::NoError);
     dnsServer.start(DNS_PORT, "*", apIP);
+    if (!dnsServer.startTask()) // atiende el DNS en su propia tarea (si no, se atiende en el loop)
+        Serial.println("DNS task ERR");
 
     /* Setup web pages: root, wifi config pages, SO captive portal detectors and not found. */
     server.on("/", handleRoot);
     server.on("/wifi", handleWifi);
+    server.on("/wifi.json", handleWifiJson);
     server.on("/logs", handleLogs);
+    server.on("/stats/dns", handleDnsStats);
+    server.on("/stats/perf", handlePerfStats);
+    server.on("/stats/mem", handleMemStats);
+    server.on("/trace.json", handleTrace);
     server.on("/wifisave", handleWifiSave);
-    server.on("/generate_204", handleRoot); //Android captive portal. Maybe not needed. Might be handled by notFound handler.
-    server.on("/fwlink", handleRoot);       //Microsoft captive portal. Maybe not needed. Might be handled by notFound handler.
-    server.on("/style.css", []()
-              { server.send(200, "text/css", style_css); });
-    server.on("/logo.jpg", []()
-              { server.send_P(200, "image/jpeg", logo_jpg, logo_jpg_size); });
+    for (const char *path : PROBE_PATHS)
+        server.on(path, handleProbe);
+    WebResourcesBegin(server); // /style.css, /logo.jpg
     server.onNotFound(handleNotFound);
     server.begin(); // Web server start
     Serial.println("HTTP server started");
-    loadCredentials();          // Load WLAN credentials from network
-    connect = strlen(ssid) > 0; // Request WLAN connect if there is a SSID
+    loadCredentials(); // Load WLAN credentials from network
+    WifiConnectionBegin();
+    WifiConnectionStart(ssid, password); // Request WLAN connect if there is a SSID
 }
 
 void WifiLoop()
 {
+    TRACE_LOOP();
+
     // loop general...
-    dnsServer.processNextRequest();
-    server.handleClient();
+    if (!dnsServer.hasTask())
+    {
+        TRACE_SCOPE("processNextRequest");
+        dnsServer.processNextRequest();
+    }
+    {
+        TRACE_SCOPE("handleClient");
+        server.handleClient();
+    }
+    {
+        TRACE_SCOPE("WifiScanLoop");
+        WifiScanLoop();
+    }
 
-    // verifico si se desconecta y lo vuelvo a conectar...
-    if (connect)
+    // si se desconecta lo vuelve a conectar (sin bloquear)...
     {
-        Serial.println("Connect requested");
-        connect = false;
-        connectWifi();
-        lastConnectTry = millis();
+        TRACE_SCOPE("WifiConnectionLoop");
+        WifiConnectionLoop();
     }
 
-    unsigned int wifi_status = WiFi.status();
-    if (wifi_status == 0 && millis() > (lastConnectTry + 60000))
+    unsigned int wifi_status;
     {
-        /* If WLAN disconnected and idle try to connect */
-        /* Don't set retry time too low as retry interfere the softAP operation */
-        connect = true;
+        TRACE_SCOPE("WiFi.status");
+        wifi_status = WiFi.status();
     }
 
     if (status != wifi_status)
@@ -378,7 +713,7 @@ void WifiLoop()
             Serial.println(WiFi.localIP());
 
             // Setup MDNS responder
-            if (!MDNS.begin(getHostname().c_str()))
+            if (!MDNS.begin(DeviceHostname()))
             {
                 Serial.println("Error setting up MDNS responder!");
             }
@@ -389,9 +724,5 @@ void WifiLoop()
                 MDNS.addService("http", "tcp", 80);
             }
         }
-        else if (wifi_status == WL_NO_SSID_AVAIL)
-        {
-            WiFi.disconnect();
-        }
     }
 }
\ No newline at end of file
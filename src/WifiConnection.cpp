@@ -0,0 +1,155 @@
+/**
+ * Conexion a la red WiFi sin bloquear. Ver WifiConnection.h
+ *
+ * JJTeam - 2021
+ */
+
+#include <WiFi.h>
+#include "WifiConnection.h"
+
+static WifiConnState state = WifiConnState::Idle;
+static const char *ssid = nullptr;
+static const char *password = nullptr;
+static unsigned long stateStart = 0; // millis() en que se entro al estado actual
+static uint32_t retryDelay = 0;      // espera hasta el proximo intento (ms)
+static uint8_t failures = 0;         // intentos fallidos seguidos
+
+// los eventos llegan desde la tarea de WiFi, aca solo se anotan y se procesan en el loop.
+static volatile bool gotIP = false;
+static volatile bool disconnected = false;
+static volatile uint8_t disconnectReason = 0;
+
+static void onWiFiEvent(WiFiEvent_t event, WiFiEventInfo_t info)
+{
+    switch (event)
+    {
+    case SYSTEM_EVENT_STA_GOT_IP:
+        gotIP = true;
+        break;
+    case SYSTEM_EVENT_STA_DISCONNECTED:
+        disconnectReason = info.disconnected.reason;
+        disconnected = true;
+        break;
+    default:
+        break;
+    }
+}
+
+static void setState(WifiConnState newState)
+{
+    state = newState;
+    stateStart = millis();
+    Serial.printf("WiFi: %s\n", WifiConnectionStateName());
+}
+
+static void beginConnect()
+{
+    gotIP = false;
+    disconnected = false;
+    WiFi.begin(ssid, password); // no bloquea, el resultado llega por eventos
+    setState(WifiConnState::Connecting);
+}
+
+// espera exponencial: 2s, 4s, 8s... hasta WIFI_RETRY_MAX, con hasta un 50% mas al azar
+static void scheduleRetry()
+{
+    uint32_t base = WIFI_RETRY_MIN << min(failures, (uint8_t)8);
+    base = min(base, (uint32_t)WIFI_RETRY_MAX);
+    retryDelay = base + random(base / 2 + 1);
+    if (failures < 255)
+        failures++;
+    Serial.printf("WiFi: no conecta (reason %d), reintento en %u ms\n", disconnectReason, retryDelay);
+    setState(WifiConnState::WaitRetry);
+}
+
+void WifiConnectionBegin()
+{
+    WiFi.setAutoReconnect(false); // los reintentos los maneja la maquina de estados
+    WiFi.onEvent(onWiFiEvent);
+}
+
+void WifiConnectionStart(const char *newSsid, const char *newPassword)
+{
+    ssid = newSsid;
+    password = newPassword;
+    failures = 0;
+
+    if (ssid == nullptr || ssid[0] == 0)
+    {
+        WiFi.disconnect();
+        setState(WifiConnState::Idle);
+    }
+    else if (WiFi.isConnected())
+    {
+        // primero corto la conexion actual, cuando llegue el evento se conecta a la nueva
+        disconnected = false;
+        WiFi.disconnect();
+        setState(WifiConnState::Disconnecting);
+    }
+    else
+        beginConnect();
+}
+
+void WifiConnectionLoop()
+{
+    switch (state)
+    {
+    case WifiConnState::Idle:
+        break;
+
+    case WifiConnState::Disconnecting:
+        if (disconnected || millis() - stateStart > 1000)
+            beginConnect();
+        break;
+
+    case WifiConnState::Connecting:
+        if (gotIP)
+        {
+            failures = 0;
+            disconnected = false;
+            setState(WifiConnState::Connected);
+        }
+        else if (disconnected || millis() - stateStart > WIFI_CONNECT_TIMEOUT)
+        {
+            WiFi.disconnect();
+            scheduleRetry();
+        }
+        break;
+
+    case WifiConnState::Connected:
+        if (disconnected)
+        {
+            failures = 0; // se corto, el primer reintento es rapido
+            scheduleRetry();
+        }
+        break;
+
+    case WifiConnState::WaitRetry:
+        if (millis() - stateStart >= retryDelay)
+            beginConnect();
+        break;
+    }
+}
+
+WifiConnState WifiConnectionState()
+{
+    return state;
+}
+
+const char *WifiConnectionStateName()
+{
+    switch (state)
+    {
+    case WifiConnState::Idle:
+        return "idle";
+    case WifiConnState::Disconnecting:
+        return "disconnecting";
+    case WifiConnState::Connecting:
+        return "connecting";
+    case WifiConnState::Connected:
+        return "connected";
+    case WifiConnState::WaitRetry:
+        return "wait retry";
+    }
+    return "?";
+}
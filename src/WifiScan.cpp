@@ -0,0 +1,121 @@
+/**
+ * Scan de redes WiFi en segundo plano. Ver WifiScan.h
+ *
+ * JJTeam - 2021
+ */
+
+#include <WiFi.h>
+#include "WifiScan.h"
+
+// si un scan falla se espera esto antes de volver a intentar
+#define WIFI_SCAN_RETRY 5000
+
+static WifiScanNet networks[WIFI_SCAN_MAX];
+static int networksCount = 0;
+static bool scanning = false;
+static bool requested = false;
+static bool scanned = false;           // hubo algun scan terminado?
+static unsigned long lastScan = 0;     // millis() del ultimo scan terminado
+static unsigned long lastAttempt = 0;  // millis() del ultimo scan pedido
+static bool attempted = false;         // se pidio alguno? (el primero no espera WIFI_SCAN_RETRY)
+static uint32_t scanInterval = WIFI_SCAN_INTERVAL;
+
+// pasa los resultados al cache, sin repetir SSID y ordenados por señal
+static void storeResults(int n)
+{
+    networksCount = 0;
+    for (int i = 0; i < n; i++)
+    {
+        String ssid = WiFi.SSID(i);
+        if (ssid.isEmpty())
+            continue; // red oculta
+
+        int32_t rssi = WiFi.RSSI(i);
+        int pos = 0;
+        while (pos < networksCount && strcmp(networks[pos].ssid, ssid.c_str()) != 0)
+            pos++;
+
+        if (pos == networksCount)
+        {
+            if (networksCount == WIFI_SCAN_MAX)
+                continue;
+            networksCount++;
+        }
+        else if (networks[pos].rssi >= rssi)
+            continue; // ya estaba con mejor señal
+
+        strlcpy(networks[pos].ssid, ssid.c_str(), sizeof(networks[pos].ssid));
+        networks[pos].rssi = rssi;
+        networks[pos].encryption = WiFi.encryptionType(i);
+    }
+
+    // ordeno por señal (son pocas, alcanza con insercion)
+    for (int i = 1; i < networksCount; i++)
+    {
+        WifiScanNet net = networks[i];
+        int j = i;
+        for (; j > 0 && networks[j - 1].rssi < net.rssi; j--)
+            networks[j] = networks[j - 1];
+        networks[j] = net;
+    }
+}
+
+void WifiScanLoop()
+{
+    if (scanning)
+    {
+        int16_t n = WiFi.scanComplete();
+        if (n == WIFI_SCAN_RUNNING)
+            return;
+
+        scanning = false;
+        if (n >= 0)
+        {
+            storeResults(n);
+            lastScan = millis();
+            scanned = true;
+        }
+        WiFi.scanDelete();
+    }
+
+    // sin intervalo no se escanea nunca solo (ni al arrancar): se espera al primer pedido
+    bool due = scanInterval > 0 && (!scanned || millis() - lastScan >= scanInterval);
+    if ((requested || due) && (!attempted || millis() - lastAttempt >= WIFI_SCAN_RETRY))
+    {
+        attempted = true;
+        lastAttempt = millis();
+        scanning = WiFi.scanNetworks(true) == WIFI_SCAN_RUNNING;
+        if (scanning)
+            requested = false;
+    }
+}
+
+void WifiScanRequest()
+{
+    requested = true;
+}
+
+void WifiScanSetInterval(uint32_t interval)
+{
+    scanInterval = interval;
+}
+
+bool WifiScanRunning()
+{
+    return scanning;
+}
+
+uint32_t WifiScanAge()
+{
+    return scanned ? millis() - lastScan : UINT32_MAX;
+}
+
+int WifiScanCount()
+{
+    return networksCount;
+}
+
+const WifiScanNet &WifiScanGet(int index)
+{
+    return networks[index];
+}
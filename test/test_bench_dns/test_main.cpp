@@ -0,0 +1,102 @@
+/*
+    test_bench_dns: consultas/s que contesta el DNSServer sobre MemUdp (sin red, sin memoria dinamica),
+    con p50/p99 de cada consulta (push + processNextRequest) en JSON (ver HostBench.h).
+
+    pio test -e native_bench -f test_bench_dns -v
+
+    JJTeam - 2021
+*/
+
+#include <Arduino.h>
+#include <HostBench.h>
+#include <MemUdp.h>
+#include <unity.h>
+#include "DNSServer.h"
+
+#define BENCH_QUERIES 200000
+
+static MemUdp udp;
+static DNSServer dns(udp);
+
+static uint8_t queries[3][64];
+static size_t queriesLen[3];
+
+// consulta A de name
+static size_t buildQuery(uint8_t *q, uint16_t id, const char *name)
+{
+    uint8_t header[12] = {(uint8_t)(id >> 8), (uint8_t)id, 0x01, 0x00, 0x00, 0x01};
+    memcpy(q, header, sizeof(header));
+    size_t n = sizeof(header);
+    while (*name)
+    {
+        const char *dot = strchr(name, '.');
+        size_t len = dot ? dot - name : strlen(name);
+        q[n++] = len;
+        memcpy(q + n, name, len);
+        n += len;
+        name += len + (dot ? 1 : 0);
+    }
+    q[n++] = 0;
+    const uint8_t type[4] = {0x00, 0x01, 0x00, 0x01};
+    memcpy(q + n, type, 4);
+    return n + 4;
+}
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+// rate: el limite por cliente (0 = sin limite); clients: cuantas IPs distintas consultan
+static void bench(const char *name, uint16_t rate, int clients)
+{
+    dns.setRateLimit(rate, rate * 2);
+    DNSServerStats before = dns.stats();
+    HostBench bench(name, BENCH_QUERIES);
+    bench.run([&](uint32_t i)
+              {
+                  int q = i % 3;
+                  udp.push(queries[q], queriesLen[q], IPAddress(172, 217, 28, 2 + i % clients), 5353);
+                  dns.processNextRequest();
+              });
+    DNSServerStats after = dns.stats();
+
+    char extra[96];
+    snprintf(extra, sizeof(extra), "\"clients\":%d,\"answered\":%u,\"refused\":%u", clients,
+             after.answered - before.answered, after.refused - before.refused);
+    bench.report(extra);
+    TEST_ASSERT_TRUE(bench.allocsPerOp() == 0);
+    TEST_ASSERT_EQUAL(0, udp.pending());
+}
+
+void test_bench_no_limit()
+{
+    uint32_t replies = udp.replies();
+    bench("dns.no_limit", 0, 1);
+    TEST_ASSERT_EQUAL(BENCH_QUERIES, udp.replies() - replies);
+}
+
+// con el limite por cliente: los de mas se descartan sin contestar (tambien sin memoria)
+void test_bench_rate_limited()
+{
+    bench("dns.rate_limited", DNS_DEFAULT_RATE, 8);
+}
+
+int main()
+{
+    Serial.mute(true);
+    dns.start(53, "portal.local", IPAddress(172, 217, 28, 1));
+    dns.addZone("*.example.com", IPAddress(172, 217, 28, 1));
+    dns.addZone("*", IPAddress(172, 217, 28, 1));
+    queriesLen[0] = buildQuery(queries[0], 1, "portal.local");
+    queriesLen[1] = buildQuery(queries[1], 2, "www.example.com");
+    queriesLen[2] = buildQuery(queries[2], 3, "connectivitycheck.gstatic.com");
+
+    UNITY_BEGIN();
+    RUN_TEST(test_bench_no_limit);
+    RUN_TEST(test_bench_rate_limited);
+    return UNITY_END();
+}
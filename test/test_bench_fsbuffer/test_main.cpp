@@ -0,0 +1,76 @@
+/*
+    test_bench_fsbuffer: FsBuffer::write() con el archivo abierto entre writes,
+    contra abrir, escribir y cerrar en cada linea (como antes), con demoras parecidas a las de la SD
+    (se cambian con BENCH_FS_LATENCY, ver HostBench.h).
+
+    pio test -e native_bench -f test_bench_fsbuffer -v
+
+    JJTeam - 2021
+*/
+
+#include <Arduino.h>
+#include <HostBench.h>
+#include <MemFS.h>
+#include <unity.h>
+#include "FSBuffer.h"
+
+#define BENCH_LINES 2000
+
+static MemFS memFS;
+static MemFSLatency latency;
+static const char LINE[] = "[I] 12:34:56 Cliente 172.217.28.2 pidio /wifi\n";
+
+void setUp()
+{
+    memFS.clear();
+    memFS.setLatency(latency);
+    memFS.resetCounters();
+}
+
+void tearDown()
+{
+}
+
+static void report(const HostBench &bench)
+{
+    char extra[256];
+    char fs[128];
+    benchFsLatencyJson(fs, sizeof(fs), latency);
+    const MemFSCounters &counters = memFS.counters();
+    snprintf(extra, sizeof(extra), "%s,\"fs_opens\":%u,\"fs_flushes\":%u", fs, counters.opens, counters.flushes);
+    bench.report(extra);
+}
+
+void test_bench_write_lines()
+{
+    FsBuffer buffer;
+    buffer.begin(memFS, true, 64 * 1024, 4, "/log");
+    memFS.resetCounters();
+    HostBench bench("fsbuffer.write", BENCH_LINES);
+    bench.run([&](uint32_t) { buffer.write((const uint8_t *)LINE, sizeof(LINE) - 1); });
+    buffer.sync();
+    report(bench);
+
+    // como se grababa antes: un open/close (con su flush) por linea
+    memFS.resetCounters();
+    HostBench legacy("legacy.open_write_close", BENCH_LINES);
+    legacy.run([&](uint32_t)
+               {
+                   File f = memFS.open("/legacy/buf.0", FILE_APPEND);
+                   f.write((const uint8_t *)LINE, sizeof(LINE) - 1);
+                   f.close();
+               });
+    report(legacy);
+
+    TEST_ASSERT_TRUE(bench.opsPerSecond() > legacy.opsPerSecond());
+    TEST_ASSERT_TRUE(bench.allocsPerOp() < 0.1); // solo al rotar los archivos
+}
+
+int main()
+{
+    Serial.mute(true);
+    latency = benchFsLatency(200, 20, 20, 500); // us, del orden de una micro-SD por SPI
+    UNITY_BEGIN();
+    RUN_TEST(test_bench_write_lines);
+    return UNITY_END();
+}
@@ -0,0 +1,85 @@
+/*
+    test_bench_http: el portal entero (setup()) atendiendo pedidos en RAM (MemClient),
+    con demoras de la micro-SD en MemFS (se cambian con BENCH_FS_LATENCY, ver HostBench.h):
+      - /              handleRoot
+      - /logs?tail=50  handleLogsPage (va directo a las lineas con el indice)
+      - /logs          handleLogs (todas las lineas)
+
+    pio test -e native_bench -f test_bench_http -v
+
+    JJTeam - 2021
+*/
+
+#include <Arduino.h>
+#include <HostBench.h>
+#include <MemClient.h>
+#include <SD.h>
+#include <WebServer.h>
+#include <unity.h>
+#include "FSLog.h"
+
+#define BENCH_REQUESTS 500
+#define BENCH_LOG_LINES 200
+
+extern WebServer server;
+
+static MemFSLatency latency;
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+static void bench(const char *name, const char *request, const char *expect)
+{
+    MemClient client(request);
+    HostBench bench(name, BENCH_REQUESTS);
+    bench.run([&](uint32_t)
+              {
+                  client.reset(request);
+                  server.handleClient(client);
+              });
+
+    char extra[160];
+    char fs[128];
+    benchFsLatencyJson(fs, sizeof(fs), latency);
+    snprintf(extra, sizeof(extra), "%s,\"response_bytes\":%u", fs, (unsigned)client.response().size());
+    bench.report(extra);
+    TEST_ASSERT_TRUE(client.response().find(expect) != std::string::npos);
+}
+
+void test_bench_root()
+{
+    bench("http.root", "GET / HTTP/1.1\r\nHost: 172.217.28.1\r\n\r\n", "HTTP/1.1 200");
+}
+
+void test_bench_logs_tail()
+{
+    bench("http.logs_tail", "GET /logs?tail=50 HTTP/1.1\r\nHost: 172.217.28.1\r\n\r\n", "X-Next-Seq");
+}
+
+void test_bench_logs()
+{
+    bench("http.logs", "GET /logs HTTP/1.1\r\nHost: 172.217.28.1\r\n\r\n", "Logs hist");
+}
+
+int main()
+{
+    Serial.mute(true);
+    setenv("HOST_PORT_OFFSET", "20000", 0); // los servidores de setup() no piden root
+    latency = benchFsLatency(200, 20, 20, 500);
+    SD.setLatency(latency);
+    setup();
+    for (int i = 0; i < BENCH_LOG_LINES; i++)
+        LogInfo("Cliente 172.217.28.%d pidio /wifi (%d)", i % 250, i);
+    FSLOG.flush();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_bench_root);
+    RUN_TEST(test_bench_logs_tail);
+    RUN_TEST(test_bench_logs);
+    return UNITY_END();
+}
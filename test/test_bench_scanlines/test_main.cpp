@@ -0,0 +1,99 @@
+/*
+    test_bench_scanlines: lectura de lineas con FsBuffer::scanLines() (bloques en el stack)
+    contra la de antes (readStringUntil('\n'), un String por linea). Cada operacion es leer el archivo
+    entero (BENCH_LINES lineas); el JSON tambien trae lineas/s (ver HostBench.h).
+
+    pio test -e native_bench -f test_bench_scanlines -v
+
+    JJTeam - 2021
+*/
+
+#include <Arduino.h>
+#include <HostBench.h>
+#include <MemFS.h>
+#include <unity.h>
+#include "FSBuffer.h"
+
+#define BENCH_LINES 20000
+#define BENCH_ROUNDS 20
+
+static MemFS memFS;
+static MemFSLatency latency;
+static uint32_t seen;
+
+class TestBuffer : public FsBuffer
+{
+public:
+    using FsBuffer::scanLines;
+};
+
+static void countLine(const char *line, size_t len, void *ctx)
+{
+    seen += len;
+}
+
+// como se leia antes (sin cortar en las lineas vacias, para comparar lo mismo)
+static void legacyScan(File &f)
+{
+    String line;
+    while (f.available())
+    {
+        line = f.readStringUntil('\n');
+        seen += line.length();
+    }
+}
+
+template <typename Scan>
+static void run(HostBench &bench, Scan scan)
+{
+    bench.run([&](uint32_t)
+              {
+                  File f = memFS.open("/log/buf.0", FILE_READ);
+                  scan(f);
+                  f.close();
+              });
+    char extra[64];
+    snprintf(extra, sizeof(extra), "\"lines_per_s\":%.0f,\"allocs_per_line\":%.3f",
+             bench.opsPerSecond() * BENCH_LINES, bench.allocsPerOp() / BENCH_LINES);
+    bench.report(extra);
+}
+
+void setUp()
+{
+    memFS.clear();
+    memFS.setLatency(MemFSLatency());
+    memFS.mkdir("/log");
+    File f = memFS.open("/log/buf.0", FILE_WRITE);
+    for (int i = 0; i < BENCH_LINES; i++)
+        f.printf("[I] 12:34:%02d Cliente 172.217.28.%d pidio /wifi (%d)\n", i % 60, i % 250, i);
+    f.close();
+    memFS.setLatency(latency);
+}
+
+void tearDown()
+{
+}
+
+void test_bench_scan_lines()
+{
+    TestBuffer buffer;
+    seen = 0;
+    HostBench after("fsbuffer.scanlines", BENCH_ROUNDS);
+    run(after, [&](File &f) { buffer.scanLines(f, 0, UINT32_MAX, countLine, nullptr); });
+    uint32_t seenAfter = seen;
+    seen = 0;
+    HostBench before("legacy.read_string_until", BENCH_ROUNDS);
+    run(before, legacyScan);
+
+    TEST_ASSERT_EQUAL(seen, seenAfter); // leyeron lo mismo
+    TEST_ASSERT_TRUE(after.opsPerSecond() > before.opsPerSecond());
+    TEST_ASSERT_TRUE(after.allocsPerOp() / BENCH_LINES < 0.01);
+}
+
+int main()
+{
+    latency = benchFsLatency(0, 0, 0, 0); // sin demoras: lo que cuesta partir las lineas
+    UNITY_BEGIN();
+    RUN_TEST(test_bench_scan_lines);
+    return UNITY_END();
+}
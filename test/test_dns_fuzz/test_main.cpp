@@ -0,0 +1,236 @@
+/*
+    test_dns_fuzz: paquetes DNS rotos (al azar, cortados, mutados, con punteros en loop...)
+    contra el DNSServer sobre MemUdp. Cantidad fija de casos y semilla fija (siempre los mismos),
+    y nada puede pedir memoria: ni el parser ni las respuestas.
+
+    pio test -e native -f test_dns_fuzz
+
+    JJTeam - 2021
+*/
+
+#include <Arduino.h>
+#include <MemUdp.h>
+#include <unity.h>
+#include "DNSServer.h"
+#include "MemStats.h"
+
+#define FUZZ_CASES 20000
+#define HEADER_SIZE sizeof(DNSHeader)
+
+static MemUdp udp;
+static DNSServer dns(udp);
+static uint32_t seed;
+static uint32_t allocsStart, bytesStart;
+
+// xorshift32: rapido y repetible
+static uint32_t rnd()
+{
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return seed;
+}
+
+// consulta A de "www.example.com", con un OPT al final si edns
+static size_t validQuery(uint8_t *q, bool edns)
+{
+    static const uint8_t query[] = {
+        0xab, 0xcd, 0x01, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        3, 'w', 'w', 'w', 7, 'e', 'x', 'a', 'm', 'p', 'l', 'e', 3, 'c', 'o', 'm', 0,
+        0x00, 0x01, 0x00, 0x01};
+    static const uint8_t opt[] = {0, 0x00, 0x29, 0x10, 0x00, 0, 0, 0x00, 0x00, 0x00, 0x00};
+    memcpy(q, query, sizeof(query));
+    if (!edns)
+        return sizeof(query);
+    q[11] = 1; // ARCOUNT
+    memcpy(q + sizeof(query), opt, sizeof(opt));
+    return sizeof(query) + sizeof(opt);
+}
+
+// manda el paquete y revisa la respuesta (si hubo)
+static void check(const uint8_t *packet, size_t length)
+{
+    uint32_t replies = udp.replies();
+    TEST_ASSERT_TRUE(udp.push(packet, length, IPAddress(172, 217, 28, 2), 5353));
+    dns.processNextRequest();
+    TEST_ASSERT_EQUAL(0, udp.pending());
+
+    uint32_t sent = udp.replies() - replies;
+    TEST_ASSERT_TRUE(sent <= 1);
+    if (sent == 0)
+        return;
+
+    const uint8_t *reply = udp.reply();
+    size_t len = udp.replyLength();
+    TEST_ASSERT_TRUE(len >= HEADER_SIZE && len <= MAX_DNS_PACKETSIZE + DNS_REPLY_EXTRA);
+    TEST_ASSERT_TRUE(length >= HEADER_SIZE && length <= MAX_DNS_PACKETSIZE);
+    TEST_ASSERT_EQUAL_MEMORY(packet, reply, 2); // mismo ID
+    TEST_ASSERT_TRUE(reply[2] & 0x80);          // QR: es una respuesta
+    uint16_t qdcount = reply[4] << 8 | reply[5];
+    TEST_ASSERT_TRUE(qdcount <= 1);
+}
+
+void setUp()
+{
+    seed = 0x2021;
+    MemStatsTask(allocsStart, bytesStart);
+}
+
+// ningun caso pidio memoria
+void tearDown()
+{
+    uint32_t allocs, bytes;
+    MemStatsTask(allocs, bytes);
+    TEST_ASSERT_EQUAL(allocsStart, allocs);
+}
+
+void test_random_bytes()
+{
+    uint8_t packet[MAX_DNS_PACKETSIZE + 64];
+    for (int i = 0; i < FUZZ_CASES; i++)
+    {
+        size_t length = rnd() % sizeof(packet);
+        for (size_t k = 0; k < length; k++)
+            packet[k] = rnd();
+        check(packet, length);
+    }
+}
+
+// un encabezado de consulta valido y el resto al azar (llega mas lejos en el parser)
+void test_random_body()
+{
+    uint8_t packet[MAX_DNS_PACKETSIZE];
+    for (int i = 0; i < FUZZ_CASES; i++)
+    {
+        size_t length = HEADER_SIZE + rnd() % (sizeof(packet) - HEADER_SIZE);
+        for (size_t k = 0; k < length; k++)
+            packet[k] = rnd() % 4 == 0 ? rnd() % 64 : rnd(); // muchos largos de label chicos
+        packet[2] = 0x01;
+        packet[3] = 0x00;
+        packet[4] = 0;
+        packet[5] = 1 + rnd() % 3;
+        packet[6] = packet[8] = packet[10] = 0;
+        packet[7] = rnd() % 2;
+        packet[9] = rnd() % 2;
+        packet[11] = rnd() % 3;
+        check(packet, length);
+    }
+}
+
+void test_truncated()
+{
+    uint8_t packet[64];
+    for (int edns = 0; edns < 2; edns++)
+    {
+        size_t length = validQuery(packet, edns);
+        for (size_t cut = 0; cut <= length; cut++)
+            check(packet, cut);
+    }
+}
+
+// consultas validas con algunos bytes cambiados
+void test_mutated()
+{
+    uint8_t packet[MAX_DNS_PACKETSIZE];
+    for (int i = 0; i < FUZZ_CASES; i++)
+    {
+        size_t length = validQuery(packet, rnd() % 2);
+        int changes = 1 + rnd() % 4;
+        for (int k = 0; k < changes; k++)
+        {
+            switch (rnd() % 3)
+            {
+            case 0:
+                packet[rnd() % length] = rnd();
+                break;
+            case 1:
+                packet[rnd() % length] ^= 1 << (rnd() % 8);
+                break;
+            default:
+                if (length < sizeof(packet))
+                    packet[length++] = rnd(); // basura al final
+            }
+        }
+        check(packet, length);
+    }
+}
+
+// los contadores del encabezado dicen mucho mas de lo que hay
+void test_huge_counts()
+{
+    uint8_t packet[64];
+    size_t length = validQuery(packet, false);
+    for (size_t i = 4; i < HEADER_SIZE; i++)
+        packet[i] = 0xff;
+    check(packet, length);
+}
+
+// punteros de compresion que apuntan a si mismos, hacia adelante, o fuera del paquete
+void test_compression_pointers()
+{
+    uint8_t packet[64];
+    const uint16_t targets[] = {12, 13, 14, 0, 0x3fff, 40};
+    for (uint16_t target : targets)
+    {
+        size_t length = validQuery(packet, true);
+        // el nombre del OPT (al final) pasa a ser un puntero
+        size_t opt = length - 11;
+        memmove(packet + opt + 1, packet + opt, 11);
+        packet[opt] = 0xc0 | target >> 8;
+        packet[opt + 1] = target;
+        check(packet, length + 1);
+
+        // y la pregunta tambien
+        length = validQuery(packet, false);
+        packet[HEADER_SIZE] = 0xc0 | target >> 8;
+        packet[HEADER_SIZE + 1] = target;
+        check(packet, length);
+    }
+}
+
+// una etiqueta de mas de 63 bytes, y un nombre que llega justo al final del paquete
+void test_long_labels()
+{
+    uint8_t packet[MAX_DNS_PACKETSIZE];
+    size_t length = validQuery(packet, false);
+    packet[HEADER_SIZE] = 64;
+    check(packet, length);
+
+    memset(packet + HEADER_SIZE, 63, sizeof(packet) - HEADER_SIZE);
+    check(packet, sizeof(packet));
+}
+
+// y las que estan bien se siguen contestando
+void test_valid_still_answered()
+{
+    uint8_t packet[64];
+    for (int edns = 0; edns < 2; edns++)
+    {
+        uint32_t answered = dns.stats().answered;
+        size_t length = validQuery(packet, edns);
+        check(packet, length);
+        TEST_ASSERT_EQUAL(answered + 1, dns.stats().answered);
+        const uint8_t *reply = udp.reply();
+        TEST_ASSERT_EQUAL(0, reply[3] & 0x0f); // NOERROR
+        TEST_ASSERT_EQUAL(1, reply[7]);        // ANCOUNT
+        TEST_ASSERT_EQUAL(edns, reply[11]);    // ARCOUNT: el OPT
+    }
+}
+
+int main()
+{
+    Serial.mute(true);
+    dns.setRateLimit(0, 0); // todos los casos vienen del mismo cliente
+    dns.start(53, "*", IPAddress(172, 217, 28, 1));
+
+    UNITY_BEGIN();
+    RUN_TEST(test_random_bytes);
+    RUN_TEST(test_random_body);
+    RUN_TEST(test_truncated);
+    RUN_TEST(test_mutated);
+    RUN_TEST(test_huge_counts);
+    RUN_TEST(test_compression_pointers);
+    RUN_TEST(test_long_labels);
+    RUN_TEST(test_valid_still_answered);
+    return UNITY_END();
+}
@@ -0,0 +1,105 @@
+/*
+    test_eeprom: la EEPROM en RAM y las credenciales de WifiCheck que se guardan en ella.
+
+    pio test -e native -f test_eeprom
+
+    JJTeam - 2021
+*/
+
+#include <Arduino.h>
+#include <EEPROM.h>
+#include <unity.h>
+
+extern char ssid[33];
+extern char password[20];
+extern void loadCredentials();
+extern void saveCredentials();
+
+void setUp()
+{
+    EEPROM.erase();
+}
+
+void tearDown()
+{
+}
+
+void test_erased()
+{
+    EEPROM.begin(16);
+    for (int i = 0; i < 16; i++)
+        TEST_ASSERT_EQUAL_HEX8(0xFF, EEPROM.read(i));
+    EEPROM.end();
+}
+
+void test_put_get()
+{
+    struct
+    {
+        uint32_t a;
+        char b[8];
+    } in = {1234, "hola"}, out = {};
+
+    EEPROM.begin(64);
+    EEPROM.put(10, in);
+    EEPROM.end(); // end() hace commit()
+
+    EEPROM.begin(64);
+    EEPROM.get(10, out);
+    EEPROM.end();
+    TEST_ASSERT_EQUAL(1234, out.a);
+    TEST_ASSERT_EQUAL_STRING("hola", out.b);
+}
+
+// sin commit() lo escrito no llega a la flash
+void test_uncommitted()
+{
+    EEPROM.begin(16);
+    EEPROM.write(0, 7);
+    TEST_ASSERT_EQUAL(7, EEPROM.read(0));
+    EEPROM.begin(16); // vuelve a copiar la flash
+    TEST_ASSERT_EQUAL_HEX8(0xFF, EEPROM.read(0));
+    EEPROM.end();
+}
+
+// grabar lo mismo que ya esta no gasta la flash
+void test_commit_only_when_dirty()
+{
+    EEPROM.begin(16);
+    EEPROM.put(0, (uint32_t)42);
+    TEST_ASSERT_TRUE(EEPROM.commit());
+    uint32_t commits = EEPROM.commits();
+    EEPROM.put(0, (uint32_t)42);
+    EEPROM.commit();
+    EEPROM.end();
+    TEST_ASSERT_EQUAL(commits, EEPROM.commits());
+}
+
+void test_credentials()
+{
+    strcpy(ssid, "Casa");
+    strcpy(password, "secreto");
+    saveCredentials();
+    ssid[0] = 0;
+    password[0] = 0;
+    loadCredentials();
+    TEST_ASSERT_EQUAL_STRING("Casa", ssid);
+    TEST_ASSERT_EQUAL_STRING("secreto", password);
+
+    EEPROM.erase(); // sin el "OK" no hay credenciales
+    loadCredentials();
+    TEST_ASSERT_EQUAL_STRING("", ssid);
+    TEST_ASSERT_EQUAL_STRING("", password);
+}
+
+int main()
+{
+    Serial.mute(true);
+    UNITY_BEGIN();
+    RUN_TEST(test_erased);
+    RUN_TEST(test_put_get);
+    RUN_TEST(test_uncommitted);
+    RUN_TEST(test_commit_only_when_dirty);
+    RUN_TEST(test_credentials);
+    return UNITY_END();
+}
@@ -0,0 +1,197 @@
+/*
+    test_fs: MemFS (el file system en RAM del env:native) y FsBuffer encima de el.
+
+    pio test -e native -f test_fs
+
+    JJTeam - 2021
+*/
+
+#include <Arduino.h>
+#include <MemFS.h>
+#include <unity.h>
+#include <string>
+#include "FSBuffer.h"
+
+static MemFS memFS;
+
+void setUp()
+{
+    memFS.clear();
+    memFS.setLatency(MemFSLatency());
+    memFS.resetCounters();
+}
+
+void tearDown()
+{
+}
+
+static void collect(const char *line, size_t len, void *ctx)
+{
+    std::string &out = *(std::string *)ctx;
+    out.append(line, len);
+    out += '|';
+}
+
+void test_write_read()
+{
+    File f = memFS.open("/a.txt", FILE_WRITE);
+    TEST_ASSERT_TRUE(f);
+    f.print("hola\nmundo\n");
+    f.close();
+
+    f = memFS.open("/a.txt", FILE_READ);
+    TEST_ASSERT_EQUAL(11, f.size());
+    TEST_ASSERT_EQUAL_STRING("hola", f.readStringUntil('\n').c_str());
+    TEST_ASSERT_EQUAL_STRING("mundo", f.readStringUntil('\n').c_str());
+    TEST_ASSERT_EQUAL(-1, f.read());
+    f.close();
+}
+
+void test_missing_file()
+{
+    TEST_ASSERT_FALSE(memFS.open("/no.txt", FILE_READ));
+    TEST_ASSERT_FALSE(memFS.exists("/no.txt"));
+}
+
+// como en la SD: lo escrito lo ven los demas recien despues del flush()
+void test_flush_visibility()
+{
+    File w = memFS.open("/b.txt", FILE_APPEND);
+    w.print("12345");
+    TEST_ASSERT_EQUAL(5, w.size());
+    TEST_ASSERT_EQUAL(0, memFS.open("/b.txt", FILE_READ).size());
+    w.flush();
+    TEST_ASSERT_EQUAL(5, memFS.open("/b.txt", FILE_READ).size());
+    TEST_ASSERT_EQUAL(1, memFS.counters().flushes);
+    w.flush(); // sin nada pendiente no baja nada
+    TEST_ASSERT_EQUAL(1, memFS.counters().flushes);
+    w.close();
+}
+
+void test_append_and_truncate()
+{
+    File f = memFS.open("/c.txt", FILE_WRITE);
+    f.print("abc");
+    f.close();
+    f = memFS.open("/c.txt", FILE_APPEND);
+    f.print("def");
+    f.close();
+    TEST_ASSERT_EQUAL_STRING("abcdef", memFS.contents("/c.txt").c_str());
+
+    f = memFS.open("/c.txt", FILE_WRITE);
+    f.print("x");
+    f.close();
+    TEST_ASSERT_EQUAL_STRING("x", memFS.contents("/c.txt").c_str());
+}
+
+void test_seek()
+{
+    File f = memFS.open("/d.txt", FILE_WRITE);
+    f.print("0123456789");
+    f.close();
+    f = memFS.open("/d.txt", FILE_READ);
+    TEST_ASSERT_TRUE(f.seek(7));
+    TEST_ASSERT_EQUAL('7', f.read());
+    TEST_ASSERT_FALSE(f.seek(11));
+    f.close();
+}
+
+void test_remove_rename_mkdir()
+{
+    memFS.open("/e.txt", FILE_WRITE).close();
+    TEST_ASSERT_TRUE(memFS.rename("/e.txt", "/f.txt"));
+    TEST_ASSERT_FALSE(memFS.exists("/e.txt"));
+    TEST_ASSERT_TRUE(memFS.remove("/f.txt"));
+    TEST_ASSERT_FALSE(memFS.exists("/f.txt"));
+
+    memFS.mkdir("/logs");
+    TEST_ASSERT_TRUE(memFS.open("/logs").isDirectory());
+}
+
+void test_latency()
+{
+    MemFSLatency latency;
+    latency.flush = 2000;
+    memFS.setLatency(latency);
+    File f = memFS.open("/g.txt", FILE_WRITE);
+    f.print("x");
+    uint32_t start = micros();
+    f.close();
+    TEST_ASSERT_GREATER_OR_EQUAL(2000, micros() - start);
+}
+
+// FsBuffer sobre MemFS: rota entre los archivos y las lineas vuelven en orden
+void test_fsbuffer_lines()
+{
+    FsBuffer buffer;
+    buffer.begin(memFS, true, 64, 3, "/buf");
+    for (int i = 0; i < 20; i++)
+        buffer.printf("linea %d\n", i);
+    buffer.sync();
+
+    TEST_ASSERT_EQUAL(20, buffer.nextSeq());
+    TEST_ASSERT_EQUAL_STRING("linea 17\nlinea 18\nlinea 19\n", memFS.contents("/buf/buf.2").c_str());
+    TEST_ASSERT_EQUAL_STRING("fileIndexActual=2\ntotalFiles=3\nseqInicial=17\n", memFS.contents("/buf/buffers.cfg").c_str());
+
+    std::string lines;
+    TEST_ASSERT_EQUAL(0, buffer.firstSeq());
+    buffer.forEachLineFrom(0, 100, collect, &lines);
+    std::string expected;
+    for (int i = 0; i < 20; i++)
+        expected += "linea " + std::to_string(i) + "|";
+    TEST_ASSERT_EQUAL_STRING(expected.c_str(), lines.c_str());
+}
+
+// un buffers.cfg con un indice fuera de rango no rompe nada: se sigue en un archivo nuevo
+void test_fsbuffer_bad_config()
+{
+    memFS.mkdir("/buf");
+    File f = memFS.open("/buf/buffers.cfg", FILE_WRITE);
+    f.print("fileIndexActual=9\ntotalFiles=10\nseqInicial=5\n");
+    f.close();
+
+    FsBuffer buffer;
+    buffer.begin(memFS, true, 64, 3, "/buf");
+    buffer.print("hola\n");
+    buffer.sync();
+    TEST_ASSERT_EQUAL_STRING("hola\n", memFS.contents("/buf/buf.0").c_str());
+    TEST_ASSERT_EQUAL(6, buffer.nextSeq());
+}
+
+// forEachLineFrom() lee lo que todavia no bajo a disco, y devuelve hasta donde entrego de verdad
+void test_fsbuffer_lines_from()
+{
+    FsBuffer buffer;
+    buffer.begin(memFS, true, 64, 3, "/buf");
+    for (int i = 0; i < 12; i++)
+        buffer.printf("linea %d\n", i);
+
+    std::string lines;
+    TEST_ASSERT_EQUAL(12, buffer.forEachLineFrom(10, 5, collect, &lines));
+    TEST_ASSERT_EQUAL_STRING("linea 10|linea 11|", lines.c_str());
+    TEST_ASSERT_EQUAL(12, buffer.forEachLineFrom(0, 100, nullptr));
+
+    // el primer archivo quedo con menos lineas que las del indice: se corta ahi
+    File f = memFS.open("/buf/buf.0", FILE_WRITE);
+    f.print("linea 0\nlinea 1\n");
+    f.close();
+    lines.clear();
+    TEST_ASSERT_EQUAL(2, buffer.forEachLineFrom(0, 100, collect, &lines));
+    TEST_ASSERT_EQUAL_STRING("linea 0|linea 1|", lines.c_str());
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_write_read);
+    RUN_TEST(test_missing_file);
+    RUN_TEST(test_flush_visibility);
+    RUN_TEST(test_append_and_truncate);
+    RUN_TEST(test_seek);
+    RUN_TEST(test_remove_rename_mkdir);
+    RUN_TEST(test_latency);
+    RUN_TEST(test_fsbuffer_lines);
+    RUN_TEST(test_fsbuffer_bad_config);
+    RUN_TEST(test_fsbuffer_lines_from);
+    return UNITY_END();
+}
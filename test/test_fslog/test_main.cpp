@@ -0,0 +1,111 @@
+/*
+    test_fslog: la cola en RAM de FsLog y la tarea que la baja al FS (MemFS).
+
+    pio test -e native -f test_fslog
+
+    JJTeam - 2021
+*/
+
+#include <Arduino.h>
+#include <MemFS.h>
+#include <unity.h>
+#include <string>
+#include <vector>
+#include "FSLog.h"
+
+#define LOG_LINES 400
+
+static MemFS memFS;
+static FsLog fslog;
+static std::vector<std::string> lines;
+
+static void collect(const char *line, size_t len, void *ctx)
+{
+    lines.push_back(std::string(line, len));
+}
+
+// las lineas que hay en los archivos desde seq
+static void readFrom(uint32_t seq)
+{
+    lines.clear();
+    fslog.forEachLineFrom(seq, UINT32_MAX, collect);
+}
+
+void setUp()
+{
+    memFS.setLatency(MemFSLatency());
+    fslog.clear();
+}
+
+void tearDown()
+{
+}
+
+// write() directo va despues de lo que ya estaba en la cola
+void test_write_after_queue()
+{
+    uint32_t seq = fslog.nextSeq();
+    fslog.log(FsLogNivel::Info, "uno\n");
+    fslog.log(FsLogNivel::Info, "dos\n");
+    fslog.print("directo\n");
+    fslog.log(FsLogNivel::Info, "tres\n");
+    fslog.flush();
+
+    readFrom(seq);
+    TEST_ASSERT_EQUAL(4, lines.size());
+    TEST_ASSERT_EQUAL_STRING("uno", lines[0].c_str());
+    TEST_ASSERT_EQUAL_STRING("dos", lines[1].c_str());
+    TEST_ASSERT_EQUAL_STRING("directo", lines[2].c_str());
+    TEST_ASSERT_EQUAL_STRING("tres", lines[3].c_str());
+}
+
+// con el FS lento la cola se llena: se pierden las mas viejas, de a lineas enteras y en orden
+void test_drop_oldest()
+{
+    MemFSLatency slow;
+    slow.write = 50000;
+    memFS.setLatency(slow);
+
+    uint32_t seq = fslog.nextSeq();
+    uint32_t dropped = fslog.getDroppedLines();
+    for (int i = 0; i < LOG_LINES; i++)
+        fslog.log(FsLogNivel::Info, "linea %04d ...................................\n", i);
+    memFS.setLatency(MemFSLatency());
+    fslog.flush();
+
+    dropped = fslog.getDroppedLines() - dropped;
+    TEST_ASSERT_TRUE(dropped > 0);
+    readFrom(seq);
+    TEST_ASSERT_EQUAL(LOG_LINES, lines.size() + dropped);
+    int last = -1;
+    for (const std::string &line : lines)
+    {
+        int n = -1;
+        TEST_ASSERT_EQUAL(1, sscanf(line.c_str(), "linea %d", &n));
+        TEST_ASSERT_EQUAL(46, line.size()); // entera
+        TEST_ASSERT_TRUE(n > last);
+        last = n;
+    }
+    TEST_ASSERT_EQUAL(LOG_LINES - 1, last); // la ultima siempre queda
+}
+
+// clear() borra los archivos y tambien lo que estaba en la cola
+void test_clear()
+{
+    fslog.log(FsLogNivel::Info, "vieja\n");
+    fslog.clear();
+    fslog.flush();
+    readFrom(fslog.firstSeq());
+    TEST_ASSERT_EQUAL(0, lines.size());
+}
+
+int main()
+{
+    Serial.mute(true);
+    fslog.begin(memFS, true, Serial, 64 * 1024);
+    UNITY_BEGIN();
+    RUN_TEST(test_write_after_queue);
+    RUN_TEST(test_drop_oldest);
+    RUN_TEST(test_clear);
+    return UNITY_END();
+}
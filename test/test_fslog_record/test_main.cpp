@@ -0,0 +1,186 @@
+/*
+    test_fslog_record: FsLogEncode() + FsLogRender() tiene que dar el mismo texto que vsnprintf().
+
+    pio test -e native -f test_fslog_record
+
+    JJTeam - 2021
+*/
+
+#include <Arduino.h>
+#include <unity.h>
+#include <limits.h>
+#include "FSLogRecord.h"
+
+static char record[512];
+static size_t recordLen;
+
+static size_t encode(const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    recordLen = FsLogEncode(record, sizeof(record), format, args);
+    va_end(args);
+    return recordLen;
+}
+
+// graba el registro, lo vuelve a armar, y lo compara con lo que da vsnprintf
+static void roundTrip(int line, const char *format, ...)
+{
+    char expected[512];
+    va_list args;
+    va_start(args, format);
+    va_list copy;
+    va_copy(copy, args);
+    vsnprintf(expected, sizeof(expected), format, copy);
+    va_end(copy);
+    recordLen = FsLogEncode(record, sizeof(record), format, args);
+    va_end(args);
+
+    // una sola linea: empieza con la marca y el unico '\n' es el del final
+    TEST_ASSERT_TRUE(FsLogIsRecord(record, recordLen));
+    TEST_ASSERT_EQUAL('\n', record[recordLen - 1]);
+    TEST_ASSERT_NULL(memchr(record, '\n', recordLen - 1));
+    TEST_ASSERT_NULL(memchr(record, 0, recordLen));
+
+    char text[512];
+    size_t len = FsLogRender(record, recordLen, text, sizeof(text));
+    if (strcmp(expected, text) != 0)
+    {
+        char msg[1100];
+        snprintf(msg, sizeof(msg), "\"%s\": [%s] != [%s]", format, expected, text);
+        UnityFail(msg, line);
+    }
+    TEST_ASSERT_EQUAL(strlen(expected), len);
+}
+
+#define ROUND_TRIP(...) roundTrip(__LINE__, __VA_ARGS__)
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+void test_no_args()
+{
+    ROUND_TRIP("Inicio del sistema");
+    ROUND_TRIP("100%% listo");
+}
+
+void test_ints()
+{
+    ROUND_TRIP("%d %i %u", -5, INT_MAX, 4000000000u);
+    ROUND_TRIP("%x %X %o %#x", 0xbeef, 0xCAFE, 0755, 255);
+    ROUND_TRIP("%c%c %hhd %hu", 'o', 'k', (signed char)-3, (unsigned short)65535);
+    ROUND_TRIP("%5d|%-5d|%05d|%+d", 42, 42, 42, 42);
+    ROUND_TRIP("%x", 0x0a000a1b); // bytes que hay que escapar
+}
+
+void test_longs()
+{
+    ROUND_TRIP("%ld %lu", LONG_MIN, ULONG_MAX);
+    ROUND_TRIP("%lld %llu %llx", LLONG_MIN, ULLONG_MAX, 0x0123456789abcdefULL);
+    ROUND_TRIP("%zu %zd", (size_t)123456, (ssize_t)-7);
+    ROUND_TRIP("%p", (void *)record);
+}
+
+void test_floats()
+{
+    ROUND_TRIP("%f %.2f %e %g", 3.5, -0.125, 12345.678, 0.0001);
+    ROUND_TRIP("%8.3f|", 2.0 / 3);
+}
+
+void test_stars()
+{
+    ROUND_TRIP("[%*d] [%-*s] [%.*s]", 6, 12, 8, "izq", 3, "cortado");
+    ROUND_TRIP("[%*.*f]", 10, 3, 3.14159);
+}
+
+void test_strings()
+{
+    ROUND_TRIP("ssid=%s pass=%s", "Casa", "");
+    ROUND_TRIP("%s", "con\nenter \x1b escape \x1e marca");
+    ROUND_TRIP("%s %d %s", "a", 1, "b");
+    ROUND_TRIP("%.20s", "1234567890123456789012345");
+}
+
+// los strings se guardan hasta FSLOG_REC_MAX_STR caracteres
+void test_long_string()
+{
+    char s[FSLOG_REC_MAX_STR * 2];
+    memset(s, 'x', sizeof(s) - 1);
+    s[sizeof(s) - 1] = 0;
+    encode("%s", s);
+    char text[256];
+    TEST_ASSERT_EQUAL(FSLOG_REC_MAX_STR, FsLogRender(record, recordLen, text, sizeof(text)));
+}
+
+void test_null_string()
+{
+    encode("%s", (const char *)nullptr);
+    char text[32];
+    FsLogRender(record, recordLen, text, sizeof(text));
+    TEST_ASSERT_EQUAL_STRING("(null)", text);
+}
+
+// si los argumentos no entran en el registro, los que faltan salen como '?'
+void test_too_many_args()
+{
+    char s[FSLOG_REC_MAX_STR + 1];
+    memset(s, 's', FSLOG_REC_MAX_STR);
+    s[FSLOG_REC_MAX_STR] = 0;
+    encode("%s %s %s %s", s, s, s, s);
+    char text[512];
+    size_t len = FsLogRender(record, recordLen, text, sizeof(text));
+    TEST_ASSERT_TRUE(len > 0);
+    TEST_ASSERT_EQUAL('?', text[len - 1]);
+}
+
+void test_timestamp()
+{
+    encode("t");
+    uint32_t ms = 0xffffffff;
+    char text[8];
+    FsLogRender(record, recordLen, text, sizeof(text), &ms);
+    TEST_ASSERT_TRUE(ms <= millis());
+}
+
+// el texto se corta al tamaño del buffer de salida
+void test_small_output()
+{
+    encode("%s %d", "abcdefgh", 12345);
+    char text[6];
+    TEST_ASSERT_EQUAL(5, FsLogRender(record, recordLen, text, sizeof(text)));
+    TEST_ASSERT_EQUAL_STRING("abcde", text);
+}
+
+void test_invalid()
+{
+    char text[32];
+    TEST_ASSERT_EQUAL(0, FsLogRender("hola", 4, text, sizeof(text))); // texto comun
+    TEST_ASSERT_EQUAL(0, FsLogRender("\x1e\x01", 2, text, sizeof(text))); // cortado
+
+    // id de formato que no apunta al programa (otro firmware)
+    char bad[] = "\x1e\xff\xff\xff\xff\x01\x01\x01\x01\n";
+    TEST_ASSERT_EQUAL(0, FsLogRender(bad, sizeof(bad) - 1, text, sizeof(text)));
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_no_args);
+    RUN_TEST(test_ints);
+    RUN_TEST(test_longs);
+    RUN_TEST(test_floats);
+    RUN_TEST(test_stars);
+    RUN_TEST(test_strings);
+    RUN_TEST(test_long_string);
+    RUN_TEST(test_null_string);
+    RUN_TEST(test_too_many_args);
+    RUN_TEST(test_timestamp);
+    RUN_TEST(test_small_output);
+    RUN_TEST(test_invalid);
+    return UNITY_END();
+}
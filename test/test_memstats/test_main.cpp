@@ -0,0 +1,200 @@
+/*
+    test_memstats: los contadores por tarea de MemStats y lo que mide cada PERF_SCOPE
+    (pedidos, pico de uso del heap y bloque libre mas grande).
+
+    pio test -e native -f test_memstats
+
+    JJTeam - 2021
+*/
+
+#include <Arduino.h>
+#include <esp_heap_caps.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <unity.h>
+#include "MemStats.h"
+#include "PerfStats.h"
+
+static volatile int allocRequests = 0; // pedidos que tiene que hacer la tarea que solo pide memoria
+static volatile bool stopTasks = false;
+static volatile int running = 0;
+static void *volatile sink; // asi el compilador no saca los malloc/free
+
+static void allocFree(size_t size)
+{
+    sink = malloc(size);
+    free(sink);
+}
+
+// una tarea que solo pide memoria (como las del arranque): no tiene que quedarse con un lugar
+static void allocTask(void *param)
+{
+    __atomic_fetch_add(&running, 1, __ATOMIC_RELAXED);
+    allocFree(32);
+    while (!stopTasks)
+    {
+        if (param != nullptr && allocRequests > 0)
+        {
+            allocFree(16);
+            __atomic_fetch_sub(&allocRequests, 1, __ATOMIC_RELAXED);
+        }
+        else
+            delay(1);
+    }
+    __atomic_fetch_sub(&running, 1, __ATOMIC_RELAXED);
+    vTaskDelete(NULL);
+}
+
+// una tarea que mide y al terminar devuelve su lugar
+static void measureTask(void *param)
+{
+    uint32_t allocs, bytes;
+    MemStatsTask(allocs, bytes);
+    allocFree(8);
+    MemStatsTaskEnd();
+    __atomic_fetch_sub(&running, 1, __ATOMIC_RELAXED);
+    vTaskDelete(NULL);
+}
+
+static void waitRunning(int count)
+{
+    for (int i = 0; i < 1000 && running != count; i++)
+        delay(1);
+    TEST_ASSERT_EQUAL(count, running);
+}
+
+static volatile uint32_t isolatedAllocs;
+
+// una tarea nueva que mide mientras la que solo pide memoria pide 100 veces: no se le tienen que sumar
+static void isolatedTask(void *param)
+{
+    uint32_t allocs0, bytes0, allocs1, bytes1;
+    MemStatsTask(allocs0, bytes0);
+    allocRequests = 100;
+    for (int i = 0; i < 1000 && allocRequests > 0; i++)
+        delay(1);
+    MemStatsTask(allocs1, bytes1);
+    isolatedAllocs = allocs1 - allocs0;
+    MemStatsTaskEnd();
+    __atomic_fetch_sub(&running, 1, __ATOMIC_RELAXED);
+    vTaskDelete(NULL);
+}
+
+static void assertIsolated()
+{
+    int before = running;
+    isolatedAllocs = UINT32_MAX;
+    __atomic_fetch_add(&running, 1, __ATOMIC_RELAXED);
+    xTaskCreate(isolatedTask, "isolated", 2048, nullptr, 1, nullptr);
+    waitRunning(before);
+    TEST_ASSERT_EQUAL(0, allocRequests);
+    TEST_ASSERT_EQUAL(0, isolatedAllocs);
+}
+
+void setUp()
+{
+    stopTasks = false;
+    allocRequests = 0;
+}
+
+void tearDown()
+{
+    stopTasks = true;
+    waitRunning(0);
+}
+
+void test_alloc_only_tasks_take_no_slot()
+{
+    for (int i = 0; i < MEM_STATS_TASKS + 2; i++)
+    {
+        xTaskCreate(allocTask, "alloc", 2048, i == MEM_STATS_TASKS + 1 ? (void *)1 : nullptr, 1, nullptr);
+        waitRunning(i + 1);
+    }
+
+    // la tarea que mide llega despues de todas y tiene su lugar igual
+    assertIsolated();
+}
+
+void test_task_end_frees_slot()
+{
+    xTaskCreate(allocTask, "alloc", 2048, (void *)1, 1, nullptr);
+    waitRunning(1);
+    for (int i = 0; i < 3 * MEM_STATS_TASKS; i++)
+    {
+        __atomic_fetch_add(&running, 1, __ATOMIC_RELAXED);
+        xTaskCreate(measureTask, "measure", 2048, nullptr, 1, nullptr);
+        waitRunning(1);
+    }
+    assertIsolated();
+}
+
+void test_scope_peak()
+{
+    PerfStat *stat = PerfStatGet("test peak");
+    {
+        PERF_SCOPE_STAT(stat);
+        allocFree(20000);
+        allocFree(1000); // despues del pico: no lo cambia
+    }
+    PerfStat copy;
+    int index = PerfStatCount() - 1;
+    TEST_ASSERT_TRUE(PerfStatCopy(index, copy));
+    TEST_ASSERT_EQUAL_STRING("test peak", copy.name);
+    TEST_ASSERT_EQUAL(1, copy.count);
+    TEST_ASSERT_EQUAL(2, copy.allocs);
+    TEST_ASSERT_TRUE(copy.peakHeap >= 20000);
+    TEST_ASSERT_TRUE(copy.peakHeap < 20000 + 4096);
+    TEST_ASSERT_TRUE(copy.minLargest > 0);
+    TEST_ASSERT_TRUE(copy.minLargest <= HOST_HEAP_SIZE - 20000);
+}
+
+void test_scope_without_allocs()
+{
+    PerfStat *stat = PerfStatGet("test nothing");
+    {
+        PERF_SCOPE_STAT(stat);
+    }
+    PerfStat copy;
+    TEST_ASSERT_TRUE(PerfStatCopy(PerfStatCount() - 1, copy));
+    TEST_ASSERT_EQUAL(1, copy.count);
+    TEST_ASSERT_EQUAL(0, copy.allocs);
+    TEST_ASSERT_EQUAL(0, copy.peakHeap);
+    TEST_ASSERT_EQUAL(0, copy.minLargest);
+}
+
+// el de adentro ve solo lo suyo, el de afuera tambien lo que pidio el de adentro
+void test_nested_scopes()
+{
+    PerfStat *outer = PerfStatGet("test outer");
+    PerfStat *inner = PerfStatGet("test inner");
+    int outerIndex = PerfStatCount() - 2;
+    {
+        PERF_SCOPE_STAT(outer);
+        void *kept = sink = malloc(10000);
+        {
+            PERF_SCOPE_STAT(inner);
+            allocFree(5000);
+        }
+        free(kept);
+    }
+    PerfStat o, i;
+    TEST_ASSERT_TRUE(PerfStatCopy(outerIndex, o));
+    TEST_ASSERT_TRUE(PerfStatCopy(outerIndex + 1, i));
+    TEST_ASSERT_EQUAL_STRING("test outer", o.name);
+    TEST_ASSERT_EQUAL(2, o.allocs);
+    TEST_ASSERT_EQUAL(1, i.allocs);
+    TEST_ASSERT_TRUE(i.peakHeap >= 5000 && i.peakHeap < 10000);
+    TEST_ASSERT_TRUE(o.peakHeap >= 15000);
+}
+
+int main()
+{
+    Serial.mute(true);
+    UNITY_BEGIN();
+    RUN_TEST(test_alloc_only_tasks_take_no_slot);
+    RUN_TEST(test_task_end_frees_slot);
+    RUN_TEST(test_scope_peak);
+    RUN_TEST(test_scope_without_allocs);
+    RUN_TEST(test_nested_scopes);
+    return UNITY_END();
+}
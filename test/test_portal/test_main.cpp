@@ -0,0 +1,112 @@
+/*
+    test_portal: las paginas del portal (WifiSetup() entero) con pedidos en RAM (MemClient).
+
+    pio test -e native -f test_portal
+
+    JJTeam - 2021
+*/
+
+#include <Arduino.h>
+#include <MemClient.h>
+#include <WebServer.h>
+#include <unity.h>
+#include <string>
+#include "FSLog.h"
+
+extern WebServer server;
+
+static const IPAddress AP_IP(172, 217, 28, 1);
+static const IPAddress STA_IP(192, 168, 0, 50);
+
+static std::string get(const char *request, IPAddress local = AP_IP)
+{
+    MemClient client(request, local);
+    server.handleClient(client);
+    return client.response();
+}
+
+static void assertHas(const std::string &response, const char *text)
+{
+    if (response.find(text) == std::string::npos)
+    {
+        printf("falta \"%s\" en:\n%s\n", text, response.c_str());
+        TEST_FAIL();
+    }
+}
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+// la prueba de un sistema por el soft AP: al portal en el AP
+void test_probe_ap()
+{
+    std::string r = get("GET /generate_204 HTTP/1.1\r\nHost: connectivitycheck.gstatic.com\r\n\r\n");
+    assertHas(r, "HTTP/1.1 302");
+    assertHas(r, "Location: http://172.217.28.1/\r\n");
+}
+
+// por la red wifi: al portal en la IP de esa red (la del AP no se alcanza desde ahi)
+void test_probe_sta()
+{
+    std::string r = get("GET /hotspot-detect.html HTTP/1.1\r\nHost: captive.apple.com\r\n\r\n", STA_IP);
+    assertHas(r, "HTTP/1.1 302");
+    assertHas(r, "Location: http://192.168.0.50/\r\n");
+
+    r = get("GET /generate_204 HTTP/1.1\r\nHost: connectivitycheck.gstatic.com\r\n\r\n");
+    assertHas(r, "Location: http://172.217.28.1/\r\n");
+}
+
+// la misma url pedida al equipo no es una prueba: no se redirige
+void test_probe_own_host()
+{
+    std::string r = get("GET /generate_204 HTTP/1.1\r\nHost: 172.217.28.1\r\n\r\n");
+    assertHas(r, "HTTP/1.1 404");
+}
+
+static int countLines(const std::string &response)
+{
+    int lines = 0;
+    for (size_t pos = 0; (pos = response.find("<p class=", pos)) != std::string::npos; pos++)
+        lines++;
+    return lines;
+}
+
+// size tiene un minimo, y una pagina que no existe sale vacia (page * size no da la vuelta)
+void test_logs_page_limits()
+{
+    for (int i = 0; i < 50; i++)
+        LogInfo("linea %d", i);
+    FSLOG.flush();
+    int lines = FSLOG.nextSeq() - FSLOG.firstSeq(); // los archivos del portal son chicos (4 x 1000 bytes)
+    TEST_ASSERT_TRUE(lines >= 10);
+
+    TEST_ASSERT_EQUAL(min(lines, 200), countLines(get("GET /logs?page=0&size=100000 HTTP/1.1\r\n\r\n")));
+    TEST_ASSERT_EQUAL(min(lines, 200), countLines(get("GET /logs?tail=100000 HTTP/1.1\r\n\r\n")));
+    TEST_ASSERT_EQUAL(1, countLines(get("GET /logs?page=3&size=0 HTTP/1.1\r\n\r\n")));
+
+    // 33554432 * 128 = 2^32: antes volvia a la primera pagina
+    std::string r = get("GET /logs?page=33554432&size=128 HTTP/1.1\r\n\r\n");
+    TEST_ASSERT_EQUAL(0, countLines(r));
+    char next[48];
+    snprintf(next, sizeof(next), "X-Next-Seq: %u\r\n", (unsigned)FSLOG.nextSeq());
+    assertHas(r, next);
+}
+
+int main()
+{
+    Serial.mute(true);
+    setenv("HOST_PORT_OFFSET", "21000", 0); // los servidores de setup() no piden root
+    setup();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_probe_ap);
+    RUN_TEST(test_probe_sta);
+    RUN_TEST(test_probe_own_host);
+    RUN_TEST(test_logs_page_limits);
+    return UNITY_END();
+}
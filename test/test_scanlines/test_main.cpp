@@ -0,0 +1,149 @@
+/*
+    test_scanlines: FsBuffer::scanLines() sobre archivos de MemFS
+    (lineas que cruzan bloques, lineas vacias, cortes, skip y count).
+
+    pio test -e native -f test_scanlines
+
+    JJTeam - 2021
+*/
+
+#include <Arduino.h>
+#include <MemFS.h>
+#include <unity.h>
+#include <string>
+#include <vector>
+#include "FSBuffer.h"
+
+static MemFS memFS;
+
+// scanLines() es protected
+class TestBuffer : public FsBuffer
+{
+public:
+    using FsBuffer::scanLines;
+};
+
+static std::vector<std::string> lines;
+
+static void collect(const char *line, size_t len, void *ctx)
+{
+    TEST_ASSERT_EQUAL(0, line[len]); // siempre termina en '\0'
+    lines.push_back(std::string(line, len));
+}
+
+// graba data en un archivo y lo recorre
+static uint32_t scan(const std::string &data, uint32_t skip = 0, uint32_t count = UINT32_MAX)
+{
+    File f = memFS.open("/scan.txt", FILE_WRITE);
+    f.write((const uint8_t *)data.data(), data.size());
+    f.close();
+
+    lines.clear();
+    TestBuffer buffer;
+    f = memFS.open("/scan.txt", FILE_READ);
+    uint32_t done = buffer.scanLines(f, skip, count, collect, nullptr);
+    f.close();
+    TEST_ASSERT_EQUAL(lines.size(), done);
+    return done;
+}
+
+void setUp()
+{
+    memFS.clear();
+}
+
+void tearDown()
+{
+}
+
+void test_simple()
+{
+    TEST_ASSERT_EQUAL(3, scan("uno\ndos\ntres\n"));
+    TEST_ASSERT_EQUAL_STRING("uno", lines[0].c_str());
+    TEST_ASSERT_EQUAL_STRING("tres", lines[2].c_str());
+}
+
+void test_empty_file()
+{
+    TEST_ASSERT_EQUAL(0, scan(""));
+}
+
+// las lineas vacias tambien se entregan (antes cortaban el recorrido)
+void test_blank_lines()
+{
+    TEST_ASSERT_EQUAL(4, scan("a\n\n\nb\n"));
+    TEST_ASSERT_EQUAL_STRING("", lines[1].c_str());
+    TEST_ASSERT_EQUAL_STRING("b", lines[3].c_str());
+}
+
+void test_last_line_without_newline()
+{
+    TEST_ASSERT_EQUAL(2, scan("a\nsin enter"));
+    TEST_ASSERT_EQUAL_STRING("sin enter", lines[1].c_str());
+}
+
+// una linea que cae entre dos bloques se arma entera
+void test_across_blocks()
+{
+    std::string first(FSBUFFER_BLOCK_SIZE - 10, 'a');
+    std::string second(40, 'b');
+    std::string third(FSBUFFER_BLOCK_SIZE * 2, 'c');
+    third.resize(FSBUFFER_LINE_SIZE - 1);
+    TEST_ASSERT_EQUAL(3, scan(first + "\n" + second + "\n" + third + "\n"));
+    TEST_ASSERT_EQUAL_STRING(first.c_str(), lines[0].c_str());
+    TEST_ASSERT_EQUAL_STRING(second.c_str(), lines[1].c_str());
+    TEST_ASSERT_EQUAL_STRING(third.c_str(), lines[2].c_str());
+}
+
+// el '\n' justo al final del bloque
+void test_newline_at_block_end()
+{
+    std::string first(FSBUFFER_BLOCK_SIZE - 1, 'a');
+    TEST_ASSERT_EQUAL(2, scan(first + "\nb\n"));
+    TEST_ASSERT_EQUAL(FSBUFFER_BLOCK_SIZE - 1, lines[0].size());
+    TEST_ASSERT_EQUAL_STRING("b", lines[1].c_str());
+}
+
+// si no entra en el buffer de linea se corta (y se sigue con la proxima)
+void test_long_line()
+{
+    std::string data = std::string(16, 'x') + std::string(FSBUFFER_BLOCK_SIZE * 3, 'y') + "\nfin\n";
+    TEST_ASSERT_EQUAL(2, scan(data));
+    TEST_ASSERT_EQUAL(FSBUFFER_LINE_SIZE, lines[0].size());
+    TEST_ASSERT_EQUAL_STRING("fin", lines[1].c_str());
+}
+
+void test_skip_count()
+{
+    std::string data;
+    for (int i = 0; i < 100; i++)
+        data += "linea " + std::to_string(i) + "\n";
+    TEST_ASSERT_EQUAL(5, scan(data, 40, 5));
+    TEST_ASSERT_EQUAL_STRING("linea 40", lines[0].c_str());
+    TEST_ASSERT_EQUAL_STRING("linea 44", lines[4].c_str());
+    TEST_ASSERT_EQUAL(2, scan(data, 98, 10));
+    TEST_ASSERT_EQUAL(0, scan(data, 100, 10));
+}
+
+// binario: los '\0' del medio no cortan la linea
+void test_binary()
+{
+    std::string data("a\0b\n", 4);
+    TEST_ASSERT_EQUAL(1, scan(data));
+    TEST_ASSERT_EQUAL(3, lines[0].size());
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_simple);
+    RUN_TEST(test_empty_file);
+    RUN_TEST(test_blank_lines);
+    RUN_TEST(test_last_line_without_newline);
+    RUN_TEST(test_across_blocks);
+    RUN_TEST(test_newline_at_block_end);
+    RUN_TEST(test_long_line);
+    RUN_TEST(test_skip_count);
+    RUN_TEST(test_binary);
+    return UNITY_END();
+}
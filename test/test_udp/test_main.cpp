@@ -0,0 +1,207 @@
+/*
+    test_udp: MemUdp y WiFiUDP (socket de verdad en 127.0.0.1) con el DNSServer.
+
+    pio test -e native -f test_udp
+
+    JJTeam - 2021
+*/
+
+#include <Arduino.h>
+#include <MemUdp.h>
+#include <WiFiUdp.h>
+#include <unity.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "DNSServer.h"
+
+#define TEST_UDP_PORT 47053
+
+static const IPAddress PORTAL(172, 217, 28, 1);
+
+// consulta A de "example.com"
+static const uint8_t QUERY[] = {
+    0x12, 0x34, 0x01, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    7, 'e', 'x', 'a', 'm', 'p', 'l', 'e', 3, 'c', 'o', 'm', 0,
+    0x00, 0x01, 0x00, 0x01};
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+void test_memudp_queue()
+{
+    MemUdp udp;
+    udp.begin(53);
+    uint8_t data[3] = {1, 2, 3};
+    TEST_ASSERT_TRUE(udp.push(data, 3, IPAddress(10, 0, 0, 2), 1234));
+    TEST_ASSERT_TRUE(udp.push(data, 2, IPAddress(10, 0, 0, 3), 1235));
+    TEST_ASSERT_EQUAL(3, udp.parsePacket());
+    TEST_ASSERT_EQUAL(1234, udp.remotePort());
+    uint8_t buf[8];
+    TEST_ASSERT_EQUAL(3, udp.read(buf, sizeof(buf)));
+    TEST_ASSERT_EQUAL(2, udp.parsePacket());
+    TEST_ASSERT_TRUE(udp.remoteIP() == IPAddress(10, 0, 0, 3));
+    TEST_ASSERT_EQUAL(0, udp.parsePacket());
+
+    for (int i = 0; i < MEM_UDP_PACKETS; i++)
+        TEST_ASSERT_TRUE(udp.push(data, 1, IPAddress(10, 0, 0, 2), 1));
+    TEST_ASSERT_FALSE(udp.push(data, 1, IPAddress(10, 0, 0, 2), 1)); // llena
+}
+
+void test_memudp_dns()
+{
+    MemUdp udp;
+    DNSServer dns(udp);
+    TEST_ASSERT_TRUE(dns.start(53, "*", PORTAL));
+    udp.push(QUERY, sizeof(QUERY), IPAddress(10, 0, 0, 2), 5353);
+    dns.processNextRequest();
+
+    TEST_ASSERT_EQUAL(1, udp.replies());
+    TEST_ASSERT_EQUAL(5353, udp.replyPort());
+    TEST_ASSERT_EQUAL(sizeof(QUERY) + 16, udp.replyLength());
+    const uint8_t *reply = udp.reply();
+    TEST_ASSERT_EQUAL_HEX8(0x12, reply[0]);
+    TEST_ASSERT_EQUAL_HEX8(0x34, reply[1]);
+    TEST_ASSERT_EQUAL(1, reply[7]); // ANCOUNT
+    const uint8_t ip[4] = {172, 217, 28, 1};
+    TEST_ASSERT_EQUAL_MEMORY(ip, reply + udp.replyLength() - 4, 4);
+}
+
+// el limite por cliente se cobra antes de parsear: los paquetes rotos tambien gastan el balde
+void test_rate_limit_malformed()
+{
+    MemUdp udp;
+    DNSServer dns(udp);
+    dns.setRateLimit(10, 20);
+    dns.start(53, "*", PORTAL);
+    uint8_t bad[sizeof(QUERY)];
+    memcpy(bad, QUERY, sizeof(QUERY));
+    bad[12] = 64; // etiqueta de mas de 63 bytes
+    for (int i = 0; i < 20; i++)
+    {
+        udp.push(bad, sizeof(bad), IPAddress(10, 0, 0, 2), 5353);
+        dns.processNextRequest();
+    }
+    TEST_ASSERT_EQUAL(20, udp.replies()); // FORMERR
+    udp.push(QUERY, sizeof(QUERY), IPAddress(10, 0, 0, 2), 5353);
+    udp.push(QUERY, sizeof(QUERY), IPAddress(10, 0, 0, 3), 5353);
+    dns.processNextRequest();
+    TEST_ASSERT_EQUAL(1, dns.stats().refused);
+    TEST_ASSERT_EQUAL(21, udp.replies());
+    TEST_ASSERT_TRUE(udp.replyIP() == IPAddress(10, 0, 0, 3));
+}
+
+// borrar las estadisticas no llena los baldes del limite
+void test_rate_limit_survives_clear()
+{
+    MemUdp udp;
+    DNSServer dns(udp);
+    dns.setRateLimit(1, 5);
+    dns.start(53, "*", PORTAL);
+    for (int i = 0; i < 5; i++)
+    {
+        udp.push(QUERY, sizeof(QUERY), IPAddress(10, 0, 0, 2), 5353);
+        dns.processNextRequest();
+    }
+    TEST_ASSERT_EQUAL(5, udp.replies());
+    dns.clearTelemetry();
+    udp.push(QUERY, sizeof(QUERY), IPAddress(10, 0, 0, 2), 5353);
+    dns.processNextRequest();
+    TEST_ASSERT_EQUAL(5, udp.replies());
+    TEST_ASSERT_EQUAL(1, dns.stats().refused);
+
+    static DNSTelemetry t;
+    dns.telemetry(t);
+    TEST_ASSERT_EQUAL(1, t.clients[0].count);
+    TEST_ASSERT_EQUAL(1, t.clients[0].refused);
+}
+
+// maxBatch no pasa del presupuesto aunque queden paquetes en la cola
+void test_max_batch()
+{
+    MemUdp udp;
+    DNSServer dns(udp);
+    dns.setBatchBudget(4);
+    dns.start(53, "*", PORTAL);
+    for (int i = 0; i < 10; i++)
+        udp.push(QUERY, sizeof(QUERY), IPAddress(10, 0, 0, 2), 5353);
+    dns.processNextRequest();
+    TEST_ASSERT_EQUAL(4, dns.stats().maxBatch);
+    TEST_ASSERT_EQUAL(4, udp.replies());
+}
+
+static uint32_t latencyCount(const uint16_t *latency)
+{
+    uint32_t count = 0;
+    for (int i = 0; i < DNS_LATENCY_BUCKETS; i++)
+        count += latency[i];
+    return count;
+}
+
+// cada cliente tiene su histograma de latencias, el total los suma
+void test_client_latency()
+{
+    MemUdp udp;
+    DNSServer dns(udp);
+    dns.start(53, "*", PORTAL);
+    for (int i = 0; i < 3; i++)
+        udp.push(QUERY, sizeof(QUERY), IPAddress(10, 0, 0, 2), 5353);
+    udp.push(QUERY, sizeof(QUERY), IPAddress(10, 0, 0, 3), 5353);
+    dns.processNextRequest();
+
+    static DNSTelemetry t;
+    dns.telemetry(t);
+    TEST_ASSERT_EQUAL(3, latencyCount(t.clients[0].latency));
+    TEST_ASSERT_EQUAL(1, latencyCount(t.clients[1].latency));
+    uint32_t total = 0;
+    for (int i = 0; i < DNS_LATENCY_BUCKETS; i++)
+        total += t.latency[i];
+    TEST_ASSERT_EQUAL(4, total);
+}
+
+void test_wifiudp_loopback()
+{
+    WiFiUDP udp;
+    TEST_ASSERT_EQUAL(1, udp.begin(TEST_UDP_PORT));
+    DNSServer dns(udp);
+    dns.start(TEST_UDP_PORT, "*", PORTAL);
+
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    timeval timeout = {1, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(hostPort(TEST_UDP_PORT));
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    TEST_ASSERT_EQUAL(sizeof(QUERY), sendto(fd, QUERY, sizeof(QUERY), 0, (sockaddr *)&addr, sizeof(addr)));
+
+    for (int i = 0; i < 100 && dns.stats().answered == 0; i++)
+    {
+        dns.processNextRequest();
+        delay(1);
+    }
+    uint8_t reply[512];
+    ssize_t n = recv(fd, reply, sizeof(reply), 0);
+    close(fd);
+    TEST_ASSERT_EQUAL(sizeof(QUERY) + 16, n);
+    TEST_ASSERT_EQUAL(1, dns.stats().answered);
+}
+
+int main()
+{
+    Serial.mute(true);
+    UNITY_BEGIN();
+    RUN_TEST(test_memudp_queue);
+    RUN_TEST(test_memudp_dns);
+    RUN_TEST(test_rate_limit_malformed);
+    RUN_TEST(test_rate_limit_survives_clear);
+    RUN_TEST(test_client_latency);
+    RUN_TEST(test_max_batch);
+    RUN_TEST(test_wifiudp_loopback);
+    return UNITY_END();
+}
@@ -0,0 +1,248 @@
+/*
+    test_webserver: el WebServer de la PC con pedidos en RAM (MemClient) y por TCP en 127.0.0.1.
+
+    pio test -e native -f test_webserver
+
+    JJTeam - 2021
+*/
+
+#include <Arduino.h>
+#include <WebServer.h>
+#include <MemClient.h>
+#include <unity.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <string>
+#include <thread>
+#include "HtmlWriter.h"
+#include "WebResources.h"
+
+#define TEST_HTTP_PORT 48080
+
+static WebServer web(TEST_HTTP_PORT);
+
+static void handleHello()
+{
+    String text = "hola ";
+    text += web.arg("nombre");
+    text += " ";
+    text += web.header("X-Test");
+    web.send(200, "text/plain", text);
+}
+
+static void handleHtml()
+{
+    HtmlWriter html(web);
+    html.begin(200, "text/html");
+    html.open("p").escaped("<a&b>").close("p");
+    html.end();
+}
+
+// printf() que cruza el borde del buffer, y uno mas grande que todo el buffer (se corta)
+static void handlePrintf()
+{
+    HtmlWriter html(web);
+    html.begin(200, "text/plain");
+    for (int i = 0; i < 100; i++)
+        html.printf("%03d,", i);
+    html.printf("[%s]", std::string(HTML_WRITER_SIZE + 10, 'x').c_str());
+    html.end();
+}
+
+static void handleForm()
+{
+    web.send(200, "text/plain", web.method() == HTTP_POST ? web.arg("s") + "/" + web.arg("p") : "no");
+}
+
+static void handleNotFound()
+{
+    web.send(404, "text/plain", web.uri());
+}
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+static std::string body(const std::string &response)
+{
+    size_t start = response.find("\r\n\r\n");
+    return start == std::string::npos ? "" : response.substr(start + 4);
+}
+
+void test_get_args_headers()
+{
+    MemClient client("GET /hola?nombre=Juan%20Jose HTTP/1.1\r\nHost: 172.217.28.1\r\nX-Test: si\r\n\r\n");
+    web.handleClient(client);
+    const std::string &response = client.response();
+    TEST_ASSERT_EQUAL(0, response.find("HTTP/1.1 200 OK\r\n"));
+    TEST_ASSERT_NOT_EQUAL(std::string::npos, response.find("Content-Length: 17\r\n"));
+    TEST_ASSERT_EQUAL_STRING("hola Juan Jose si", body(response).c_str());
+    TEST_ASSERT_EQUAL_STRING("172.217.28.1", web.hostHeader().c_str());
+}
+
+void test_chunked()
+{
+    MemClient client("GET /html HTTP/1.1\r\nHost: 172.217.28.1\r\n\r\n");
+    web.handleClient(client);
+    const std::string &response = client.response();
+    TEST_ASSERT_NOT_EQUAL(std::string::npos, response.find("Transfer-Encoding: chunked\r\n"));
+    TEST_ASSERT_NOT_EQUAL(std::string::npos, response.find("<p>&lt;a&amp;b&gt;</p>"));
+    TEST_ASSERT_EQUAL(response.size() - 5, response.rfind("0\r\n\r\n"));
+}
+
+void test_printf()
+{
+    MemClient client("GET /printf HTTP/1.1\r\n\r\n");
+    web.handleClient(client);
+    // saco los largos de los chunks
+    std::string chunked = body(client.response()), text;
+    size_t pos = 0, size;
+    while ((size = strtoul(chunked.c_str() + pos, nullptr, 16)) > 0)
+    {
+        pos = chunked.find("\r\n", pos) + 2;
+        text += chunked.substr(pos, size);
+        pos += size + 2;
+    }
+    std::string expected;
+    char n[8];
+    for (int i = 0; i < 100; i++)
+    {
+        snprintf(n, sizeof(n), "%03d,", i);
+        expected += n;
+    }
+    expected += "[" + std::string(HTML_WRITER_SIZE - 1, 'x');
+    TEST_ASSERT_EQUAL_STRING(expected.c_str(), text.c_str());
+}
+
+void test_post_form()
+{
+    MemClient client("POST /form HTTP/1.1\r\nHost: 172.217.28.1\r\n"
+                     "Content-Type: application/x-www-form-urlencoded\r\nContent-Length: 15\r\n\r\n"
+                     "s=Mi+Red&p=a%26b");
+    web.handleClient(client);
+    TEST_ASSERT_EQUAL_STRING("Mi Red/a&b", body(client.response()).c_str());
+}
+
+void test_not_found()
+{
+    MemClient client("GET /nada HTTP/1.1\r\n\r\n");
+    web.handleClient(client);
+    TEST_ASSERT_EQUAL(0, client.response().find("HTTP/1.1 404 Not Found\r\n"));
+    TEST_ASSERT_EQUAL_STRING("/nada", body(client.response()).c_str());
+}
+
+static std::string header(const std::string &response, const char *name)
+{
+    size_t start = response.find(std::string("\r\n") + name + ": ");
+    if (start == std::string::npos)
+        return "";
+    start += strlen(name) + 4;
+    return response.substr(start, response.find("\r\n", start) - start);
+}
+
+// los recursos de la flash: se revalidan siempre (no-cache) y el ETag evita volver a bajarlos
+void test_resource_etag()
+{
+    MemClient client("GET /logo.jpg HTTP/1.1\r\n\r\n");
+    web.handleClient(client);
+    const WebResource *logo = WebResourceFind("/logo.jpg");
+    TEST_ASSERT_EQUAL(0, client.response().find("HTTP/1.1 200 OK\r\n"));
+    TEST_ASSERT_EQUAL_STRING("no-cache", header(client.response(), "Cache-Control").c_str());
+    TEST_ASSERT_EQUAL_STRING(logo->etag, header(client.response(), "ETag").c_str());
+    TEST_ASSERT_EQUAL(logo->size(), body(client.response()).size());
+
+    std::string request = std::string("GET /logo.jpg HTTP/1.1\r\nIf-None-Match: ") + logo->etag + "\r\n\r\n";
+    client.reset(request.c_str());
+    web.handleClient(client);
+    TEST_ASSERT_EQUAL(0, client.response().find("HTTP/1.1 304 Not Modified\r\n"));
+    TEST_ASSERT_EQUAL(0, body(client.response()).size());
+}
+
+// style.css va comprimido solo si el navegador acepta gzip, cada version con su ETag
+void test_resource_gzip()
+{
+    const WebResource *css = WebResourceFind("/style.css");
+    TEST_ASSERT_TRUE(css->gzip());
+    TEST_ASSERT_TRUE(strcmp(css->etag, css->gzipEtag) != 0);
+
+    MemClient client("GET /style.css HTTP/1.1\r\nAccept-Encoding: gzip, deflate, br\r\n\r\n");
+    web.handleClient(client);
+    TEST_ASSERT_EQUAL_STRING("gzip", header(client.response(), "Content-Encoding").c_str());
+    TEST_ASSERT_EQUAL_STRING(css->gzipEtag, header(client.response(), "ETag").c_str());
+    TEST_ASSERT_EQUAL_STRING("Accept-Encoding", header(client.response(), "Vary").c_str());
+    TEST_ASSERT_EQUAL(css->gzipEnd - css->gzipData, body(client.response()).size());
+
+    const char *identity[] = {
+        "GET /style.css HTTP/1.1\r\n\r\n",
+        "GET /style.css HTTP/1.1\r\nAccept-Encoding: br\r\n\r\n",
+        "GET /style.css HTTP/1.1\r\nAccept-Encoding: gzip;q=0, br\r\n\r\n",
+        "GET /style.css HTTP/1.1\r\nAccept-Encoding: xgzip\r\n\r\n"};
+    for (const char *request : identity)
+    {
+        client.reset(request);
+        web.handleClient(client);
+        TEST_ASSERT_EQUAL(0, client.response().find("HTTP/1.1 200 OK\r\n"));
+        TEST_ASSERT_EQUAL_STRING("", header(client.response(), "Content-Encoding").c_str());
+        TEST_ASSERT_EQUAL_STRING(css->etag, header(client.response(), "ETag").c_str());
+        TEST_ASSERT_EQUAL_STRING(std::string(css->data, css->size()).c_str(), body(client.response()).c_str());
+    }
+}
+
+// un pedido de verdad por TCP: el cliente corre en otro thread y el servidor en el loop
+void test_socket()
+{
+    std::string response;
+    std::thread client([&response]() {
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in addr = {};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(hostPort(TEST_HTTP_PORT));
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (connect(fd, (sockaddr *)&addr, sizeof(addr)) == 0)
+        {
+            const char *request = "GET /hola?nombre=tcp HTTP/1.1\r\nHost: 127.0.0.1\r\nX-Test: ok\r\n\r\n";
+            send(fd, request, strlen(request), 0);
+            char buf[512];
+            ssize_t n;
+            while ((n = recv(fd, buf, sizeof(buf), 0)) > 0)
+                response.append(buf, n);
+        }
+        ::close(fd);
+    });
+    unsigned long start = millis();
+    while (response.empty() && millis() - start < 2000)
+        web.handleClient();
+    client.join();
+    TEST_ASSERT_EQUAL_STRING("hola tcp ok", body(response).c_str());
+}
+
+int main()
+{
+    Serial.mute(true);
+    web.on("/hola", handleHello);
+    web.on("/html", handleHtml);
+    web.on("/form", handleForm);
+    web.on("/printf", handlePrintf);
+    web.onNotFound(handleNotFound);
+    WebResourcesBegin(web);
+    // collectHeaders() reemplaza la lista: van tambien los que usan los recursos
+    const char *headers[] = {"X-Test", "If-None-Match", "Range", "If-Range", "Accept-Encoding"};
+    web.collectHeaders(headers, 5);
+    web.begin();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_get_args_headers);
+    RUN_TEST(test_chunked);
+    RUN_TEST(test_printf);
+    RUN_TEST(test_post_form);
+    RUN_TEST(test_not_found);
+    RUN_TEST(test_resource_etag);
+    RUN_TEST(test_resource_gzip);
+    RUN_TEST(test_socket);
+    return UNITY_END();
+}
@@ -0,0 +1,77 @@
+/*
+    test_wifiscan: el cache de redes de WifiScan con el WiFi de la PC
+    (5 redes fijas, una oculta y una repetida, el scan tarda HOST_WIFI_SCAN_MS).
+
+    pio test -e native -f test_wifiscan
+
+    JJTeam - 2021
+*/
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <unity.h>
+#include "WifiScan.h"
+
+// llama al loop hasta que termina el scan
+static void waitScan()
+{
+    unsigned long start = millis();
+    do
+    {
+        WifiScanLoop();
+        delay(10);
+    } while (WifiScanRunning() && millis() - start < 5 * HOST_WIFI_SCAN_MS);
+}
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+// por defecto no se escanea solo, ni al arrancar
+void test_no_scan_without_request()
+{
+    for (int i = 0; i < 10; i++)
+        WifiScanLoop();
+    TEST_ASSERT_EQUAL(0, WiFi.scanCountTotal());
+    TEST_ASSERT_FALSE(WifiScanRunning());
+    TEST_ASSERT_EQUAL(UINT32_MAX, WifiScanAge());
+    TEST_ASSERT_EQUAL(0, WifiScanCount());
+}
+
+void test_request_fills_cache()
+{
+    WifiScanRequest();
+    WifiScanLoop();
+    TEST_ASSERT_TRUE(WifiScanRunning());
+    waitScan();
+    TEST_ASSERT_EQUAL(1, WiFi.scanCountTotal());
+    TEST_ASSERT_TRUE(WifiScanAge() < 1000);
+
+    // sin la oculta ni la repetida, y de mayor a menor señal
+    TEST_ASSERT_EQUAL(3, WifiScanCount());
+    for (int i = 1; i < WifiScanCount(); i++)
+        TEST_ASSERT_TRUE(WifiScanGet(i - 1).rssi >= WifiScanGet(i).rssi);
+}
+
+// despues se sirve del cache, sin volver a escanear
+void test_cached()
+{
+    for (int i = 0; i < 10; i++)
+        WifiScanLoop();
+    TEST_ASSERT_EQUAL(1, WiFi.scanCountTotal());
+    TEST_ASSERT_EQUAL(3, WifiScanCount());
+}
+
+int main()
+{
+    Serial.mute(true);
+    UNITY_BEGIN();
+    RUN_TEST(test_no_scan_without_request);
+    RUN_TEST(test_request_fills_cache);
+    RUN_TEST(test_cached);
+    return UNITY_END();
+}
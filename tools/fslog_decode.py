@@ -0,0 +1,158 @@
+#!/usr/bin/env python3
+"""
+fslog_decode.py
+Convierte a texto los logs grabados con FSLOG_BINARIO (ver include/FSLogRecord.h).
+
+Los registros guardan la direccion del string de formato, asi que hace falta el
+.elf del MISMO firmware que grabo los logs:
+
+    python tools/fslog_decode.py .pio/build/esp32dev/firmware.elf buf.0 buf.1 ...
+
+Las lineas de texto comun se imprimen tal cual.
+Necesita pyelftools (pip install pyelftools).
+
+JJTeam - 2021
+"""
+
+import argparse
+import re
+import struct
+import sys
+
+from elftools.elf.elffile import ELFFile
+
+REC_MARK = 0x1E
+REC_ESC = 0x1B
+REC_XOR = 0x20
+
+# %[flags][ancho][.precision][largo]conversion (igual que parseSpec() en FSLogRecord.cpp)
+SPEC = re.compile(r"%([-+ #0]*)(\*|\d*)(?:\.(\*|\d*))?([hlLqjzt]*)(.?)", re.S)
+
+
+class Firmware:
+    """Lee los strings de formato desde las secciones del .elf"""
+
+    def __init__(self, path):
+        self.sections = []
+        with open(path, "rb") as f:
+            elf = ELFFile(f)
+            for sec in elf.iter_sections():
+                if sec["sh_flags"] & 2 and sec["sh_type"] == "SHT_PROGBITS":  # SHF_ALLOC
+                    self.sections.append((sec["sh_addr"], sec.data()))
+
+    def string_at(self, addr):
+        for base, data in self.sections:
+            if base <= addr < base + len(data):
+                end = data.index(b"\0", addr - base)
+                return data[addr - base:end].decode("latin-1")
+        return None
+
+
+def unescape(line):
+    raw = bytearray()
+    i = 1  # salteo el MARK
+    while i < len(line):
+        c = line[i]
+        if c == REC_ESC and i + 1 < len(line):
+            i += 1
+            c = line[i] ^ REC_XOR
+        raw.append(c)
+        i += 1
+    return bytes(raw)
+
+
+class Reader:
+    def __init__(self, data):
+        self.data = data
+        self.pos = 0
+
+    def get(self, fmt):
+        size = struct.calcsize(fmt)
+        if self.pos + size > len(self.data):
+            raise EOFError
+        value = struct.unpack_from(fmt, self.data, self.pos)[0]
+        self.pos += size
+        return value
+
+    def string(self):
+        end = self.data.find(b"\0", self.pos)
+        if end < 0:
+            raise EOFError
+        value = self.data[self.pos:end].decode("latin-1")
+        self.pos = end + 1
+        return value
+
+
+def render(fw, line):
+    raw = Reader(unescape(line))
+    addr = raw.get("<I")
+    ms = raw.get("<I")
+    fmt = fw.string_at(addr)
+    if fmt is None:
+        return ms, "[?]: registro de log invalido (otro firmware?)\n"
+
+    out = []
+    pos = 0
+    for m in SPEC.finditer(fmt):
+        out.append(fmt[pos:m.start()])
+        pos = m.end()
+        flags, width, prec, length, conv = m.groups()
+        if conv == "%":
+            out.append("%")
+            continue
+        if conv in ("", "n"):
+            continue
+        try:
+            if width == "*":
+                width = str(raw.get("<i"))
+            if prec == "*":
+                prec = str(raw.get("<i"))
+            longs = length.count("l") + 2 * (length.count("q") + length.count("j"))
+            if conv == "s":
+                value = raw.string()
+            elif conv in "fFeEgGaA":
+                value = raw.get("<d")
+                conv = "f" if conv == "F" else ("e" if conv in "aA" else conv)
+            elif longs >= 2:
+                value = raw.get("<q" if conv in "di" else "<Q")
+            else:
+                value = raw.get("<i" if conv in "di" else "<I")
+                if conv == "c":
+                    value = chr(value & 0xFF)
+                elif conv == "p":
+                    conv, flags = "x", flags + "#"
+                elif conv == "u":
+                    conv = "d"
+        except EOFError:
+            out.append("?")  # el registro se corto al grabarlo
+            continue
+        spec = "%" + flags + width + ("." + prec if prec is not None else "") + conv
+        out.append(spec % value)
+    out.append(fmt[pos:])
+    return ms, "".join(out)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("elf", help="firmware.elf que grabo los logs")
+    parser.add_argument("files", nargs="+", help="archivos de log (en orden, del mas viejo al mas nuevo)")
+    parser.add_argument("-t", "--timestamp", action="store_true", help="antepone el millis() de cada registro")
+    args = parser.parse_args()
+
+    fw = Firmware(args.elf)
+    for path in args.files:
+        with open(path, "rb") as f:
+            for line in f.read().split(b"\n"):
+                if not line:
+                    continue
+                if line[0] != REC_MARK:
+                    sys.stdout.write(line.decode("latin-1") + "\n")
+                    continue
+                ms, text = render(fw, line)
+                if args.timestamp:
+                    text = "%10u %s" % (ms, text)
+                sys.stdout.write(text)
+
+
+if __name__ == "__main__":
+    main()
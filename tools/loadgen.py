@@ -0,0 +1,287 @@
+#!/usr/bin/env python3
+"""
+loadgen.py
+Generador de carga para el portal cautivo: simula N celulares conectandose al mismo tiempo.
+
+Cada cliente simulado repite lo que hace un telefono al conectarse al AP:
+  - consultas DNS de dominios al azar (las tiene que contestar DNSServer con la IP del portal)
+  - pruebas de conectividad del sistema (/generate_204, /hotspot-detect.html, ...) => 302 al portal
+  - un pedido a otro dominio (Host ajeno) => 302 de captivePortal()
+  - las paginas y recursos: /, /wifi, /style.css y /logo.jpg
+
+y al final de cada etapa muestra, por operacion, el porcentaje de exito y las latencias,
+y lo que conto el DNSServer en /stats/dns durante la etapa (las consultas "refused" son las
+que descarto el limite por cliente, sin contestar: del lado del cliente son timeouts).
+Contra el equipo, conectado a su AP:
+
+    python tools/loadgen.py                              # 1, 2, 4 y 8 clientes, 20 s cada etapa
+    python tools/loadgen.py --clients 1,10,20 --duration 30 --json resultados.json
+    python tools/loadgen.py --host 192.168.0.50          # el equipo por la red WiFi (STA)
+
+Contra el build de la PC (pio run -e native), por loopback:
+
+    HOST_PORT_OFFSET=8000 .pio/build/native/program &
+    python tools/loadgen.py --loopback                   # DNS en 8053, HTTP en 8080
+
+En --loopback cada cliente sale de su propia IP (127.0.0.2, 127.0.0.3, ...: en Linux todo 127/8
+es loopback), asi el limite de consultas DNS por cliente se aplica a cada uno como con los celulares
+y no a todos juntos como si fueran uno solo.
+
+Solo usa la biblioteca estandar de Python (3.7+).
+
+JJTeam - 2021
+"""
+
+import argparse
+import asyncio
+import json
+import os
+import random
+import string
+import struct
+import time
+
+AP_IP = "172.217.28.1"  # la del soft AP (apIP en WifiCheck.cpp)
+
+PROBES = ["/generate_204", "/gen_204", "/hotspot-detect.html", "/library/test/success.html",
+          "/connecttest.txt", "/ncsi.txt", "/canonical.html", "/success.txt"]
+
+# operacion => status HTTP esperados
+PAGES = {"/": (200,), "/wifi": (200,), "/style.css": (200, 304), "/logo.jpg": (200, 304)}
+
+
+def random_domain():
+    name = "".join(random.choice(string.ascii_lowercase) for _ in range(random.randint(5, 12)))
+    return name + random.choice([".com", ".net", ".org", ".com.ar"])
+
+
+class Results:
+    def __init__(self):
+        self.ops = {}  # operacion => [ok, errores, latencias (ms)]
+
+    def add(self, op, ok, ms):
+        entry = self.ops.setdefault(op, [0, 0, []])
+        if ok:
+            entry[0] += 1
+            entry[2].append(ms)
+        else:
+            entry[1] += 1
+
+    def summary(self):
+        out = {}
+        for op, (ok, err, lat) in sorted(self.ops.items()):
+            lat.sort()
+
+            def pct(p):
+                return round(lat[min(len(lat) - 1, int(len(lat) * p / 100))], 1) if lat else None
+
+            out[op] = {"ok": ok, "errors": err, "success": round(100.0 * ok / max(1, ok + err), 1),
+                       "p50": pct(50), "p90": pct(90), "p99": pct(99), "max": pct(100)}
+        return out
+
+
+# ---------------------------------------------------------------------------- DNS
+
+class DnsClient(asyncio.DatagramProtocol):
+    def __init__(self):
+        self.pending = {}  # id => future
+
+    def datagram_received(self, data, addr):
+        if len(data) >= 2:
+            fut = self.pending.pop(struct.unpack(">H", data[:2])[0], None)
+            if fut and not fut.done():
+                fut.set_result(data)
+
+    def error_received(self, exc):
+        pass
+
+
+def dns_query(qid, name):
+    packet = struct.pack(">HHHHHH", qid, 0x0100, 1, 0, 0, 0)  # RD, una pregunta
+    for label in name.split("."):
+        packet += bytes([len(label)]) + label.encode()
+    return packet + b"\0" + struct.pack(">HH", 1, 1)  # A, IN
+
+
+def dns_answer_ok(reply, portal_ip):
+    if len(reply) < 12:
+        return False
+    flags, qd, an = struct.unpack(">HHH", reply[2:8])
+    # respuesta, NOERROR, con al menos un registro y la IP del portal al final (el registro A)
+    return flags & 0x8000 and flags & 0xF == 0 and an >= 1 and reply[-4:] == portal_ip
+
+
+async def dns_lookup(protocol, transport, portal_ip, timeout):
+    qid = random.randint(0, 0xFFFF)
+    fut = asyncio.get_running_loop().create_future()
+    protocol.pending[qid] = fut
+    start = time.perf_counter()
+    transport.sendto(dns_query(qid, random_domain()))
+    try:
+        reply = await asyncio.wait_for(fut, timeout)
+        return dns_answer_ok(reply, portal_ip), (time.perf_counter() - start) * 1000
+    except asyncio.TimeoutError:
+        protocol.pending.pop(qid, None)
+        return False, 0
+
+
+# ---------------------------------------------------------------------------- HTTP
+
+def dechunk(body):
+    out = b""
+    while body:
+        size, _, body = body.partition(b"\r\n")
+        size = int(size.split(b";")[0] or b"0", 16)
+        if size == 0:
+            break
+        out += body[:size]
+        body = body[size + 2:]
+    return out
+
+
+async def http_get(host, port, path, host_header, timeout, headers=None, source=None):
+    """GET con Connection: close. Devuelve (status, headers, cuerpo)."""
+    local_addr = (source, 0) if source else None
+    reader, writer = await asyncio.wait_for(asyncio.open_connection(host, port, local_addr=local_addr), timeout)
+    try:
+        request = "GET %s HTTP/1.1\r\nHost: %s\r\nConnection: close\r\nAccept-Encoding: gzip\r\n" % (path, host_header)
+        for key, value in (headers or {}).items():
+            request += "%s: %s\r\n" % (key, value)
+        writer.write((request + "\r\n").encode())
+        await writer.drain()
+        data = await asyncio.wait_for(reader.read(), timeout)
+    finally:
+        writer.close()
+    head, _, body = data.partition(b"\r\n\r\n")
+    lines = head.decode("latin-1").split("\r\n")
+    status = int(lines[0].split()[1]) if lines and len(lines[0].split()) > 1 else 0
+    response_headers = {}
+    for line in lines[1:]:
+        key, _, value = line.partition(":")
+        response_headers[key.strip().lower()] = value.strip()
+    if response_headers.get("transfer-encoding") == "chunked":
+        body = dechunk(body)
+    return status, response_headers, body
+
+
+# contadores del DNSServer (None si no se pudo leer /stats/dns)
+async def dns_server_stats(args):
+    try:
+        status, _, body = await http_get(args.host, args.http_port, "/stats/dns", args.host, args.timeout)
+        stats = json.loads(body) if status == 200 else {}
+        return {key: stats[key] for key in ("received", "answered", "dropped", "refused")}
+    except (OSError, asyncio.TimeoutError, ValueError, KeyError):
+        return None
+
+
+async def timed(results, op, coro, check):
+    start = time.perf_counter()
+    try:
+        ok = check(await coro)
+    except (OSError, asyncio.TimeoutError, ValueError, IndexError):
+        ok = False
+    results.add(op, ok, (time.perf_counter() - start) * 1000)
+
+
+# ---------------------------------------------------------------------------- clientes
+
+# source: IP de origen del cliente (--loopback), None = la que elija el sistema
+async def client(args, results, deadline, portal_ip, source):
+    loop = asyncio.get_running_loop()
+    local_addr = (source, 0) if source else None
+    transport, protocol = await loop.create_datagram_endpoint(DnsClient, remote_addr=(args.host, args.dns_port),
+                                                              local_addr=local_addr)
+    etags = {}
+    try:
+        while time.monotonic() < deadline:
+            ok, ms = await dns_lookup(protocol, transport, portal_ip, args.timeout)
+            results.add("dns", ok, ms)
+
+            probe = random.choice(PROBES)
+            await timed(results, "probe", http_get(args.host, args.http_port, probe, random_domain(), args.timeout, source=source),
+                        lambda r: r[0] == 302)
+
+            await timed(results, "redirect", http_get(args.host, args.http_port, "/", random_domain(), args.timeout, source=source),
+                        lambda r: r[0] == 302)
+
+            for path, expected in PAGES.items():
+                # como un navegador: la segunda vez manda el ETag que recibio
+                headers = {"If-None-Match": etags[path]} if path in etags else None
+
+                def check(r, path=path, expected=expected):
+                    if "etag" in r[1] and 304 in expected:
+                        etags[path] = r[1]["etag"]
+                    return r[0] in expected
+
+                await timed(results, "GET " + path,
+                            http_get(args.host, args.http_port, path, args.host, args.timeout, headers, source), check)
+
+            if args.think:
+                await asyncio.sleep(random.uniform(0, args.think))
+    finally:
+        transport.close()
+
+
+def source_ip(args, i):
+    return "127.0.0.%d" % (2 + i % 250) if args.loopback else None
+
+
+async def stage(args, clients, portal_ip):
+    results = Results()
+    before = await dns_server_stats(args)
+    deadline = time.monotonic() + args.duration
+    await asyncio.gather(*(client(args, results, deadline, portal_ip, source_ip(args, i)) for i in range(clients)))
+    after = await dns_server_stats(args)
+    # lo que conto el servidor durante la etapa
+    server = {key: after[key] - before[key] for key in after} if before and after else None
+    return results.summary(), server
+
+
+def print_stage(clients, summary, server):
+    print("\n%d cliente(s)" % clients)
+    print("  %-16s %8s %8s %8s %8s %8s %8s" % ("operacion", "ok", "exito%", "p50 ms", "p90 ms", "p99 ms", "max ms"))
+    for op, s in summary.items():
+        print("  %-16s %8d %8.1f %8s %8s %8s %8s" % (op, s["ok"], s["success"], s["p50"], s["p90"], s["p99"], s["max"]))
+    if server:
+        print("  /stats/dns: %(received)d recibidas, %(answered)d contestadas, %(refused)d refused (limite por cliente), "
+              "%(dropped)d descartadas" % server)
+    else:
+        print("  /stats/dns: no se pudo leer")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--host", help="IP del equipo (default: la del AP, o 127.0.0.1 con --loopback)")
+    parser.add_argument("--portal-ip", help="IP que tiene que devolver el DNS (default: --host, o la del AP con --loopback)")
+    parser.add_argument("--http-port", type=int, help="default: 80 (+ --port-offset con --loopback)")
+    parser.add_argument("--dns-port", type=int, help="default: 53 (+ --port-offset con --loopback)")
+    parser.add_argument("--loopback", action="store_true",
+                        help="contra el build de la PC, cada cliente con su IP 127.0.0.x de origen")
+    parser.add_argument("--port-offset", type=int, default=int(os.environ.get("HOST_PORT_OFFSET", 8000)),
+                        help="el HOST_PORT_OFFSET del programa de la PC (default: $HOST_PORT_OFFSET o 8000)")
+    parser.add_argument("--clients", default="1,2,4,8", help="cantidad de clientes de cada etapa, separadas por coma")
+    parser.add_argument("--duration", type=float, default=20, help="segundos de cada etapa")
+    parser.add_argument("--timeout", type=float, default=5, help="timeout de cada operacion (s)")
+    parser.add_argument("--think", type=float, default=0.5, help="pausa maxima al azar entre rondas de cada cliente (s)")
+    parser.add_argument("--json", help="ademas graba los resultados en este archivo")
+    args = parser.parse_args()
+
+    offset = args.port_offset if args.loopback else 0
+    args.host = args.host or ("127.0.0.1" if args.loopback else AP_IP)
+    args.http_port = args.http_port or 80 + offset
+    args.dns_port = args.dns_port or 53 + offset
+    portal_ip = args.portal_ip or (AP_IP if args.loopback else args.host)
+    portal_ip = bytes(int(x) for x in portal_ip.split("."))
+    report = []
+    for clients in (int(c) for c in args.clients.split(",")):
+        summary, server = asyncio.run(stage(args, clients, portal_ip))
+        print_stage(clients, summary, server)
+        report.append({"clients": clients, "duration": args.duration, "ops": summary, "dns_server": server})
+
+    if args.json:
+        with open(args.json, "w") as f:
+            json.dump(report, f, indent=2)
+
+
+if __name__ == "__main__":
+    main()